@@ -0,0 +1,1258 @@
+#include "bytecode.h"
+#include "dict.h"
+#include "intarray.h"
+#include "isolate.h"
+#include "lexer.h"
+#include "module.h"
+#include "parse.h"
+#include "program.h"
+#include "runtime.h"
+#include "statement.h"
+#include "superinstructions.h"
+#include "tail_calls.h"
+#include "tasks.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+    // Количество обращений к куче с начала работы программы
+    size_t allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void *p = malloc(size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept {
+    free(p);
+}
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    // Возвращает время выполнения fn в наносекундах
+    template <typename Fn>
+    double MeasureNs(Fn&& fn) {
+        const auto start = Clock::now();
+        fn();
+        return static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    void PrintRow(string_view name, double value, string_view unit) {
+        cout << "  " << left << setw(40) << name << right << setw(12) << fixed << setprecision(2) << value
+             << ' ' << unit << '\n';
+    }
+
+    unique_ptr<runtime::Executable> ParseProgramFromString(const string& program) {
+        istringstream is(program);
+        parse::Lexer lexer(is);
+        return ParseProgram(lexer);
+    }
+
+    size_t CountNodes(runtime::Executable& node) {
+        size_t count = 1;
+        node.ForEachChild([&count](unique_ptr<runtime::Executable>& child) {
+            count += CountNodes(*child);
+        });
+        return count;
+    }
+
+    // Стоимость диспетчеризации: одно и то же выражение вычисляется обходом дерева
+    // (виртуальный Statement::Execute на каждый узел) и байткодом с разной диспетчеризацией
+    void BenchmarkDispatch() {
+        constexpr int ITERATIONS = 1'000'000;
+        const string program = R"(
+x = a + b * c - d / e + a * b - c * d + e - (a + b) * (c - d)
+)"s;
+        auto tree = ParseProgramFromString(program);
+        auto compiled = ParseProgramFromString(program);
+        bytecode::CompileExpressions(compiled);
+
+        // Корень - Compound с единственным Assignment, выражение - его единственный потомок
+        runtime::Executable *tree_expression = nullptr;
+        runtime::Executable *compiled_expression = nullptr;
+        tree->ForEachChild([&](unique_ptr<runtime::Executable>& assignment) {
+            assignment->ForEachChild([&](unique_ptr<runtime::Executable>& rv) {
+                tree_expression = rv.get();
+            });
+        });
+        compiled->ForEachChild([&](unique_ptr<runtime::Executable>& assignment) {
+            assignment->ForEachChild([&](unique_ptr<runtime::Executable>& rv) {
+                compiled_expression = rv.get();
+            });
+        });
+        const auto &chunk = dynamic_cast<bytecode::CompiledExpression&>(*compiled_expression).GetChunk();
+
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        int value = 1;
+        for (const char *name : {"a", "b", "c", "d", "e"}) {
+            closure[name] = runtime::ObjectHolder::Own(runtime::Number{++value});
+        }
+
+        const size_t nodes = CountNodes(*tree_expression);
+        const size_t instructions = chunk.Size();
+
+        const double tree_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                tree_expression->Execute(closure, context);
+            }
+        });
+        const double threaded_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                chunk.Run(closure, context, bytecode::Dispatch::kThreaded);
+            }
+        });
+        const double switch_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                chunk.Run(closure, context, bytecode::Dispatch::kSwitch);
+            }
+        });
+
+        cout << "dispatch: " << nodes << " AST nodes vs " << instructions << " instructions, "
+             << ITERATIONS << " evaluations\n";
+        PrintRow("tree walk, ns per node", tree_ns / ITERATIONS / nodes, "ns");
+        PrintRow("threaded bytecode, ns per instruction", threaded_ns / ITERATIONS / instructions, "ns");
+        PrintRow("switch bytecode, ns per instruction", switch_ns / ITERATIONS / instructions, "ns");
+        PrintRow("tree walk, ns per evaluation", tree_ns / ITERATIONS, "ns");
+        PrintRow("threaded bytecode, ns per evaluation", threaded_ns / ITERATIONS, "ns");
+        PrintRow("switch bytecode, ns per evaluation", switch_ns / ITERATIONS, "ns");
+    }
+
+    // Суперинструкции: одна и та же программа исполняется без слияния узлов и после него
+    void BenchmarkSuperinstructions() {
+        constexpr int ITERATIONS = 2'000;
+        const string program = R"(
+class Walker:
+  def __init__():
+    self.total = 0
+    self.step = 3
+
+  def total_value():
+    return self.total
+
+  def walk(n):
+    x = n
+    x = x + 1
+    if x > 1:
+      self.total = self.total + self.step
+      self.walk(n - 1)
+
+w = Walker()
+)"s;
+        auto measure = [&](bool fuse) {
+            auto tree = ParseProgramFromString(program);
+            if (fuse) {
+                cout << "  " << ast::FuseSuperinstructions(tree) << '\n';
+            }
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            tree->Execute(closure, context);
+            auto &walker = *closure.at("w"s).TryAs<runtime::ClassInstance>();
+            const vector<runtime::ObjectHolder> args = {runtime::ObjectHolder::Own(runtime::Number{500})};
+            return MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    walker.Call("walk"s, args, context);
+                }
+            });
+        };
+
+        cout << "superinstructions: " << ITERATIONS << " x walk(500)\n";
+        const double plain_ns = measure(false);
+        const double fused_ns = measure(true);
+        PrintRow("plain tree, ms", plain_ns / 1e6, "ms");
+        PrintRow("fused tree, ms", fused_ns / 1e6, "ms");
+        PrintRow("speedup", plain_ns / fused_ns, "x");
+    }
+
+    // Построение строки повторной конкатенацией s = s + str(i): верёвка против копирования
+    // обеих строк при каждой конкатенации (так работал Add до появления верёвок)
+    void BenchmarkConcat() {
+        constexpr int ITERATIONS = 100'000;
+        auto tree = ParseProgramFromString("s = s + str(i)\n"s);
+        runtime::DummyContext context;
+
+        auto run = [&](runtime::Closure& closure) {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                closure["i"s] = runtime::ObjectHolder::Own(runtime::Number{i});
+                tree->Execute(closure, context);
+            }
+            return closure.at("s"s).TryAs<runtime::String>()->GetValue().size();
+        };
+
+        runtime::Closure rope_closure = {{"s"s, runtime::ObjectHolder::Own(runtime::String{""s})}};
+        size_t rope_size = 0;
+        const double rope_ns = MeasureNs([&] {
+            rope_size = run(rope_closure);
+        });
+
+        string flat;
+        const double flat_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                runtime::String copy{flat + to_string(i)};
+                flat = copy.GetValue();
+            }
+        });
+
+        cout << "concat: " << ITERATIONS << " x s = s + str(i), " << rope_size << " characters\n";
+        PrintRow("rope, ms", rope_ns / 1e6, "ms");
+        PrintRow("flat copies, ms", flat_ns / 1e6, "ms");
+    }
+
+    // Сборка строки из пяти частей: цепочка узлов Add (скобки не дают парсеру объединить её),
+    // узел Concat, join и format. Выводятся время и количество обращений к куче на одну строку
+    void BenchmarkStringBuilding() {
+        constexpr int ITERATIONS = 1'000'000;
+        runtime::DummyContext context;
+        runtime::Closure closure = {
+                {"a"s, runtime::ObjectHolder::Own(runtime::String{"name"s})},
+                {"b"s, runtime::ObjectHolder::Own(runtime::Number{12345})},
+                {"c"s, runtime::ObjectHolder::Own(runtime::Number{-678})},
+        };
+        cout << "string_building: " << ITERATIONS << " x a + ', ' + str(b) + ', ' + str(c)\n";
+        auto measure = [&](const string& name, const string& expression) {
+            auto tree = ParseProgramFromString("line = "s + expression + "\n"s);
+            ast::FuseSuperinstructions(tree);
+            bytecode::CompileExpressions(tree);
+            tree->Execute(closure, context);
+            const size_t allocations_before = allocations;
+            const double ns = MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    tree->Execute(closure, context);
+                }
+            });
+            PrintRow(name + ", ns"s, ns / ITERATIONS, "ns");
+            PrintRow(name + ", allocations"s,
+                     static_cast<double>(allocations - allocations_before) / ITERATIONS, "");
+        };
+        measure("chain of Add"s, "(((a + ', ') + str(b)) + ', ') + str(c)"s);
+        measure("Concat"s, "a + ', ' + str(b) + ', ' + str(c)"s);
+        measure("join"s, "join(', ', a, b, c)"s);
+        measure("format"s, "format('{}, {}, {}', a, b, c)"s);
+    }
+
+    // Разбиение длинной строки журнала на поля: срез String::Substr против копирования символов поля,
+    // а также токенизатор на Mython (find и срезы)
+    void BenchmarkSlices() {
+        constexpr int ITERATIONS = 10'000;
+        string text;
+        for (int i = 0; i < 100; ++i) {
+            text += "field"s + to_string(i) + "=value"s + to_string(i * 7919) + " "s;
+        }
+        const runtime::String line{text};
+
+        size_t checksum = 0;
+        auto tokenize = [&](auto make_token) {
+            const size_t before = allocations;
+            const double ns = MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    size_t start = 0;
+                    for (size_t end = line.Find(" "sv); end != string::npos; end = line.Find(" "sv, start)) {
+                        checksum += make_token(start, end - start).Size();
+                        start = end + 1;
+                    }
+                }
+            });
+            return pair{ns / ITERATIONS / 100, static_cast<double>(allocations - before) / ITERATIONS / 100};
+        };
+        const auto [slice_ns, slice_allocations] = tokenize([&](size_t start, size_t length) {
+            return line.Substr(start, length);
+        });
+        const auto [copy_ns, copy_allocations] = tokenize([&](size_t start, size_t length) {
+            return runtime::String{string(line.GetView().substr(start, length))};
+        });
+
+        constexpr int SCRIPT_ITERATIONS = 1'000;
+        const string program = R"(
+class Tokenizer:
+  def count(line):
+    n = 0
+    start = 0
+    end = line.find(' ')
+    while end >= 0:
+      token = line[start:end]
+      n = n + len(token)
+      start = end + 1
+      end = line.find(' ', start)
+    return n
+)"s;
+        auto tree = ParseProgramFromString(program + "t = Tokenizer()\n"s);
+        ast::FuseSuperinstructions(tree);
+        bytecode::CompileExpressions(tree);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+        auto &tokenizer = *closure.at("t"s).TryAs<runtime::ClassInstance>();
+        const vector<runtime::ObjectHolder> args = {runtime::ObjectHolder::Own(runtime::String{line})};
+        const double script_ns = MeasureNs([&] {
+            for (int i = 0; i < SCRIPT_ITERATIONS; ++i) {
+                checksum += tokenizer.Call("count"s, args, context).TryAs<runtime::Number>()->GetValue();
+            }
+        });
+
+        cout << "slices: 100 fields of a " << line.Size() << "-character line (checksum " << checksum << ")\n";
+        PrintRow("Substr, ns per field", slice_ns, "ns");
+        PrintRow("Substr, allocations per field", slice_allocations, "");
+        PrintRow("copy, ns per field", copy_ns, "ns");
+        PrintRow("copy, allocations per field", copy_allocations, "");
+        PrintRow("Mython find + line[start:end], ns per field", script_ns / SCRIPT_ITERATIONS / 100, "ns");
+    }
+
+    // Повторное сравнение длинных строк одинаковой длины: кешированный хеш против сравнения символов
+    void BenchmarkStringEqual() {
+        constexpr int ITERATIONS = 1'000'000;
+        const string prefix(65536, 's');
+        const auto status = runtime::ObjectHolder::Own(runtime::String{prefix + "ready"s});
+        const auto other = runtime::ObjectHolder::Own(runtime::String{prefix + "error"s});
+        runtime::DummyContext context;
+
+        size_t equal = 0;
+        const double hashed_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                equal += runtime::Equal(status, other, context);
+            }
+        });
+        const string &lhs = status.TryAs<runtime::String>()->GetValue();
+        const string &rhs = other.TryAs<runtime::String>()->GetValue();
+        const double bytes_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                equal += lhs == rhs;
+                // Не даёт компилятору вынести сравнение из цикла
+                asm volatile("" : : "g"(&lhs) : "memory");
+            }
+        });
+
+        cout << "string_equal: " << ITERATIONS << " comparisons of different " << lhs.size()
+             << "-character strings (" << equal << " equal)\n";
+        PrintRow("runtime::Equal, ns per comparison", hashed_ns / ITERATIONS, "ns");
+        PrintRow("std::string ==, ns per comparison", bytes_ns / ITERATIONS, "ns");
+    }
+
+    // str(x) для чисел и строк: прямое преобразование против вывода через ostringstream и Print
+    void BenchmarkStringify() {
+        constexpr int ITERATIONS = 1'000'000;
+        runtime::DummyContext context;
+        const auto text = runtime::ObjectHolder::Own(runtime::String{"status: ready"s});
+
+        auto via_stream = [&context](const runtime::ObjectHolder& object) {
+            ostringstream buf;
+            object->Print(buf, context);
+            return runtime::ObjectHolder::Own(runtime::String{buf.str()});
+        };
+
+        size_t total = 0;
+        const double direct_number_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                total += runtime::ToString(runtime::ObjectHolder::Own(runtime::Number{i}), context)
+                        .TryAs<runtime::String>()->Size();
+            }
+        });
+        const double stream_number_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                total += via_stream(runtime::ObjectHolder::Own(runtime::Number{i})).TryAs<runtime::String>()->Size();
+            }
+        });
+        const double direct_string_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                total += runtime::ToString(text, context).TryAs<runtime::String>()->Size();
+            }
+        });
+        const double stream_string_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                total += via_stream(text).TryAs<runtime::String>()->Size();
+            }
+        });
+
+        cout << "stringify: " << ITERATIONS << " conversions (" << total << " characters)\n";
+        PrintRow("str(number) direct, ns", direct_number_ns / ITERATIONS, "ns");
+        PrintRow("str(number) via ostringstream, ns", stream_number_ns / ITERATIONS, "ns");
+        PrintRow("str(string) direct, ns", direct_string_ns / ITERATIONS, "ns");
+        PrintRow("str(string) via ostringstream, ns", stream_string_ns / ITERATIONS, "ns");
+    }
+
+    // Циклы while и for против эквивалентной рекурсии методом класса
+    void BenchmarkWhile() {
+        constexpr int ITERATIONS = 100;
+        constexpr int N = 2'000;
+        const string program = R"(
+class Summer:
+  def loop(n):
+    acc = 0
+    while n > 0:
+      acc = acc + n
+      n = n - 1
+    return acc
+
+  def ranged(n):
+    acc = 0
+    for i in range(1, n + 1):
+      acc = acc + i
+    return acc
+
+  def recursive(n, acc):
+    if n > 0:
+      return self.recursive(n - 1, acc + n)
+    return acc
+
+s = Summer()
+)"s;
+        auto tree = ParseProgramFromString(program);
+        ast::FuseSuperinstructions(tree);
+        bytecode::CompileExpressions(tree);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+        auto &summer = *closure.at("s"s).TryAs<runtime::ClassInstance>();
+
+        auto measure = [&](const string& method, vector<runtime::ObjectHolder> args) {
+            return MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    summer.Call(method, args, context);
+                }
+            });
+        };
+        const auto n = runtime::ObjectHolder::Own(runtime::Number{N});
+        const size_t allocations_before = allocations;
+        const double loop_ns = measure("loop"s, {n});
+        const size_t loop_allocations = allocations - allocations_before;
+        const double ranged_ns = measure("ranged"s, {n});
+        const double recursive_ns = measure("recursive"s, {n, runtime::ObjectHolder::Own(runtime::Number{0})});
+
+        cout << "while: " << ITERATIONS << " x sum of 1.." << N << '\n';
+        PrintRow("while loop, ns per iteration", loop_ns / ITERATIONS / N, "ns");
+        PrintRow("while loop, allocations per iteration", static_cast<double>(loop_allocations) / ITERATIONS / N, "");
+        PrintRow("for in range loop, ns per iteration", ranged_ns / ITERATIONS / N, "ns");
+        PrintRow("recursion, ns per iteration", recursive_ns / ITERATIONS / N, "ns");
+    }
+
+    // Хвостовая рекурсия: обычные вызовы (глубина ограничена стеком C++) против
+    // переиспользования кадра, с которым рекурсия глубиной в миллион вызовов выполняется на месте
+    void BenchmarkTailCalls() {
+        constexpr int SHALLOW = 2'000;
+        constexpr int DEEP = 1'000'000;
+        const string program = R"(
+class Summer:
+  def sum(n, acc):
+    if n == 0:
+      return acc
+    return self.sum(n - 1, acc + n)
+
+s = Summer()
+)"s;
+        auto measure = [&](bool eliminate, int depth) {
+            auto tree = ParseProgramFromString(program);
+            if (eliminate) {
+                ast::EliminateTailCalls(tree);
+            }
+            ast::FuseSuperinstructions(tree);
+            bytecode::CompileExpressions(tree);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            tree->Execute(closure, context);
+            auto &summer = *closure.at("s"s).TryAs<runtime::ClassInstance>();
+            const vector<runtime::ObjectHolder> args = {runtime::ObjectHolder::Own(runtime::Number{depth}),
+                                                        runtime::ObjectHolder::Own(runtime::Number{0})};
+            return MeasureNs([&] {
+                summer.Call("sum"s, args, context);
+            });
+        };
+
+        const double plain_ns = measure(false, SHALLOW);
+        const double tail_ns = measure(true, SHALLOW);
+        const double deep_ns = measure(true, DEEP);
+
+        cout << "tail_calls: sum(n, 0) with tail recursion\n";
+        PrintRow("plain calls, depth 2000, ns per call", plain_ns / SHALLOW, "ns");
+        PrintRow("tail calls, depth 2000, ns per call", tail_ns / SHALLOW, "ns");
+        PrintRow("tail calls, depth 1000000, ns per call", deep_ns / DEEP, "ns");
+    }
+
+    // Заполнение кадра вызова self и одним аргументом: кадр из арены CallStack
+    // против новой Closure на каждый вызов (так работал ClassInstance::Call до появления CallStack)
+    void BenchmarkFrames() {
+        constexpr int ITERATIONS = 1'000'000;
+        const auto self = runtime::ObjectHolder::Own(runtime::Number{1});
+        const auto arg = runtime::ObjectHolder::Own(runtime::Number{2});
+        const string self_name = "self"s;
+        const string arg_name = "n"s;
+        size_t total = 0;
+
+        runtime::CallStack stack;
+        const double arena_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                runtime::CallStack::Frame frame(stack);
+                frame.Locals()[self_name] = self;
+                frame.Locals()[arg_name] = arg;
+                total += frame.Locals().size();
+            }
+        });
+        const double fresh_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                runtime::Closure closure;
+                closure[self_name] = self;
+                closure[arg_name] = arg;
+                total += closure.size();
+            }
+        });
+
+        cout << "frames: " << ITERATIONS << " frames of two variables (" << total << " bindings)\n";
+        PrintRow("CallStack frame, ns", arena_ns / ITERATIONS, "ns");
+        PrintRow("new Closure, ns", fresh_ns / ITERATIONS, "ns");
+    }
+
+    // Вызов метода через узел MethodCall: время и число обращений к куче на вызов.
+    // Весь путь вызова (аргументы, кадр, self, результат return) не должен выделять память
+    void BenchmarkCalls() {
+        constexpr int ITERATIONS = 1'000'000;
+        const string program = R"(
+class Box:
+  def set(a, b):
+    self.a = a
+    self.b = b
+
+  def get(a, b):
+    return a
+
+  def relay(a, b):
+    return self.get(a, b)
+
+box = Box()
+x = 1
+y = 'two'
+)"s;
+        auto tree = ParseProgramFromString(program);
+        ast::FuseSuperinstructions(tree);
+        ast::EliminateTailCalls(tree);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+
+        auto measure = [&](const string& call, const string& label) {
+            auto call_tree = ParseProgramFromString(call);
+            call_tree->Execute(closure, context);
+            const size_t allocations_before = allocations;
+            const double ns = MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    call_tree->Execute(closure, context);
+                }
+            });
+            const size_t allocated = allocations - allocations_before;
+            PrintRow(label + ", ns per call", ns / ITERATIONS, "ns");
+            PrintRow(label + ", allocations per call", static_cast<double>(allocated) / ITERATIONS, "");
+        };
+
+        cout << "calls: " << ITERATIONS << " method calls with two arguments\n";
+        measure("box.set(x, y)\n"s, "box.set(x, y)"s);
+        measure("box.get(x, y)\n"s, "box.get(x, y) with return"s);
+        measure("box.relay(x, y)\n"s, "box.relay(x, y) with tail call"s);
+    }
+
+    // Вызов метода Mython из C++: ClassInstance::Call по имени с вектором аргументов
+    // против заранее подготовленного PreparedMethod и пакетного вызова на многих экземплярах
+    void BenchmarkPreparedCalls() {
+        constexpr int INSTANCES = 1'000;
+        constexpr int ROUNDS = 1'000;
+        const string program = R"(
+class Particle:
+  def __init__():
+    self.x = 0
+
+  def move(dx, dy):
+    self.x = self.x + dx
+)"s;
+        string create;
+        for (int i = 0; i < INSTANCES; ++i) {
+            create += "p"s + to_string(i) + " = Particle()\n"s;
+        }
+        auto tree = ParseProgramFromString(program + create);
+        ast::FuseSuperinstructions(tree);
+        bytecode::CompileExpressions(tree);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+
+        vector<runtime::ClassInstance*> instances;
+        for (int i = 0; i < INSTANCES; ++i) {
+            instances.push_back(closure.at("p"s + to_string(i)).TryAs<runtime::ClassInstance>());
+        }
+        const runtime::ObjectHolder dx = runtime::ObjectHolder::Own(runtime::Number{1});
+        const runtime::ObjectHolder dy = runtime::ObjectHolder::Own(runtime::Number{2});
+        const runtime::PreparedMethod move{instances.front()->GetClass(), "move"s, 2};
+        vector<runtime::ObjectHolder> batch_args;
+        for (int i = 0; i < INSTANCES; ++i) {
+            batch_args.push_back(dx);
+            batch_args.push_back(dy);
+        }
+
+        auto measure = [&](const string& label, auto&& round) {
+            const size_t allocations_before = allocations;
+            const double ns = MeasureNs([&] {
+                for (int i = 0; i < ROUNDS; ++i) {
+                    round();
+                }
+            });
+            constexpr double CALLS = static_cast<double>(INSTANCES) * ROUNDS;
+            PrintRow(label + ", ns per call", ns / CALLS, "ns");
+            PrintRow(label + ", allocations per call", static_cast<double>(allocations - allocations_before) / CALLS,
+                     "");
+        };
+        cout << "prepared_calls: " << ROUNDS << " x move(dx, dy) on " << INSTANCES << " instances\n";
+        measure("Call(\"move\", {dx, dy})"s, [&] {
+            for (runtime::ClassInstance *instance : instances) {
+                instance->Call("move"s, {dx, dy}, context);
+            }
+        });
+        measure("PreparedMethod::Invoke"s, [&] {
+            for (runtime::ClassInstance *instance : instances) {
+                move.Invoke(*instance, {dx, dy}, context);
+            }
+        });
+        measure("PreparedMethod::InvokeBatch"s, [&] {
+            move.InvokeBatch(instances.data(), instances.size(), batch_args.data(), nullptr, context);
+        });
+    }
+
+    // Сумма элементов последовательности: встроенный список против цепочки объектов класса,
+    // которой раньше приходилось имитировать массивы (поиск поля next в Fields() на каждый шаг)
+    void BenchmarkList() {
+        constexpr int ITERATIONS = 100;
+        constexpr int N = 10'000;
+        const string program = R"(
+class Node:
+  def __init__(value, next):
+    self.value = value
+    self.next = next
+
+class Sequences:
+  def __init__(n):
+    self.n = n
+    self.list = []
+    self.chain = None
+    for i in range(n):
+      self.list.append(i)
+      self.chain = Node(n - 1 - i, self.chain)
+
+  def sum_chain():
+    total = 0
+    node = self.chain
+    i = 0
+    while i < self.n:
+      total = total + node.value
+      node = node.next
+      i = i + 1
+    return total
+
+  def sum_indexed():
+    total = 0
+    xs = self.list
+    i = 0
+    while i < self.n:
+      total = total + xs[i]
+      i = i + 1
+    return total
+
+  def sum_iterated():
+    total = 0
+    for x in self.list:
+      total = total + x
+    return total
+)"s;
+        auto tree = ParseProgramFromString(program + "s = Sequences("s + to_string(N) + ")\n"s);
+        ast::FuseSuperinstructions(tree);
+        bytecode::CompileExpressions(tree);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+        auto &sequences = *closure.at("s"s).TryAs<runtime::ClassInstance>();
+
+        int64_t checksum = 0;
+        auto measure = [&](const string& method) {
+            return MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    checksum += sequences.Call(method, {}, context).TryAs<runtime::Number>()->GetValue();
+                }
+            });
+        };
+        const double chain_ns = measure("sum_chain"s);
+        const double indexed_ns = measure("sum_indexed"s);
+        const double iterated_ns = measure("sum_iterated"s);
+
+        cout << "list: " << ITERATIONS << " x sum of " << N << " elements (checksum " << checksum << ")\n";
+        PrintRow("object chain, ns per element", chain_ns / ITERATIONS / N, "ns");
+        PrintRow("list xs[i], ns per element", indexed_ns / ITERATIONS / N, "ns");
+        PrintRow("list for x in xs, ns per element", iterated_ns / ITERATIONS / N, "ns");
+    }
+
+    // Словарь Dict против std::unordered_map с теми же хешем (Dict::Hash) и сравнением ключей (Equal)
+    // на вставке и поиске числовых и строковых ключей, а также поиск по словарю в Mython
+    // против цепочки if/else, которой раньше заменяли словари
+    void BenchmarkDict() {
+        constexpr int KEYS = 100'000;
+        constexpr int LOOKUPS = 1'000'000;
+        runtime::DummyContext context;
+
+        struct Hasher {
+            runtime::Context* context;
+            size_t operator()(const runtime::ObjectHolder& key) const {
+                return runtime::Dict::Hash(key, *context);
+            }
+        };
+        struct KeyEqual {
+            runtime::Context* context;
+            bool operator()(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs) const {
+                return runtime::Equal(lhs, rhs, *context);
+            }
+        };
+        using UnorderedMap = unordered_map<runtime::ObjectHolder, runtime::ObjectHolder, Hasher, KeyEqual>;
+
+        auto run = [&](const string& label, const vector<runtime::ObjectHolder>& keys) {
+            vector<runtime::ObjectHolder> probes;
+            probes.reserve(LOOKUPS);
+            for (int i = 0; i < LOOKUPS; ++i) {
+                probes.push_back(keys[static_cast<size_t>(i) * 7919 % keys.size()]);
+            }
+            size_t found = 0;
+
+            runtime::Dict dict;
+            const double dict_insert_ns = MeasureNs([&] {
+                for (const auto &key : keys) {
+                    dict.Set(key, key, context);
+                }
+            });
+            const double dict_find_ns = MeasureNs([&] {
+                for (const auto &probe : probes) {
+                    found += dict.Find(probe, context) != nullptr;
+                }
+            });
+
+            UnorderedMap map(0, Hasher{&context}, KeyEqual{&context});
+            const double map_insert_ns = MeasureNs([&] {
+                for (const auto &key : keys) {
+                    map[key] = key;
+                }
+            });
+            const double map_find_ns = MeasureNs([&] {
+                for (const auto &probe : probes) {
+                    found += map.count(probe);
+                }
+            });
+
+            cout << "  " << label << " (" << found << " found)\n";
+            PrintRow("Dict insert, ns", dict_insert_ns / KEYS, "ns");
+            PrintRow("std::unordered_map insert, ns", map_insert_ns / KEYS, "ns");
+            PrintRow("Dict find, ns", dict_find_ns / LOOKUPS, "ns");
+            PrintRow("std::unordered_map find, ns", map_find_ns / LOOKUPS, "ns");
+        };
+
+        vector<runtime::ObjectHolder> numbers;
+        vector<runtime::ObjectHolder> strings;
+        for (int i = 0; i < KEYS; ++i) {
+            numbers.push_back(runtime::ObjectHolder::Own(runtime::Number{int64_t{i} * 1'000'003}));
+            strings.push_back(runtime::ObjectHolder::Own(runtime::String{"key_"s + to_string(i)}));
+        }
+        cout << "dict: " << KEYS << " keys, " << LOOKUPS << " lookups\n";
+        run("number keys"s, numbers);
+        run("string keys"s, strings);
+
+        constexpr int SCRIPT_ITERATIONS = 100'000;
+        const string program = R"(
+class Codes:
+  def __init__():
+    self.table = {'a': 0, 'b': 1, 'c': 2, 'd': 3, 'e': 4, 'f': 5, 'g': 6, 'h': 7, 'i': 8, 'j': 9, 'k': 10, 'l': 11, 'm': 12, 'n': 13, 'o': 14, 'p': 15}
+
+  def by_dict(key):
+    return self.table[key]
+
+  def by_chain(key):
+    if key == 'a':
+      return 0
+    if key == 'b':
+      return 1
+    if key == 'c':
+      return 2
+    if key == 'd':
+      return 3
+    if key == 'e':
+      return 4
+    if key == 'f':
+      return 5
+    if key == 'g':
+      return 6
+    if key == 'h':
+      return 7
+    if key == 'i':
+      return 8
+    if key == 'j':
+      return 9
+    if key == 'k':
+      return 10
+    if key == 'l':
+      return 11
+    if key == 'm':
+      return 12
+    if key == 'n':
+      return 13
+    if key == 'o':
+      return 14
+    if key == 'p':
+      return 15
+    return None
+
+c = Codes()
+)"s;
+        auto tree = ParseProgramFromString(program);
+        ast::FuseSuperinstructions(tree);
+        bytecode::CompileExpressions(tree);
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+        auto &codes = *closure.at("c"s).TryAs<runtime::ClassInstance>();
+        const vector<runtime::ObjectHolder> last_key = {runtime::ObjectHolder::Own(runtime::String{"p"s})};
+        auto measure = [&](const string& method) {
+            return MeasureNs([&] {
+                for (int i = 0; i < SCRIPT_ITERATIONS; ++i) {
+                    codes.Call(method, last_key, context);
+                }
+            });
+        };
+        const double dict_ns = measure("by_dict"s);
+        const double chain_ns = measure("by_chain"s);
+        cout << "  Mython lookup of the 16th of 16 keys\n";
+        PrintRow("dict lookup, ns", dict_ns / SCRIPT_ITERATIONS, "ns");
+        PrintRow("if/else chain, ns", chain_ns / SCRIPT_ITERATIONS, "ns");
+    }
+
+    // Операции IntArray на каждом доступном наборе инструкций, а также сумма в Mython:
+    // цикл по списку упакованных чисел против intarray.sum()
+    void BenchmarkIntArray() {
+        constexpr int ITERATIONS = 1'000;
+        constexpr int N = 100'000;
+        vector<int64_t> values(N);
+        for (int i = 0; i < N; ++i) {
+            values[i] = (i * 7919) % 20001 - 10000;
+        }
+        const runtime::IntArray lhs{values};
+        const runtime::IntArray rhs{vector<int64_t>(values.rbegin(), values.rend())};
+
+        const runtime::SimdLevel initial = runtime::IntArray::GetSimdLevel();
+        int64_t checksum = 0;
+        cout << "intarray: " << ITERATIONS << " x operations on " << N << " elements\n";
+        const pair<runtime::SimdLevel, string_view> levels[] = {
+                {runtime::SimdLevel::kScalar, "scalar"sv},
+                {runtime::SimdLevel::kSse42, "sse4.2"sv},
+                {runtime::SimdLevel::kAvx2, "avx2"sv},
+        };
+        for (const auto &[level, level_name] : levels) {
+            runtime::IntArray::SetSimdLevel(level);
+            if (runtime::IntArray::GetSimdLevel() != level) {
+                continue;
+            }
+            auto measure = [&](string_view operation, auto&& fn) {
+                const double ns = MeasureNs([&] {
+                    for (int i = 0; i < ITERATIONS; ++i) {
+                        checksum += fn();
+                    }
+                });
+                PrintRow(string(level_name) + " "s + string(operation) + ", ns per element"s,
+                         ns / ITERATIONS / N, "ns");
+            };
+            measure("sum"sv, [&] {
+                return lhs.Sum().TryAs<runtime::Number>()->GetValue();
+            });
+            measure("max"sv, [&] {
+                return lhs.Max();
+            });
+            measure("dot"sv, [&] {
+                return lhs.Dot(rhs).TryAs<runtime::Number>()->GetValue();
+            });
+            measure("add"sv, [&] {
+                return lhs.Add(rhs).GetValues().back();
+            });
+            measure("lt mask"sv, [&] {
+                return lhs.CompareMask(runtime::IntArray::Comparison::kLess, 0).GetValues().back();
+            });
+        }
+        runtime::IntArray::SetSimdLevel(initial);
+
+        constexpr int SCRIPT_ITERATIONS = 20;
+        const string program = R"(
+class Sums:
+  def __init__(n):
+    self.list = []
+    for i in range(n):
+      self.list.append(i)
+    self.array = intarray(self.list)
+
+  def sum_list():
+    total = 0
+    for x in self.list:
+      total = total + x
+    return total
+
+  def sum_array():
+    return self.array.sum()
+)"s;
+        auto tree = ParseProgramFromString(program + "s = Sums("s + to_string(N) + ")\n"s);
+        ast::FuseSuperinstructions(tree);
+        bytecode::CompileExpressions(tree);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+        auto &sums = *closure.at("s"s).TryAs<runtime::ClassInstance>();
+        auto measure = [&](const string& method) {
+            return MeasureNs([&] {
+                for (int i = 0; i < SCRIPT_ITERATIONS; ++i) {
+                    checksum += sums.Call(method, {}, context).TryAs<runtime::Number>()->GetValue();
+                }
+            });
+        };
+        const double list_ns = measure("sum_list"s);
+        const double array_ns = measure("sum_array"s);
+        cout << "  Mython sum of " << N << " elements (checksum " << checksum << ")\n";
+        PrintRow("for x in list, ns per element", list_ns / SCRIPT_ITERATIONS / N, "ns");
+        PrintRow("intarray.sum(), ns per element", array_ns / SCRIPT_ITERATIONS / N, "ns");
+    }
+
+    // Вызов функций и методов C++ из Mython через runtime::Module в сравнении
+    // с прямым вызовом из C++ и с вызовом метода класса, написанного на Mython
+    class Accumulator : public runtime::Native<Accumulator> {
+    public:
+        void Add(int64_t a, int64_t b) {
+            total_ += a + b;
+        }
+
+        [[nodiscard]] int64_t Get() const {
+            return total_;
+        }
+
+    private:
+        int64_t total_ = 0;
+    };
+
+    int64_t NativeAdd(int64_t a, int64_t b) {
+        return a + b;
+    }
+
+    void BenchmarkNativeCalls() {
+        constexpr int ITERATIONS = 1'000'000;
+        runtime::Module module;
+        module.Def("native_add", &NativeAdd);
+        module.Class<Accumulator>("Accumulator")
+                .Init<>()
+                .Def("add", &Accumulator::Add)
+                .Def("get", &Accumulator::Get);
+
+        const string program = R"(
+class Box:
+  def add(a, b):
+    self.total = a + b
+
+acc = Accumulator()
+box = Box()
+x = 1
+y = 2
+)"s;
+        auto parse = [&](const string& text) {
+            istringstream is(text);
+            parse::Lexer lexer(is);
+            return ParseProgram(lexer, module);
+        };
+        auto tree = parse(program);
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        tree->Execute(closure, context);
+
+        cout << "native_calls: " << ITERATIONS << " calls with two arguments\n";
+        volatile int64_t sink = 0;
+        const double direct_ns = MeasureNs([&] {
+            for (int i = 0; i < ITERATIONS; ++i) {
+                sink = NativeAdd(sink, i);
+            }
+        });
+        PrintRow("C++ call, ns per call", direct_ns / ITERATIONS, "ns");
+
+        auto measure = [&](const string& call, const string& label) {
+            auto call_tree = parse(call);
+            call_tree->Execute(closure, context);
+            const size_t allocations_before = allocations;
+            const double ns = MeasureNs([&] {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    call_tree->Execute(closure, context);
+                }
+            });
+            PrintRow(label + ", ns per call", ns / ITERATIONS, "ns");
+            PrintRow(label + ", allocations per call",
+                     static_cast<double>(allocations - allocations_before) / ITERATIONS, "");
+        };
+        measure("native_add(x, y)\n"s, "native_add(x, y)"s);
+        measure("acc.add(x, y)\n"s, "native acc.add(x, y)"s);
+        measure("box.add(x, y)\n"s, "Mython box.add(x, y)"s);
+    }
+
+    // Выполнение одной программы: разбор и оптимизация при каждом запуске против
+    // однажды скомпилированной mython::Program, а также выполнение одной Program в нескольких потоках
+    void BenchmarkProgram() {
+        constexpr int RUNS = 2'000;
+        const string program = R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def dot(other):
+    return self.x * other.x + self.y * other.y
+
+total = 0
+p = Point(1, 2)
+for i in range(100):
+  total = total + p.dot(Point(i, i + 1))
+)"s;
+        auto run_once = [](const mython::Program& compiled) {
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            compiled.Execute(closure, context);
+        };
+        cout << "program: " << RUNS << " runs of a 100-iteration program\n";
+        const double reparse_ns = MeasureNs([&] {
+            for (int i = 0; i < RUNS; ++i) {
+                istringstream is(program);
+                run_once(mython::Program{is});
+            }
+        });
+        istringstream is(program);
+        const mython::Program compiled{is};
+        const double compiled_ns = MeasureNs([&] {
+            for (int i = 0; i < RUNS; ++i) {
+                run_once(compiled);
+            }
+        });
+        PrintRow("parse every run, us per run", reparse_ns / RUNS / 1000, "us");
+        PrintRow("compiled once, us per run", compiled_ns / RUNS / 1000, "us");
+
+        const unsigned max_threads = max(1U, thread::hardware_concurrency());
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            const double ns = MeasureNs([&] {
+                vector<thread> workers;
+                for (unsigned t = 0; t < threads; ++t) {
+                    workers.emplace_back([&] {
+                        for (int i = 0; i < RUNS; ++i) {
+                            run_once(compiled);
+                        }
+                    });
+                }
+                for (thread &worker : workers) {
+                    worker.join();
+                }
+            });
+            PrintRow(to_string(threads) + " threads, runs per ms"s, static_cast<double>(RUNS) * threads / (ns / 1e6),
+                     "");
+        }
+    }
+
+    // Масштабирование изолятов: главный изолят раздаёт работу изолятам-обработчикам (по одному
+    // на поток пула) и собирает ответы. Каждое сообщение - цикл на 1000 итераций в изоляте
+    void BenchmarkIsolates() {
+        constexpr int MESSAGES = 2'000;
+        const string program = R"(
+class Worker:
+  def receive(sender, message):
+    total = 0
+    for i in range(1000):
+      total = total + i * message
+    send(sender, total)
+
+workers = []
+for i in range(worker_count):
+  workers.append(spawn(Worker))
+for i in range(messages):
+  send(workers[i - i / worker_count * worker_count], i)
+checksum = 0
+for i in range(messages):
+  checksum = checksum + recv()
+)"s;
+        istringstream is(program);
+        const mython::Program compiled{is};
+        const unsigned max_threads = max(1U, thread::hardware_concurrency());
+        cout << "isolates: " << MESSAGES << " messages of 1000 loop iterations, one isolate per pool thread\n";
+        double single_ns = 0;
+        for (unsigned threads = 1;; threads = min(threads * 2, max_threads)) {
+            ostringstream output;
+            runtime::IsolatePool pool{output, threads};
+            runtime::Closure closure;
+            closure["worker_count"s] = runtime::ObjectHolder::Own(runtime::Number{threads});
+            closure["messages"s] = runtime::ObjectHolder::Own(runtime::Number{MESSAGES});
+            const double ns = MeasureNs([&] {
+                compiled.Execute(closure, pool.GetMainContext());
+                pool.Wait();
+            });
+            if (threads == 1) {
+                single_ns = ns;
+            }
+            PrintRow(to_string(threads) + " threads, messages per ms"s, MESSAGES / (ns / 1e6), "");
+            PrintRow(to_string(threads) + " threads, speedup"s, single_ns / ns, "x");
+            if (threads == max_threads) {
+                break;
+            }
+        }
+    }
+
+    // Fork-join на пуле задач: рекурсивное вычисление чисел Фибоначчи, в котором каждый вызов
+    // выше порога запускает одну ветвь задачей. Показывает накладные расходы spawn/join
+    // и масштабирование перехвата работы
+    void BenchmarkTasks() {
+        const string program = R"(
+class Fib:
+  def __init__(cutoff):
+    self.cutoff = cutoff
+
+  def serial(n):
+    if n < 2:
+      return n
+    return self.serial(n - 1) + self.serial(n - 2)
+
+  def parallel(n):
+    if n < self.cutoff:
+      return self.serial(n)
+    left = spawn self.parallel(n - 1)
+    right = self.parallel(n - 2)
+    return join(left) + right
+
+fib = Fib(cutoff)
+result = fib.parallel(n)
+)"s;
+        constexpr int N = 22;
+        istringstream is(program);
+        const mython::Program compiled{is};
+        const unsigned max_threads = max(1U, thread::hardware_concurrency());
+        cout << "tasks: fib(" << N << ") with spawn above the cutoff\n";
+        // Порог больше N - последовательное вычисление без задач
+        for (int cutoff : {N + 1, 12, 2}) {
+            double single_ns = 0;
+            for (unsigned threads = 1;; threads = min(threads * 2, max_threads)) {
+                runtime::SimpleContext context{cout};
+                runtime::TaskPool pool{context, threads};
+                runtime::Closure closure;
+                closure["n"s] = runtime::ObjectHolder::Own(runtime::Number{N});
+                closure["cutoff"s] = runtime::ObjectHolder::Own(runtime::Number{cutoff});
+                const double ns = MeasureNs([&] {
+                    compiled.Execute(closure, pool.GetMainContext());
+                    pool.Wait();
+                });
+                if (threads == 1) {
+                    single_ns = ns;
+                }
+                const string label = (cutoff > N ? "serial"s : "cutoff "s + to_string(cutoff)) + ", "s
+                                     + to_string(threads) + " threads"s;
+                PrintRow(label + ", ms"s, ns / 1e6, "ms");
+                PrintRow(label + ", speedup"s, single_ns / ns, "x");
+                if (threads == max_threads) {
+                    break;
+                }
+            }
+        }
+    }
+
+    // pmap и preduce над списком: каждый элемент обрабатывается методом с заметной работой
+    void BenchmarkParallelCollections() {
+        const string program = R"(
+class Work:
+  def cube_sum(n):
+    total = 0
+    for i in range(n):
+      total = total + i * i * i
+    return total
+
+  def add(a, b):
+    return a + b
+
+work = Work()
+items = range(size)
+total = preduce(work, 'add', pmap(work, 'cube_sum', items, grain), 0, grain)
+)"s;
+        constexpr int SIZE = 1000;
+        istringstream is(program);
+        const mython::Program compiled{is};
+        const unsigned max_threads = max(1U, thread::hardware_concurrency());
+        cout << "parallel_collections: pmap + preduce over " << SIZE << " items\n";
+        // Размер части, равный SIZE, - последовательное выполнение
+        for (int grain : {SIZE, 64, 1}) {
+            double single_ns = 0;
+            for (unsigned threads = 1;; threads = min(threads * 2, max_threads)) {
+                runtime::SimpleContext context{cout};
+                runtime::TaskPool pool{context, threads};
+                runtime::Closure closure;
+                closure["size"s] = runtime::ObjectHolder::Own(runtime::Number{SIZE});
+                closure["grain"s] = runtime::ObjectHolder::Own(runtime::Number{grain});
+                const double ns = MeasureNs([&] {
+                    compiled.Execute(closure, pool.GetMainContext());
+                });
+                if (threads == 1) {
+                    single_ns = ns;
+                }
+                const string label = "grain "s + to_string(grain) + ", "s + to_string(threads) + " threads"s;
+                PrintRow(label + ", ms"s, ns / 1e6, "ms");
+                PrintRow(label + ", speedup"s, single_ns / ns, "x");
+                if (threads == max_threads) {
+                    break;
+                }
+            }
+        }
+    }
+
+    struct Benchmark {
+        string_view name;
+        function<void()> run;
+    };
+
+}  // namespace
+
+// Запуск: cpp_mython_benchmark [имя бенчмарка]. Без аргументов выполняются все бенчмарки
+int main(int argc, char** argv) {
+    const Benchmark benchmarks[] = {
+            {"dispatch"sv, BenchmarkDispatch},
+            {"superinstructions"sv, BenchmarkSuperinstructions},
+            {"concat"sv, BenchmarkConcat},
+            {"string_building"sv, BenchmarkStringBuilding},
+            {"slices"sv, BenchmarkSlices},
+            {"string_equal"sv, BenchmarkStringEqual},
+            {"stringify"sv, BenchmarkStringify},
+            {"while"sv, BenchmarkWhile},
+            {"tail_calls"sv, BenchmarkTailCalls},
+            {"frames"sv, BenchmarkFrames},
+            {"calls"sv, BenchmarkCalls},
+            {"prepared_calls"sv, BenchmarkPreparedCalls},
+            {"list"sv, BenchmarkList},
+            {"dict"sv, BenchmarkDict},
+            {"intarray"sv, BenchmarkIntArray},
+            {"native_calls"sv, BenchmarkNativeCalls},
+            {"program"sv, BenchmarkProgram},
+            {"isolates"sv, BenchmarkIsolates},
+            {"tasks"sv, BenchmarkTasks},
+            {"parallel_collections"sv, BenchmarkParallelCollections},
+    };
+    for (const auto &benchmark : benchmarks) {
+        if (argc < 2 || benchmark.name == argv[1]) {
+            benchmark.run();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,367 @@
+#include "bigint.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        using Limbs = BigInt::Limbs;
+
+        constexpr uint64_t BASE = uint64_t{1} << 32;
+        // Начиная с этой длины множителей (в разрядах) умножение выполняется алгоритмом Карацубы
+        constexpr size_t KARATSUBA_THRESHOLD = 32;
+        // Наибольшая степень 10, помещающаяся в разряд; используется при переводе в десятичную запись
+        constexpr uint32_t DECIMAL_CHUNK = 1'000'000'000;
+        constexpr size_t DECIMAL_CHUNK_DIGITS = 9;
+
+        void Trim(Limbs& limbs) {
+            while (!limbs.empty() && limbs.back() == 0) {
+                limbs.pop_back();
+            }
+        }
+
+        int CompareMagnitudes(const Limbs& lhs, const Limbs& rhs) {
+            if (lhs.size() != rhs.size()) {
+                return lhs.size() < rhs.size() ? -1 : 1;
+            }
+            for (size_t i = lhs.size(); i-- > 0;) {
+                if (lhs[i] != rhs[i]) {
+                    return lhs[i] < rhs[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        Limbs AddMagnitudes(const Limbs& lhs, const Limbs& rhs) {
+            const Limbs &longer = lhs.size() >= rhs.size() ? lhs : rhs;
+            const Limbs &shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+            Limbs result(longer.size() + 1);
+            uint64_t carry = 0;
+            for (size_t i = 0; i < longer.size(); ++i) {
+                uint64_t sum = uint64_t{longer[i]} + (i < shorter.size() ? shorter[i] : 0) + carry;
+                result[i] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            result.back() = static_cast<uint32_t>(carry);
+            Trim(result);
+            return result;
+        }
+
+        // Вычитает модули; требует lhs >= rhs
+        Limbs SubMagnitudes(const Limbs& lhs, const Limbs& rhs) {
+            Limbs result(lhs.size());
+            int64_t borrow = 0;
+            for (size_t i = 0; i < lhs.size(); ++i) {
+                int64_t diff = int64_t{lhs[i]} - (i < rhs.size() ? rhs[i] : 0) - borrow;
+                borrow = diff < 0 ? 1 : 0;
+                result[i] = static_cast<uint32_t>(diff + (borrow ? static_cast<int64_t>(BASE) : 0));
+            }
+            Trim(result);
+            return result;
+        }
+
+        // Прибавляет addend, сдвинутый на shift разрядов, к target (target достаточно длинный)
+        void AddShifted(Limbs& target, const Limbs& addend, size_t shift) {
+            uint64_t carry = 0;
+            size_t i = 0;
+            for (; i < addend.size(); ++i) {
+                uint64_t sum = uint64_t{target[i + shift]} + addend[i] + carry;
+                target[i + shift] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            for (; carry != 0; ++i) {
+                uint64_t sum = uint64_t{target[i + shift]} + carry;
+                target[i + shift] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+        }
+
+        Limbs MultiplySchoolbook(const Limbs& lhs, const Limbs& rhs) {
+            if (lhs.empty() || rhs.empty()) {
+                return {};
+            }
+            Limbs result(lhs.size() + rhs.size());
+            for (size_t i = 0; i < lhs.size(); ++i) {
+                uint64_t carry = 0;
+                for (size_t j = 0; j < rhs.size(); ++j) {
+                    uint64_t product = uint64_t{lhs[i]} * rhs[j] + result[i + j] + carry;
+                    result[i + j] = static_cast<uint32_t>(product);
+                    carry = product >> 32;
+                }
+                result[i + rhs.size()] = static_cast<uint32_t>(carry);
+            }
+            Trim(result);
+            return result;
+        }
+
+        Limbs MultiplyMagnitudes(const Limbs& lhs, const Limbs& rhs);
+
+        // lhs * rhs = z2 * B^2h + z1 * B^h + z0, где z1 = (l0 + l1)(r0 + r1) - z2 - z0
+        Limbs MultiplyKaratsuba(const Limbs& lhs, const Limbs& rhs) {
+            const size_t half = max(lhs.size(), rhs.size()) / 2;
+            auto split = [half](const Limbs& value) {
+                auto middle = value.begin() + static_cast<ptrdiff_t>(min(half, value.size()));
+                Limbs low(value.begin(), middle);
+                Limbs high(middle, value.end());
+                Trim(low);
+                return pair{std::move(low), std::move(high)};
+            };
+            auto [lhs_low, lhs_high] = split(lhs);
+            auto [rhs_low, rhs_high] = split(rhs);
+
+            Limbs z0 = MultiplyMagnitudes(lhs_low, rhs_low);
+            Limbs z2 = MultiplyMagnitudes(lhs_high, rhs_high);
+            Limbs z1 = MultiplyMagnitudes(AddMagnitudes(lhs_low, lhs_high), AddMagnitudes(rhs_low, rhs_high));
+            z1 = SubMagnitudes(SubMagnitudes(z1, z2), z0);
+
+            Limbs result(lhs.size() + rhs.size() + 1);
+            AddShifted(result, z0, 0);
+            AddShifted(result, z1, half);
+            AddShifted(result, z2, 2 * half);
+            Trim(result);
+            return result;
+        }
+
+        Limbs MultiplyMagnitudes(const Limbs& lhs, const Limbs& rhs) {
+            // Для сильно несбалансированных множителей разбиение Карацубы не окупается
+            if (min(lhs.size(), rhs.size()) < KARATSUBA_THRESHOLD
+                || 2 * min(lhs.size(), rhs.size()) < max(lhs.size(), rhs.size())) {
+                return MultiplySchoolbook(lhs, rhs);
+            }
+            return MultiplyKaratsuba(lhs, rhs);
+        }
+
+        // Делит модуль на одноразрядное число, возвращает остаток
+        uint32_t DivideBySmall(Limbs& value, uint32_t divisor) {
+            uint64_t remainder = 0;
+            for (size_t i = value.size(); i-- > 0;) {
+                uint64_t current = (remainder << 32) | value[i];
+                value[i] = static_cast<uint32_t>(current / divisor);
+                remainder = current % divisor;
+            }
+            Trim(value);
+            return static_cast<uint32_t>(remainder);
+        }
+
+        void MultiplyAddSmall(Limbs& value, uint32_t factor, uint32_t addend) {
+            uint64_t carry = addend;
+            for (auto &limb : value) {
+                uint64_t product = uint64_t{limb} * factor + carry;
+                limb = static_cast<uint32_t>(product);
+                carry = product >> 32;
+            }
+            if (carry != 0) {
+                value.push_back(static_cast<uint32_t>(carry));
+            }
+        }
+
+        Limbs ShiftLeft(const Limbs& value, unsigned shift, size_t size) {
+            Limbs result(size);
+            for (size_t i = 0; i < value.size(); ++i) {
+                uint64_t shifted = uint64_t{value[i]} << shift;
+                result[i] |= static_cast<uint32_t>(shifted);
+                if (i + 1 < size) {
+                    result[i + 1] |= static_cast<uint32_t>(shifted >> 32);
+                }
+            }
+            return result;
+        }
+
+        // Частное от деления модулей (алгоритм D Кнута для многоразрядного делителя)
+        Limbs DivideMagnitudes(const Limbs& dividend, const Limbs& divisor) {
+            if (CompareMagnitudes(dividend, divisor) < 0) {
+                return {};
+            }
+            if (divisor.size() == 1) {
+                Limbs quotient = dividend;
+                DivideBySmall(quotient, divisor.front());
+                return quotient;
+            }
+
+            const size_t n = divisor.size();
+            const size_t m = dividend.size() - n;
+            // Нормализация: старший разряд делителя должен иметь установленный старший бит
+            const auto shift = static_cast<unsigned>(__builtin_clz(divisor.back()));
+            const Limbs v = ShiftLeft(divisor, shift, n);
+            Limbs u = ShiftLeft(dividend, shift, dividend.size() + 1);
+            Limbs quotient(m + 1);
+
+            for (size_t j = m + 1; j-- > 0;) {
+                uint64_t numerator = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+                uint64_t q_hat = numerator / v[n - 1];
+                uint64_t r_hat = numerator % v[n - 1];
+                while (q_hat >= BASE || q_hat * v[n - 2] > ((r_hat << 32) | u[j + n - 2])) {
+                    --q_hat;
+                    r_hat += v[n - 1];
+                    if (r_hat >= BASE) {
+                        break;
+                    }
+                }
+
+                // u[j..j+n] -= q_hat * v
+                int64_t borrow = 0;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    uint64_t product = q_hat * v[i] + carry;
+                    carry = product >> 32;
+                    int64_t diff = int64_t{u[i + j]} - borrow - static_cast<int64_t>(product & 0xFFFFFFFFU);
+                    u[i + j] = static_cast<uint32_t>(diff);
+                    borrow = diff < 0 ? 1 : 0;
+                }
+                int64_t diff = int64_t{u[j + n]} - borrow - static_cast<int64_t>(carry);
+                u[j + n] = static_cast<uint32_t>(diff);
+
+                if (diff < 0) {
+                    // q_hat оказалось на единицу больше: возвращаем один делитель обратно
+                    --q_hat;
+                    uint64_t add_carry = 0;
+                    for (size_t i = 0; i < n; ++i) {
+                        uint64_t sum = uint64_t{u[i + j]} + v[i] + add_carry;
+                        u[i + j] = static_cast<uint32_t>(sum);
+                        add_carry = sum >> 32;
+                    }
+                    u[j + n] += static_cast<uint32_t>(add_carry);
+                }
+                quotient[j] = static_cast<uint32_t>(q_hat);
+            }
+            Trim(quotient);
+            return quotient;
+        }
+
+        uint64_t Magnitude(int64_t value) {
+            return value < 0 ? uint64_t{0} - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        }
+
+    }  // namespace
+
+    BigInt::BigInt(int64_t value)
+            : negative_(value < 0) {
+        for (uint64_t magnitude = Magnitude(value); magnitude != 0; magnitude >>= 32) {
+            magnitude_.push_back(static_cast<uint32_t>(magnitude));
+        }
+    }
+
+    BigInt::BigInt(Limbs magnitude, bool negative)
+            : magnitude_(std::move(magnitude)) {
+        Trim(magnitude_);
+        negative_ = negative && !magnitude_.empty();
+    }
+
+    BigInt BigInt::FromString(std::string_view digits) {
+        bool negative = false;
+        if (!digits.empty() && digits.front() == '-') {
+            negative = true;
+            digits.remove_prefix(1);
+        }
+        if (digits.empty()) {
+            throw runtime_error("invalid integer literal");
+        }
+        Limbs magnitude;
+        for (char digit : digits) {
+            if (digit < '0' || digit > '9') {
+                throw runtime_error("invalid integer literal");
+            }
+            MultiplyAddSmall(magnitude, 10, static_cast<uint32_t>(digit - '0'));
+        }
+        return {std::move(magnitude), negative};
+    }
+
+    bool BigInt::IsZero() const {
+        return magnitude_.empty();
+    }
+
+    bool BigInt::IsNegative() const {
+        return negative_;
+    }
+
+    bool BigInt::FitsInt64() const {
+        if (magnitude_.size() > 2) {
+            return false;
+        }
+        uint64_t magnitude = 0;
+        for (size_t i = magnitude_.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | magnitude_[i];
+        }
+        const auto max = static_cast<uint64_t>(numeric_limits<int64_t>::max());
+        return negative_ ? magnitude <= max + 1 : magnitude <= max;
+    }
+
+    int64_t BigInt::ToInt64() const {
+        uint64_t magnitude = 0;
+        for (size_t i = magnitude_.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | magnitude_[i];
+        }
+        return static_cast<int64_t>(negative_ ? uint64_t{0} - magnitude : magnitude);
+    }
+
+    std::string BigInt::ToString() const {
+        if (IsZero()) {
+            return "0"s;
+        }
+        vector<uint32_t> chunks;
+        Limbs rest = magnitude_;
+        while (!rest.empty()) {
+            chunks.push_back(DivideBySmall(rest, DECIMAL_CHUNK));
+        }
+        string result = negative_ ? "-"s : ""s;
+        result += to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            string chunk = to_string(chunks[i]);
+            result.append(DECIMAL_CHUNK_DIGITS - chunk.size(), '0');
+            result += chunk;
+        }
+        return result;
+    }
+
+    BigInt operator+(const BigInt& lhs, const BigInt& rhs) {
+        if (lhs.negative_ == rhs.negative_) {
+            return {AddMagnitudes(lhs.magnitude_, rhs.magnitude_), lhs.negative_};
+        }
+        if (CompareMagnitudes(lhs.magnitude_, rhs.magnitude_) >= 0) {
+            return {SubMagnitudes(lhs.magnitude_, rhs.magnitude_), lhs.negative_};
+        }
+        return {SubMagnitudes(rhs.magnitude_, lhs.magnitude_), rhs.negative_};
+    }
+
+    BigInt operator-(const BigInt& lhs, const BigInt& rhs) {
+        return lhs + BigInt{rhs.magnitude_, !rhs.negative_};
+    }
+
+    BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+        return {MultiplyMagnitudes(lhs.magnitude_, rhs.magnitude_), lhs.negative_ != rhs.negative_};
+    }
+
+    BigInt operator/(const BigInt& lhs, const BigInt& rhs) {
+        if (rhs.IsZero()) {
+            throw runtime_error("division by zero");
+        }
+        return {DivideMagnitudes(lhs.magnitude_, rhs.magnitude_), lhs.negative_ != rhs.negative_};
+    }
+
+    bool operator==(const BigInt& lhs, const BigInt& rhs) {
+        return lhs.negative_ == rhs.negative_ && lhs.magnitude_ == rhs.magnitude_;
+    }
+
+    bool operator<(const BigInt& lhs, const BigInt& rhs) {
+        if (lhs.negative_ != rhs.negative_) {
+            return lhs.negative_;
+        }
+        int cmp = CompareMagnitudes(lhs.magnitude_, rhs.magnitude_);
+        return lhs.negative_ ? cmp > 0 : cmp < 0;
+    }
+
+    bool operator!=(const BigInt& lhs, const BigInt& rhs) {
+        return !(lhs == rhs);
+    }
+
+    std::ostream& operator<<(std::ostream& os, const BigInt& value) {
+        return os << value.ToString();
+    }
+
+}  // namespace runtime
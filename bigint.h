@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace runtime {
+
+// Целое число произвольной точности. Хранит знак и модуль числа в системе счисления
+// с основанием 2^32, младшие разряды идут первыми. Ноль представлен пустым модулем
+    class BigInt {
+    public:
+        using Limbs = std::vector<uint32_t>;
+
+        BigInt() = default;
+        BigInt(int64_t value);  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+        // Разбирает десятичную запись числа с необязательным знаком '-'.
+        // Если строка не является записью числа, выбрасывает исключение runtime_error
+        static BigInt FromString(std::string_view digits);
+
+        [[nodiscard]] bool IsZero() const;
+        [[nodiscard]] bool IsNegative() const;
+
+        // Возвращает true, если значение представимо типом int64_t
+        [[nodiscard]] bool FitsInt64() const;
+        // Возвращает значение числа. Допустимо вызывать, только если FitsInt64() == true
+        [[nodiscard]] int64_t ToInt64() const;
+
+        [[nodiscard]] std::string ToString() const;
+
+        friend BigInt operator+(const BigInt& lhs, const BigInt& rhs);
+        friend BigInt operator-(const BigInt& lhs, const BigInt& rhs);
+        friend BigInt operator*(const BigInt& lhs, const BigInt& rhs);
+        // Деление с округлением к нулю, как у встроенных целых чисел C++.
+        // При делении на ноль выбрасывает исключение runtime_error
+        friend BigInt operator/(const BigInt& lhs, const BigInt& rhs);
+
+        friend bool operator==(const BigInt& lhs, const BigInt& rhs);
+        friend bool operator<(const BigInt& lhs, const BigInt& rhs);
+
+    private:
+        BigInt(Limbs magnitude, bool negative);
+
+        Limbs magnitude_;
+        bool negative_ = false;
+    };
+
+    bool operator!=(const BigInt& lhs, const BigInt& rhs);
+    std::ostream& operator<<(std::ostream& os, const BigInt& value);
+
+}  // namespace runtime
@@ -0,0 +1,95 @@
+#include "bigint.h"
+#include "runtime.h"
+#include "test_runner_p.h"
+
+#include <limits>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        void TestBigIntConversions() {
+            const int64_t min = numeric_limits<int64_t>::min();
+            const int64_t max = numeric_limits<int64_t>::max();
+            for (int64_t value : {int64_t{0}, int64_t{1}, int64_t{-1}, min, max}) {
+                BigInt big{value};
+                ASSERT(big.FitsInt64());
+                ASSERT_EQUAL(big.ToInt64(), value);
+                ASSERT_EQUAL(big.ToString(), to_string(value));
+                ASSERT(BigInt::FromString(to_string(value)) == big);
+            }
+
+            BigInt above_max = BigInt{max} + BigInt{1};
+            ASSERT(!above_max.FitsInt64());
+            ASSERT_EQUAL(above_max.ToString(), "9223372036854775808"s);
+            ASSERT((BigInt{0} - above_max).FitsInt64());
+            ASSERT_EQUAL((BigInt{0} - above_max).ToInt64(), min);
+            ASSERT(BigInt::FromString("-0"s).IsZero());
+            ASSERT(!BigInt::FromString("-0"s).IsNegative());
+            ASSERT_THROWS(BigInt::FromString("12a"s), std::runtime_error);
+        }
+
+        void TestBigIntArithmetic() {
+            const BigInt a = BigInt::FromString("123456789012345678901234567890"s);
+            const BigInt b = BigInt::FromString("-987654321098765432109876543210"s);
+            ASSERT_EQUAL((a + b).ToString(), "-864197532086419753208641975320"s);
+            ASSERT_EQUAL((a - b).ToString(), "1111111110111111111011111111100"s);
+            ASSERT_EQUAL((a * b).ToString(), "-121932631137021795226185032733622923332237463801111263526900"s);
+            ASSERT_EQUAL((b / a).ToString(), "-8"s);
+            ASSERT_EQUAL((a * b / b).ToString(), a.ToString());
+            ASSERT_EQUAL((BigInt{-7} / BigInt{2}).ToInt64(), -3);
+            ASSERT_THROWS(a / BigInt{0}, std::runtime_error);
+
+            ASSERT(b < a);
+            ASSERT(!(a < b));
+            ASSERT(BigInt{-2} < BigInt{-1});
+            ASSERT(a != b);
+        }
+
+        void TestBigIntKaratsuba() {
+            // (10^400 - 1)^2 = 10^800 - 2 * 10^400 + 1: множители длиннее порога алгоритма Карацубы
+            const BigInt nines = BigInt::FromString(string(400, '9'));
+            const BigInt square = nines * nines;
+            ASSERT_EQUAL(square.ToString(), string(399, '9') + "8"s + string(399, '0') + "1"s);
+            ASSERT(square / nines == nines);
+            ASSERT((square + BigInt{1}) / nines == nines);
+        }
+
+        void TestNumberOverflowPromotes() {
+            DummyContext context;
+            const int64_t max = numeric_limits<int64_t>::max();
+            auto big = Add(ObjectHolder::Own(Number{max}), ObjectHolder::Own(Number{1}), context);
+            ASSERT(big.TryAs<BigNumber>());
+            ASSERT_EQUAL(big.TryAs<BigNumber>()->GetValue().ToString(), "9223372036854775808"s);
+
+            auto back = Sub(big, ObjectHolder::Own(Number{1}));
+            ASSERT(back.TryAs<Number>());
+            ASSERT_EQUAL(back.TryAs<Number>()->GetValue(), max);
+
+            auto product = Mult(ObjectHolder::Own(Number{max}), ObjectHolder::Own(Number{max}));
+            ASSERT(product.TryAs<BigNumber>());
+            auto quotient = Div(product, ObjectHolder::Own(Number{max}));
+            ASSERT(quotient.TryAs<Number>());
+            ASSERT_EQUAL(quotient.TryAs<Number>()->GetValue(), max);
+
+            auto min = ObjectHolder::Own(Number{numeric_limits<int64_t>::min()});
+            ASSERT(Div(min, ObjectHolder::Own(Number{-1})).TryAs<BigNumber>());
+            ASSERT_THROWS(Div(big, ObjectHolder::Own(Number{0})), std::runtime_error);
+
+            ASSERT(Less(back, big, context));
+            ASSERT(Equal(Add(back, ObjectHolder::Own(Number{1}), context), big, context));
+            ASSERT(IsTrue(big));
+        }
+
+    }  // namespace
+
+    void RunBigIntTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestBigIntConversions);
+        RUN_TEST(tr, runtime::TestBigIntArithmetic);
+        RUN_TEST(tr, runtime::TestBigIntKaratsuba);
+        RUN_TEST(tr, runtime::TestNumberOverflowPromotes);
+    }
+
+}  // namespace runtime
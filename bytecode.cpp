@@ -0,0 +1,605 @@
+#include "bytecode.h"
+
+#include "superinstructions.h"
+
+using namespace std;
+
+namespace bytecode {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+    using ast::Specialization;
+
+    namespace {
+
+        // Узлы, которые компилируются в инструкции машины, а не остаются узлами дерева
+        bool IsOperation(runtime::Executable& node) {
+            return dynamic_cast<ast::BinaryOperation*>(&node) != nullptr
+                   || dynamic_cast<ast::Not*>(&node) != nullptr
+                   || dynamic_cast<ast::Stringify*>(&node) != nullptr;
+        }
+
+        vector<unique_ptr<runtime::Executable>*> Children(runtime::Executable& node) {
+            vector<unique_ptr<runtime::Executable>*> result;
+            node.ForEachChild([&result](unique_ptr<runtime::Executable>& child) {
+                result.push_back(&child);
+            });
+            return result;
+        }
+
+        // Глубина стека значений, необходимая для вычисления node
+        size_t RequiredDepth(runtime::Executable& node) {
+            if (!IsOperation(node)) {
+                return 1;
+            }
+            size_t depth = 0;
+            size_t pushed = 0;
+            for (auto *child : Children(node)) {
+                depth = max(depth, pushed + RequiredDepth(**child));
+                ++pushed;
+            }
+            return depth;
+        }
+
+        OpCode ComparisonOpCode(ast::Comparison::Kind kind) {
+            switch (kind) {
+                case ast::Comparison::Kind::kEqual:
+                    return OpCode::kEqual;
+                case ast::Comparison::Kind::kNotEqual:
+                    return OpCode::kNotEqual;
+                case ast::Comparison::Kind::kLess:
+                    return OpCode::kLess;
+                case ast::Comparison::Kind::kGreater:
+                    return OpCode::kGreater;
+                case ast::Comparison::Kind::kLessOrEqual:
+                    return OpCode::kLessOrEqual;
+                case ast::Comparison::Kind::kGreaterOrEqual:
+                    return OpCode::kGreaterOrEqual;
+                case ast::Comparison::Kind::kCustom:
+                    break;
+            }
+            return OpCode::kCompare;
+        }
+
+        void Emit(unique_ptr<runtime::Executable>& node, Chunk& chunk);
+
+        // Генерирует код операции, дочерние узлы которой уже не нужны самому узлу
+        void EmitOperation(runtime::Executable& node, Chunk& chunk) {
+            auto children = Children(node);
+            if (dynamic_cast<ast::And*>(&node) || dynamic_cast<ast::Or*>(&node)) {
+                Emit(*children[0], chunk);
+                size_t jump = chunk.Emit(dynamic_cast<ast::And*>(&node) ? OpCode::kJumpIfFalseOrPop
+                                                                         : OpCode::kJumpIfTrueOrPop);
+                Emit(*children[1], chunk);
+                chunk.Emit(OpCode::kToBool);
+                chunk.PatchJump(jump);
+                return;
+            }
+            for (auto *child : children) {
+                Emit(*child, chunk);
+            }
+            if (dynamic_cast<ast::Add*>(&node)) {
+                chunk.Emit(OpCode::kAdd, chunk.AddState());
+            }
+            else if (dynamic_cast<ast::Sub*>(&node)) {
+                chunk.Emit(OpCode::kSub, chunk.AddState());
+            }
+            else if (dynamic_cast<ast::Mult*>(&node)) {
+                chunk.Emit(OpCode::kMult, chunk.AddState());
+            }
+            else if (dynamic_cast<ast::Div*>(&node)) {
+                chunk.Emit(OpCode::kDiv, chunk.AddState());
+            }
+            else if (auto *cmp = dynamic_cast<ast::Comparison*>(&node)) {
+                OpCode op = ComparisonOpCode(cmp->GetKind());
+                chunk.Emit(op, op == OpCode::kCompare ? chunk.AddComparator(cmp->GetComparator()) : chunk.AddState());
+            }
+            else if (dynamic_cast<ast::Not*>(&node)) {
+                chunk.Emit(OpCode::kNot);
+            }
+            else if (dynamic_cast<ast::Stringify*>(&node)) {
+                chunk.Emit(OpCode::kStringify);
+            }
+            else {
+                throw runtime_error("unsupported operation in bytecode compiler");
+            }
+        }
+
+        void Emit(unique_ptr<runtime::Executable>& node, Chunk& chunk) {
+            if (IsOperation(*node)) {
+                EmitOperation(*node, chunk);
+            }
+            else if (const auto *num = dynamic_cast<ast::NumericConst*>(node.get())) {
+                chunk.Emit(OpCode::kLoadConst, chunk.AddConstant(ObjectHolder::Own(runtime::Number{num->GetValue()})));
+            }
+            else if (const auto *big = dynamic_cast<ast::BigNumericConst*>(node.get())) {
+                chunk.Emit(OpCode::kLoadConst, chunk.AddConstant(ObjectHolder::Own(runtime::BigNumber{big->GetValue()})));
+            }
+            else if (const auto *str = dynamic_cast<ast::StringConst*>(node.get())) {
+                chunk.Emit(OpCode::kLoadConst, chunk.AddConstant(ObjectHolder::Own(runtime::String{str->GetValue()})));
+            }
+            else if (const auto *boolean = dynamic_cast<ast::BoolConst*>(node.get())) {
+                chunk.Emit(OpCode::kLoadConst, chunk.AddConstant(ObjectHolder::Own(runtime::Bool{boolean->GetValue()})));
+            }
+            else if (dynamic_cast<ast::None*>(node.get())) {
+                chunk.Emit(OpCode::kLoadConst, chunk.AddConstant(ObjectHolder::None()));
+            }
+            else if (const auto *var = dynamic_cast<ast::VariableValue*>(node.get())) {
+                const auto &ids = var->GetDottedIds();
+                if (ids.size() == 1) {
+                    chunk.Emit(OpCode::kLoadName, chunk.AddName(ids.front()));
+                }
+                else {
+                    chunk.Emit(OpCode::kLoadDotted, chunk.AddDottedName(ids));
+                }
+            }
+            else if (const auto *field = dynamic_cast<ast::FieldValue*>(node.get())) {
+                chunk.Emit(OpCode::kLoadDotted, chunk.AddDottedName({field->GetObjectName(), field->GetFieldName()}));
+            }
+            else {
+                chunk.Emit(OpCode::kEvalNode, chunk.AddNode(std::move(node)));
+            }
+        }
+
+        template <typename T>
+        bool CompareValues(OpCode op, const T& lhs, const T& rhs) {
+            switch (op) {
+                case OpCode::kEqual:
+                    return lhs == rhs;
+                case OpCode::kNotEqual:
+                    return lhs != rhs;
+                case OpCode::kLess:
+                    return lhs < rhs;
+                case OpCode::kGreater:
+                    return rhs < lhs;
+                case OpCode::kLessOrEqual:
+                    return !(rhs < lhs);
+                default:
+                    return !(lhs < rhs);
+            }
+        }
+
+        // Встроенное сравнение со специализацией по типам операндов, как в ast::Comparison
+        bool CompareObjects(OpCode op, ast::SpecializationState& state, const ObjectHolder& lhs,
+                            const ObjectHolder& rhs, Context& context) {
+            switch (state) {
+                case Specialization::kNumbers: {
+                    const auto *lhs_number = lhs.TryAs<runtime::Number>();
+                    const auto *rhs_number = rhs.TryAs<runtime::Number>();
+                    if (lhs_number && rhs_number) {
+                        return CompareValues(op, lhs_number->GetValue(), rhs_number->GetValue());
+                    }
+                    state = Specialization::kGeneric;
+                    break;
+                }
+                case Specialization::kStrings: {
+                    const auto *lhs_string = lhs.TryAs<runtime::String>();
+                    const auto *rhs_string = rhs.TryAs<runtime::String>();
+                    if (lhs_string && rhs_string) {
+                        return CompareValues(op, *lhs_string, *rhs_string);
+                    }
+                    state = Specialization::kGeneric;
+                    break;
+                }
+                case Specialization::kUninitialized: {
+                    const Specialization observed = ast::BinaryOperation::Observe(lhs, rhs);
+                    state = observed == Specialization::kInstance ? Specialization::kGeneric : observed;
+                    break;
+                }
+                case Specialization::kInstance:
+                case Specialization::kGeneric:
+                    break;
+            }
+            switch (op) {
+                case OpCode::kEqual:
+                    return runtime::Equal(lhs, rhs, context);
+                case OpCode::kNotEqual:
+                    return runtime::NotEqual(lhs, rhs, context);
+                case OpCode::kLess:
+                    return runtime::Less(lhs, rhs, context);
+                case OpCode::kGreater:
+                    return runtime::Greater(lhs, rhs, context);
+                case OpCode::kLessOrEqual:
+                    return runtime::LessOrEqual(lhs, rhs, context);
+                default:
+                    return runtime::GreaterOrEqual(lhs, rhs, context);
+            }
+        }
+
+        // Общие неизменяемые значения True и False. Результаты сравнений и логических операций
+        // кладутся на стек невладеющими ссылками на них, без выделения памяти под runtime::Bool
+        runtime::Bool TRUE_VALUE{true};
+        runtime::Bool FALSE_VALUE{false};
+
+        ObjectHolder BoolValue(bool value) {
+            return ObjectHolder::Share(value ? TRUE_VALUE : FALSE_VALUE);
+        }
+
+        // Приводит значение к bool; для общих True и False обходится сравнением адресов
+        bool Truth(const ObjectHolder& value) {
+            if (value.Get() == &TRUE_VALUE) {
+                return true;
+            }
+            if (value.Get() == &FALSE_VALUE) {
+                return false;
+            }
+            return runtime::IsTrue(value);
+        }
+
+        // Быстрая ветка для двух чисел: результат checked, а при переполнении - результат generic.
+        // Если операнды не числа, возвращает пустой ObjectHolder
+        template <typename Checked, typename Generic>
+        ObjectHolder NumbersFastPath(const ObjectHolder& lhs, const ObjectHolder& rhs, Checked checked,
+                                     Generic generic) {
+            const auto *lhs_number = lhs.TryAs<runtime::Number>();
+            const auto *rhs_number = rhs.TryAs<runtime::Number>();
+            if (lhs_number && rhs_number) {
+                int64_t result = 0;
+                if (checked(lhs_number->GetValue(), rhs_number->GetValue(), result)) {
+                    return ObjectHolder::Own(runtime::Number{result});
+                }
+                return generic(lhs, rhs);
+            }
+            return ObjectHolder::None();
+        }
+
+        // Сложение со специализацией по типам операндов, как в ast::Add
+        ObjectHolder AddObjects(ast::SpecializationState& state, const ObjectHolder& lhs, const ObjectHolder& rhs,
+                                Context& context) {
+            const auto generic = [&context](const ObjectHolder& object1, const ObjectHolder& object2) {
+                return runtime::Add(object1, object2, context);
+            };
+            switch (state) {
+                case Specialization::kNumbers:
+                    if (ObjectHolder result = NumbersFastPath(lhs, rhs, runtime::CheckedAdd, generic)) {
+                        return result;
+                    }
+                    break;
+                case Specialization::kStrings: {
+                    const auto *lhs_string = lhs.TryAs<runtime::String>();
+                    const auto *rhs_string = rhs.TryAs<runtime::String>();
+                    if (lhs_string && rhs_string) {
+                        return ObjectHolder::Own(runtime::String::Concat(*lhs_string, *rhs_string));
+                    }
+                    break;
+                }
+                case Specialization::kUninitialized:
+                    state = ast::BinaryOperation::Observe(lhs, rhs);
+                    return generic(lhs, rhs);
+                case Specialization::kInstance:
+                case Specialization::kGeneric:
+                    // runtime::Add сам вызывает метод __add__ объекта
+                    return generic(lhs, rhs);
+            }
+            state = Specialization::kGeneric;
+            return generic(lhs, rhs);
+        }
+
+        // Вычитание, умножение и деление специализируются только для чисел, как в ast::Sub и др.
+        template <typename Checked, typename Generic>
+        ObjectHolder NumericObjects(ast::SpecializationState& state, const ObjectHolder& lhs, const ObjectHolder& rhs,
+                                    Checked checked, Generic generic) {
+            if (state != Specialization::kGeneric) {
+                if (ObjectHolder result = NumbersFastPath(lhs, rhs, checked, generic)) {
+                    state = Specialization::kNumbers;
+                    return result;
+                }
+                state = Specialization::kGeneric;
+            }
+            return generic(lhs, rhs);
+        }
+
+        ObjectHolder LoadName(const string& name, Closure& closure) {
+            auto it = closure.find(name);
+            if (it == closure.end()) {
+                throw runtime_error("this variable doesn't exist");
+            }
+            return it->second;
+        }
+
+    }  // namespace
+
+    size_t Chunk::Emit(OpCode op, uint32_t operand) {
+        code_.push_back({nullptr, op, operand});
+        return code_.size() - 1;
+    }
+
+    void Chunk::PatchJump(size_t at) {
+        code_.at(at).operand = static_cast<uint32_t>(code_.size());
+    }
+
+    void Chunk::FreezeConstants() {
+        for (ObjectHolder &constant : constants_) {
+            if (constant.UseCount() > 0) {
+                frozen_constants_.push_back(constant);
+                constant = ObjectHolder::Share(*constant);
+            }
+        }
+    }
+
+    uint32_t Chunk::AddConstant(ObjectHolder value) {
+        constants_.push_back(std::move(value));
+        return static_cast<uint32_t>(constants_.size() - 1);
+    }
+
+    uint32_t Chunk::AddName(std::string name) {
+        names_.push_back(std::move(name));
+        return static_cast<uint32_t>(names_.size() - 1);
+    }
+
+    uint32_t Chunk::AddDottedName(std::vector<std::string> dotted_ids) {
+        dotted_names_.push_back(std::move(dotted_ids));
+        return static_cast<uint32_t>(dotted_names_.size() - 1);
+    }
+
+    uint32_t Chunk::AddNode(std::unique_ptr<runtime::Executable> node) {
+        nodes_.push_back(std::move(node));
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    uint32_t Chunk::AddState() {
+        states_.emplace_back();
+        return static_cast<uint32_t>(states_.size() - 1);
+    }
+
+    uint32_t Chunk::AddComparator(ast::Comparison::Comparator cmp) {
+        comparators_.push_back(std::move(cmp));
+        return static_cast<uint32_t>(comparators_.size() - 1);
+    }
+
+    void Chunk::Finalize() {
+        Emit(OpCode::kReturn);
+#if defined(__GNUC__) || defined(__clang__)
+        const void *const *handlers = nullptr;
+        Interpret<true>(nullptr, nullptr, nullptr, &handlers);
+        for (auto &instruction : code_) {
+            instruction.handler = handlers[static_cast<size_t>(instruction.op)];
+        }
+#endif
+    }
+
+    ObjectHolder Chunk::Run(Closure& closure, Context& context, Dispatch dispatch) const {
+#if defined(__GNUC__) || defined(__clang__)
+        if (dispatch == Dispatch::kThreaded) {
+            return Interpret<true>(code_.data(), &closure, &context, nullptr);
+        }
+#else
+        (void)dispatch;
+#endif
+        return Interpret<false>(code_.data(), &closure, &context, nullptr);
+    }
+
+    bool Chunk::RunCondition(Closure& closure, Context& context, Dispatch dispatch) const {
+        return Truth(Run(closure, context, dispatch));
+    }
+
+    size_t Chunk::Size() const {
+        return code_.size();
+    }
+
+    std::vector<std::unique_ptr<runtime::Executable>>& Chunk::Nodes() {
+        return nodes_;
+    }
+
+/*
+Каждый обработчик заканчивается собственным переходом DISPATCH() к следующей инструкции.
+При прямом шитом коде это косвенный переход по адресу, записанному в самой инструкции,
+и у предсказателя переходов своя история для каждого обработчика. В переносимом варианте
+все обработчики возвращаются к единому switch.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define DISPATCH()                   \
+    do {                             \
+        if constexpr (Threaded) {    \
+            goto *ip->handler;       \
+        } else {                     \
+            goto dispatch_switch;    \
+        }                            \
+    } while (false)
+#else
+#define DISPATCH() goto dispatch_switch
+#endif
+
+#define NEXT() \
+    ++ip;      \
+    DISPATCH()
+
+    template <bool Threaded>
+    ObjectHolder Chunk::Interpret(const Instruction* ip, Closure* closure, Context* context,
+                                  const void* const** handlers) const {
+#if defined(__GNUC__) || defined(__clang__)
+        if constexpr (Threaded) {
+            // Порядок должен совпадать с порядком OpCode
+            static const void *const HANDLERS[OPCODE_COUNT] = {
+                    &&op_load_const, &&op_load_name, &&op_load_dotted, &&op_eval_node,
+                    &&op_add, &&op_sub, &&op_mult, &&op_div,
+                    &&op_compare_builtin, &&op_compare_builtin, &&op_compare_builtin, &&op_compare_builtin,
+                    &&op_compare_builtin, &&op_compare_builtin, &&op_compare,
+                    &&op_not, &&op_to_bool, &&op_jump_if_false_or_pop, &&op_jump_if_true_or_pop,
+                    &&op_stringify, &&op_return,
+            };
+            if (ip == nullptr) {
+                *handlers = HANDLERS;
+                return ObjectHolder::None();
+            }
+        }
+#endif
+        (void)handlers;
+
+        ObjectHolder stack[MAX_STACK];
+        ObjectHolder *sp = stack;
+
+        DISPATCH();
+
+    [[maybe_unused]] dispatch_switch:
+        switch (ip->op) {
+            case OpCode::kLoadConst: goto op_load_const;
+            case OpCode::kLoadName: goto op_load_name;
+            case OpCode::kLoadDotted: goto op_load_dotted;
+            case OpCode::kEvalNode: goto op_eval_node;
+            case OpCode::kAdd: goto op_add;
+            case OpCode::kSub: goto op_sub;
+            case OpCode::kMult: goto op_mult;
+            case OpCode::kDiv: goto op_div;
+            case OpCode::kEqual:
+            case OpCode::kNotEqual:
+            case OpCode::kLess:
+            case OpCode::kGreater:
+            case OpCode::kLessOrEqual:
+            case OpCode::kGreaterOrEqual: goto op_compare_builtin;
+            case OpCode::kCompare: goto op_compare;
+            case OpCode::kNot: goto op_not;
+            case OpCode::kToBool: goto op_to_bool;
+            case OpCode::kJumpIfFalseOrPop: goto op_jump_if_false_or_pop;
+            case OpCode::kJumpIfTrueOrPop: goto op_jump_if_true_or_pop;
+            case OpCode::kStringify: goto op_stringify;
+            case OpCode::kReturn: goto op_return;
+        }
+        throw runtime_error("unknown bytecode instruction");
+
+    op_load_const:
+        *sp++ = constants_[ip->operand];
+        NEXT();
+
+    op_load_name:
+        *sp++ = LoadName(names_[ip->operand], *closure);
+        NEXT();
+
+    op_load_dotted: {
+        const auto &ids = dotted_names_[ip->operand];
+        ObjectHolder object = LoadName(ids.front(), *closure);
+        for (auto it = ids.begin() + 1; it != ids.end(); ++it) {
+            object = object.TryAs<runtime::ClassInstance>()->Fields().at(*it);
+        }
+        *sp++ = std::move(object);
+        NEXT();
+    }
+
+    op_eval_node:
+        *sp++ = nodes_[ip->operand]->Execute(*closure, *context);
+        NEXT();
+
+    op_add:
+        --sp;
+        sp[-1] = AddObjects(states_[ip->operand], sp[-1], sp[0], *context);
+        sp[0] = ObjectHolder::None();
+        NEXT();
+
+    op_sub:
+        --sp;
+        sp[-1] = NumericObjects(states_[ip->operand], sp[-1], sp[0], runtime::CheckedSub, runtime::Sub);
+        sp[0] = ObjectHolder::None();
+        NEXT();
+
+    op_mult:
+        --sp;
+        sp[-1] = NumericObjects(states_[ip->operand], sp[-1], sp[0], runtime::CheckedMult, runtime::Mult);
+        sp[0] = ObjectHolder::None();
+        NEXT();
+
+    op_div:
+        --sp;
+        sp[-1] = NumericObjects(states_[ip->operand], sp[-1], sp[0], runtime::CheckedDiv, runtime::Div);
+        sp[0] = ObjectHolder::None();
+        NEXT();
+
+    op_compare_builtin:
+        --sp;
+        sp[-1] = BoolValue(CompareObjects(ip->op, states_[ip->operand], sp[-1], sp[0], *context));
+        sp[0] = ObjectHolder::None();
+        NEXT();
+
+    op_compare: {
+        --sp;
+        sp[-1] = BoolValue(comparators_[ip->operand](sp[-1], sp[0], *context));
+        sp[0] = ObjectHolder::None();
+        NEXT();
+    }
+
+    op_not:
+        sp[-1] = BoolValue(!Truth(sp[-1]));
+        NEXT();
+
+    op_to_bool:
+        sp[-1] = BoolValue(Truth(sp[-1]));
+        NEXT();
+
+    op_jump_if_false_or_pop:
+        if (!Truth(sp[-1])) {
+            sp[-1] = BoolValue(false);
+            ip = code_.data() + ip->operand;
+            DISPATCH();
+        }
+        *--sp = ObjectHolder::None();
+        NEXT();
+
+    op_jump_if_true_or_pop:
+        if (Truth(sp[-1])) {
+            sp[-1] = BoolValue(true);
+            ip = code_.data() + ip->operand;
+            DISPATCH();
+        }
+        *--sp = ObjectHolder::None();
+        NEXT();
+
+    op_stringify:
+        sp[-1] = runtime::ToString(sp[-1], *context);
+        NEXT();
+
+    op_return:
+        return std::move(sp[-1]);
+    }
+
+#undef NEXT
+#undef DISPATCH
+
+    CompiledExpression::CompiledExpression(Chunk chunk)
+            : chunk_(std::move(chunk)) {
+    }
+
+    ObjectHolder CompiledExpression::Execute(Closure& closure, Context& context) {
+        return chunk_.Run(closure, context);
+    }
+
+    bool CompiledExpression::EvaluateCondition(Closure& closure, Context& context) {
+        return chunk_.RunCondition(closure, context);
+    }
+
+    void CompiledExpression::ForEachChild(const ast::ChildVisitor& visitor) {
+        for (auto &node : chunk_.Nodes()) {
+            visitor(node);
+        }
+    }
+
+    const Chunk& CompiledExpression::GetChunk() const {
+        return chunk_;
+    }
+
+    void CompiledExpression::FreezeConstants() {
+        chunk_.FreezeConstants();
+    }
+
+    bool Compile(runtime::Executable& expression, Chunk& chunk) {
+        if (!IsOperation(expression) || RequiredDepth(expression) > Chunk::MAX_STACK) {
+            return false;
+        }
+        EmitOperation(expression, chunk);
+        chunk.Finalize();
+        return true;
+    }
+
+    size_t CompileExpressions(std::unique_ptr<runtime::Executable>& program) {
+        size_t compiled = 0;
+        Chunk chunk;
+        if (Compile(*program, chunk)) {
+            program = make_unique<CompiledExpression>(std::move(chunk));
+            ++compiled;
+        }
+        program->ForEachChild([&compiled](unique_ptr<runtime::Executable>& child) {
+            compiled += CompileExpressions(child);
+        });
+        return compiled;
+    }
+
+}  // namespace bytecode
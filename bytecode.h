@@ -0,0 +1,150 @@
+#pragma once
+
+#include "runtime.h"
+#include "statement.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Байткод для выражений Mython.
+// Дерево выражения (арифметика, сравнения, логические операции, константы и переменные)
+// компилируется в плоский массив инструкций стековой машины. Подвыражения, которые
+// машина не умеет исполнять сама (вызовы методов, создание объектов и т.п.), остаются
+// узлами дерева и вычисляются инструкцией kEvalNode.
+// Арифметические инструкции и сравнения самоспециализируются по типам операндов так же,
+// как узлы ast::BinaryOperation, поэтому для скомпилированных выражений машина -
+// единственный путь со специализацией.
+namespace bytecode {
+
+    enum class OpCode : uint8_t {
+        kLoadConst,       // кладёт на стек константу constants[operand]
+        kLoadName,        // кладёт на стек значение переменной names[operand]
+        kLoadDotted,      // кладёт на стек значение цепочки полей dotted_names[operand]
+        kEvalNode,        // вычисляет узел дерева nodes[operand] и кладёт результат на стек
+        kAdd,             // operand арифметических инструкций и встроенных сравнений - номер
+        kSub,             // состояния специализации states[operand]
+        kMult,
+        kDiv,
+        kEqual,
+        kNotEqual,
+        kLess,
+        kGreater,
+        kLessOrEqual,
+        kGreaterOrEqual,
+        kCompare,         // сравнение пользовательским компаратором comparators[operand]
+        kNot,
+        kToBool,          // заменяет вершину стека значением Bool(IsTrue(вершина))
+        kJumpIfFalseOrPop,  // если вершина ложна, заменяет её на False и переходит на operand, иначе снимает её
+        kJumpIfTrueOrPop,   // если вершина истинна, заменяет её на True и переходит на operand, иначе снимает её
+        kStringify,
+        kReturn,          // завершает выполнение, возвращая вершину стека
+    };
+
+    inline constexpr size_t OPCODE_COUNT = static_cast<size_t>(OpCode::kReturn) + 1;
+
+    struct Instruction {
+        // Адрес обработчика инструкции при прямом шитом коде (direct threading).
+        // Заполняется в Chunk::Finalize, при диспетчеризации через switch не используется
+        const void* handler = nullptr;
+        OpCode op;
+        uint32_t operand = 0;
+    };
+
+    // Способ диспетчеризации инструкций
+    enum class Dispatch {
+        kThreaded,  // прямой шитый код (GCC/Clang labels-as-values), свой косвенный переход на каждый обработчик
+        kSwitch,    // переносимый цикл со switch и единой точкой диспетчеризации
+    };
+
+#if defined(__GNUC__) || defined(__clang__)
+    inline constexpr Dispatch DEFAULT_DISPATCH = Dispatch::kThreaded;
+#else
+    inline constexpr Dispatch DEFAULT_DISPATCH = Dispatch::kSwitch;
+#endif
+
+    // Скомпилированное выражение: инструкции и таблицы их операндов
+    class Chunk {
+    public:
+        // Максимальная глубина стека значений, которую поддерживает машина
+        static constexpr size_t MAX_STACK = 32;
+
+        size_t Emit(OpCode op, uint32_t operand = 0);
+        // Устанавливает целевой адрес перехода инструкции at на текущий конец кода
+        void PatchJump(size_t at);
+
+        uint32_t AddConstant(runtime::ObjectHolder value);
+        uint32_t AddName(std::string name);
+        uint32_t AddDottedName(std::vector<std::string> dotted_ids);
+        uint32_t AddNode(std::unique_ptr<runtime::Executable> node);
+        uint32_t AddComparator(ast::Comparison::Comparator cmp);
+        // Добавляет состояние специализации для арифметической инструкции или сравнения
+        uint32_t AddState();
+
+        // Фиксирует код: дописывает kReturn и проставляет адреса обработчиков
+        void Finalize();
+
+        // Переключает kLoadConst на невладеющие ссылки на константы (см. ast::ValueStatement::Freeze)
+        void FreezeConstants();
+
+        // Исполняет байткод над переменными closure.
+        // Dispatch::kThreaded доступен только при сборке GCC/Clang, иначе используется switch
+        runtime::ObjectHolder Run(runtime::Closure& closure, runtime::Context& context,
+                                  Dispatch dispatch = DEFAULT_DISPATCH) const;
+        // Исполняет байткод в позиции условия и возвращает истинность результата.
+        // Результат сравнения или логической операции не упаковывается в runtime::Bool
+        bool RunCondition(runtime::Closure& closure, runtime::Context& context,
+                          Dispatch dispatch = DEFAULT_DISPATCH) const;
+
+        // Возвращает количество инструкций
+        [[nodiscard]] size_t Size() const;
+        [[nodiscard]] std::vector<std::unique_ptr<runtime::Executable>>& Nodes();
+
+    private:
+        // Цикл интерпретации. Если ip равен nullptr, только возвращает через handlers
+        // таблицу адресов обработчиков, упорядоченную по OpCode
+        template <bool Threaded>
+        runtime::ObjectHolder Interpret(const Instruction* ip, runtime::Closure* closure,
+                                        runtime::Context* context, const void* const** handlers) const;
+
+        std::vector<Instruction> code_;
+        std::vector<runtime::ObjectHolder> constants_;
+        // Владельцы констант после FreezeConstants
+        std::vector<runtime::ObjectHolder> frozen_constants_;
+        std::vector<std::string> names_;
+        std::vector<std::vector<std::string>> dotted_names_;
+        std::vector<std::unique_ptr<runtime::Executable>> nodes_;
+        std::vector<ast::Comparison::Comparator> comparators_;
+        // Состояния меняются при исполнении и не перемещаются при добавлении новых (атомарны)
+        mutable std::deque<ast::SpecializationState> states_;
+    };
+
+    // Узел дерева, исполняющий скомпилированное выражение
+    class CompiledExpression : public runtime::Executable {
+        Chunk chunk_;
+    public:
+        explicit CompiledExpression(Chunk chunk);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        // Вычисляет выражение в позиции условия (if, while, and, or, not) без создания runtime::Bool
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
+        // Обходит поддеревья, оставшиеся узлами дерева (инструкции kEvalNode)
+        void ForEachChild(const ast::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const Chunk& GetChunk() const;
+        void FreezeConstants();
+    };
+
+    // Пытается скомпилировать выражение expression в байткод.
+    // При успехе поддеревья expression переносятся в Chunk, а сам expression становится непригоден.
+    // Возвращает false, если expression не является выражением, которое имеет смысл компилировать
+    // (константа, переменная, вызов метода и т.п.) или требует стека глубже Chunk::MAX_STACK, -
+    // в этом случае expression не изменяется
+    bool Compile(runtime::Executable& expression, Chunk& chunk);
+
+    // Проходит по дереву программы и заменяет выражения с операциями узлами CompiledExpression.
+    // Возвращает количество скомпилированных выражений
+    size_t CompileExpressions(std::unique_ptr<runtime::Executable>& program);
+
+}  // namespace bytecode
@@ -0,0 +1,174 @@
+#include "bytecode.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace bytecode {
+
+    namespace {
+
+        string RunProgram(const string& program, bool compile) {
+            istringstream is(program);
+            parse::Lexer lexer(is);
+            auto tree = ParseProgram(lexer);
+            if (compile) {
+                CompileExpressions(tree);
+            }
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            tree->Execute(closure, context);
+            return context.output.str();
+        }
+
+        void TestCompiledProgramMatchesTree() {
+            const string program = R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __str__():
+    return '(' + str(self.x) + '; ' + str(self.y) + ')'
+
+  def norm():
+    return self.x * self.x + self.y * self.y
+
+a = 7
+b = 3
+p = Point(a - b, a / b)
+print a + b * 2 - (a - b) / 2, a * -1, p, p.norm() + 1
+print a < b, a > b, a == b, a != b, a <= 7, b >= 4
+print a > b and b > 0, a < b or not b < 0, not a == 7
+print 'a' + 'b' < 'b', str(a + b) + '!'
+)"s;
+            const string expected = "11 -7 (4; 2) 21\nFalse True False True True False\nTrue True False\nTrue 10!\n"s;
+            ASSERT_EQUAL(RunProgram(program, false), expected);
+            ASSERT_EQUAL(RunProgram(program, true), expected);
+        }
+
+        void TestCompilesOnlyOperations() {
+            istringstream is(R"(
+x = 1
+y = x + 2
+print x, y * 3, str(y)
+)"s);
+            parse::Lexer lexer(is);
+            auto tree = ParseProgram(lexer);
+            ASSERT_EQUAL(CompileExpressions(tree), 3U);
+        }
+
+        void TestShortCircuit() {
+            runtime::DummyContext context;
+            runtime::Closure closure = {{"t"s, runtime::ObjectHolder::Own(runtime::Bool{true})}};
+
+            // Правый операнд обращается к несуществующей переменной и не должен вычисляться
+            auto expression = make_unique<ast::Or>(make_unique<ast::VariableValue>("t"s),
+                                                   make_unique<ast::VariableValue>("unknown"s));
+            Chunk chunk;
+            ASSERT(Compile(*expression, chunk));
+            for (Dispatch dispatch : {Dispatch::kThreaded, Dispatch::kSwitch}) {
+                auto result = chunk.Run(closure, context, dispatch);
+                ASSERT(result.TryAs<runtime::Bool>() && result.TryAs<runtime::Bool>()->GetValue());
+            }
+            closure["t"s] = runtime::ObjectHolder::Own(runtime::Bool{false});
+            ASSERT_THROWS(chunk.Run(closure, context), std::runtime_error);
+        }
+
+        void TestSwitchDispatch() {
+            runtime::DummyContext context;
+            runtime::Closure closure = {{"x"s, runtime::ObjectHolder::Own(runtime::Number{6})}};
+
+            auto expression = make_unique<ast::Div>(
+                    make_unique<ast::Mult>(make_unique<ast::VariableValue>("x"s), make_unique<ast::NumericConst>(7)),
+                    make_unique<ast::Sub>(make_unique<ast::VariableValue>("x"s), make_unique<ast::NumericConst>(4)));
+            Chunk chunk;
+            ASSERT(Compile(*expression, chunk));
+            ASSERT_EQUAL(chunk.Size(), 8U);
+            for (Dispatch dispatch : {Dispatch::kThreaded, Dispatch::kSwitch}) {
+                auto result = chunk.Run(closure, context, dispatch);
+                ASSERT(result.TryAs<runtime::Number>());
+                ASSERT_EQUAL(result.TryAs<runtime::Number>()->GetValue(), 21);
+            }
+            closure["x"s] = runtime::ObjectHolder::Own(runtime::Number{4});
+            ASSERT_THROWS(chunk.Run(closure, context, Dispatch::kSwitch), std::runtime_error);
+            closure["x"s] = runtime::ObjectHolder::Own(runtime::String{"4"s});
+            ASSERT_THROWS(chunk.Run(closure, context), std::runtime_error);
+        }
+
+        void TestConditionsAreNotBoxed() {
+            runtime::DummyContext context;
+            runtime::Closure closure = {{"i"s, runtime::ObjectHolder::Own(runtime::Number{1})},
+                                        {"n"s, runtime::ObjectHolder::Own(runtime::Number{3})}};
+
+            // not (i < n and i == 1) or n > 2
+            unique_ptr<runtime::Executable> expression = make_unique<ast::Or>(
+                    make_unique<ast::Not>(make_unique<ast::And>(
+                            make_unique<ast::Comparison>(runtime::Less, make_unique<ast::VariableValue>("i"s),
+                                                         make_unique<ast::VariableValue>("n"s)),
+                            make_unique<ast::Comparison>(runtime::Equal, make_unique<ast::VariableValue>("i"s),
+                                                         make_unique<ast::NumericConst>(1)))),
+                    make_unique<ast::Comparison>(runtime::Greater, make_unique<ast::VariableValue>("n"s),
+                                                 make_unique<ast::NumericConst>(2)));
+            ASSERT_EQUAL(CompileExpressions(expression), 1U);
+            ASSERT(dynamic_cast<CompiledExpression*>(expression.get()));
+
+            ASSERT(expression->EvaluateCondition(closure, context));
+            // Результат - общий объект True, а не новый runtime::Bool в куче
+            auto result = expression->Execute(closure, context);
+            ASSERT(result.TryAs<runtime::Bool>() && result.TryAs<runtime::Bool>()->GetValue());
+            ASSERT_EQUAL(result.UseCount(), 0);
+
+            closure["n"s] = runtime::ObjectHolder::Own(runtime::Number{2});
+            ASSERT(!expression->EvaluateCondition(closure, context));
+            result = expression->Execute(closure, context);
+            ASSERT(result.TryAs<runtime::Bool>() && !result.TryAs<runtime::Bool>()->GetValue());
+            ASSERT_EQUAL(result.UseCount(), 0);
+        }
+
+        void TestQuickenedInstructionsFallBack() {
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            auto expression = make_unique<ast::Comparison>(
+                    runtime::Less,
+                    make_unique<ast::Add>(make_unique<ast::VariableValue>("x"s), make_unique<ast::VariableValue>("y"s)),
+                    make_unique<ast::VariableValue>("z"s));
+            Chunk chunk;
+            ASSERT(Compile(*expression, chunk));
+
+            auto run = [&](runtime::ObjectHolder x, runtime::ObjectHolder y, runtime::ObjectHolder z) {
+                closure = {{"x"s, std::move(x)}, {"y"s, std::move(y)}, {"z"s, std::move(z)}};
+                return chunk.RunCondition(closure, context);
+            };
+            using runtime::ObjectHolder;
+            // Инструкции специализируются под числа, затем видят строки и переходят в общую ветку
+            ASSERT(run(ObjectHolder::Own(runtime::Number{1}), ObjectHolder::Own(runtime::Number{2}),
+                       ObjectHolder::Own(runtime::Number{4})));
+            ASSERT(!run(ObjectHolder::Own(runtime::Number{2}), ObjectHolder::Own(runtime::Number{2}),
+                        ObjectHolder::Own(runtime::Number{4})));
+            ASSERT(run(ObjectHolder::Own(runtime::String{"a"s}), ObjectHolder::Own(runtime::String{"b"s}),
+                       ObjectHolder::Own(runtime::String{"b"s})));
+            ASSERT(!run(ObjectHolder::Own(runtime::String{"b"s}), ObjectHolder::Own(runtime::String{"b"s}),
+                        ObjectHolder::Own(runtime::String{"a"s})));
+            ASSERT(run(ObjectHolder::Own(runtime::Number{1}), ObjectHolder::Own(runtime::Number{2}),
+                       ObjectHolder::Own(runtime::Number{4})));
+            // Переполнение в специализированной ветке переходит к длинным числам
+            ASSERT(!run(ObjectHolder::Own(runtime::Number{INT64_MAX}), ObjectHolder::Own(runtime::Number{1}),
+                        ObjectHolder::Own(runtime::Number{0})));
+            ASSERT_THROWS(run(ObjectHolder::Own(runtime::Number{1}), ObjectHolder::Own(runtime::String{"b"s}),
+                              ObjectHolder::Own(runtime::Number{0})), std::runtime_error);
+        }
+
+    }  // namespace
+
+    void RunBytecodeTests(TestRunner& tr) {
+        RUN_TEST(tr, bytecode::TestCompiledProgramMatchesTree);
+        RUN_TEST(tr, bytecode::TestCompilesOnlyOperations);
+        RUN_TEST(tr, bytecode::TestShortCircuit);
+        RUN_TEST(tr, bytecode::TestSwitchDispatch);
+        RUN_TEST(tr, bytecode::TestConditionsAreNotBoxed);
+        RUN_TEST(tr, bytecode::TestQuickenedInstructionsFallBack);
+    }
+
+}  // namespace bytecode
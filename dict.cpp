@@ -0,0 +1,245 @@
+#include "dict.h"
+
+#include <functional>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        constexpr int8_t EMPTY = -128;
+
+        // Перемешивает биты хеша, чтобы и номер группы, и 7 бит управляющего байта
+        // зависели от всех битов исходного значения (финализатор MurmurHash3)
+        uint64_t Mix(uint64_t hash) {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ULL;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        int8_t ControlByte(uint64_t hash) {
+            return static_cast<int8_t>(hash & 0x7F);
+        }
+
+        // Битовая маска ячеек группы, управляющий байт которых равен value
+        uint32_t MatchGroup(const int8_t* group, int8_t value) {
+#ifdef __SSE2__
+            const __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value))));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < 16; ++i) {
+                if (group[i] == value) {
+                    mask |= uint32_t{1} << i;
+                }
+            }
+            return mask;
+#endif
+        }
+
+        enum class KeyKind {
+            kNone,
+            kBool,
+            kInteger,
+            kString,
+            kInstance,
+        };
+
+        KeyKind KindOf(const ObjectHolder& key) {
+            if (!key) {
+                return KeyKind::kNone;
+            }
+            if (key.TryAs<Bool>()) {
+                return KeyKind::kBool;
+            }
+            if (key.TryAs<Number>() || key.TryAs<BigNumber>()) {
+                return KeyKind::kInteger;
+            }
+            if (key.TryAs<String>()) {
+                return KeyKind::kString;
+            }
+            if (key.TryAs<ClassInstance>()) {
+                return KeyKind::kInstance;
+            }
+            throw runtime_error("unhashable type");
+        }
+
+        bool KeysEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+            if (lhs.Get() == rhs.Get()) {
+                return true;
+            }
+            const KeyKind kind = KindOf(lhs);
+            if (kind != KindOf(rhs)) {
+                return false;
+            }
+            if (kind == KeyKind::kInstance && !lhs.TryAs<ClassInstance>()->HasMethod("__eq__"s, 1)) {
+                return false;
+            }
+            return Equal(lhs, rhs, context);
+        }
+
+    }  // namespace
+
+    uint64_t Dict::Hash(const ObjectHolder& key, Context& context) {
+        uint64_t hash = 0;
+        switch (KindOf(key)) {
+            case KeyKind::kNone:
+                break;
+            case KeyKind::kBool:
+                hash = key.TryAs<Bool>()->GetValue() ? 1 : 0;
+                break;
+            case KeyKind::kInteger:
+                if (const auto *number = key.TryAs<Number>()) {
+                    hash = static_cast<uint64_t>(number->GetValue());
+                }
+                else {
+                    hash = std::hash<std::string>{}(key.TryAs<BigNumber>()->GetValue().ToString());
+                }
+                break;
+            case KeyKind::kString:
+                hash = key.TryAs<String>()->Hash();
+                break;
+            case KeyKind::kInstance: {
+                auto *instance = key.TryAs<ClassInstance>();
+                if (instance->HasMethod("__hash__"s, 0)) {
+                    ObjectHolder result = instance->Call("__hash__"s, {}, context);
+                    const auto *number = result.TryAs<Number>();
+                    if (!number) {
+                        throw runtime_error("__hash__ must return an integer");
+                    }
+                    hash = static_cast<uint64_t>(number->GetValue());
+                }
+                else if (instance->HasMethod("__eq__"s, 1)) {
+                    throw runtime_error("unhashable type: object defines __eq__ without __hash__");
+                }
+                else {
+                    hash = reinterpret_cast<uintptr_t>(instance);
+                }
+                break;
+            }
+        }
+        return Mix(hash);
+    }
+
+    size_t Dict::Size() const {
+        return entries_.size();
+    }
+
+    const std::vector<Dict::Entry>& Dict::GetEntries() const {
+        return entries_;
+    }
+
+    size_t Dict::Lookup(const ObjectHolder& key, uint64_t hash, Context& context) const {
+        if (control_.empty()) {
+            return NOT_FOUND;
+        }
+        const size_t group_mask = control_.size() / GROUP_SIZE - 1;
+        const int8_t control = ControlByte(hash);
+        // Треугольные числа обходят все группы таблицы, число групп которой - степень двойки
+        for (size_t probe = 0, group = (hash >> 7) & group_mask;; ++probe, group = (group + probe) & group_mask) {
+            const int8_t *group_control = &control_[group * GROUP_SIZE];
+            for (uint32_t mask = MatchGroup(group_control, control); mask != 0; mask &= mask - 1) {
+                const size_t slot = group * GROUP_SIZE + static_cast<size_t>(__builtin_ctz(mask));
+                const Entry &entry = entries_[slots_[slot]];
+                if (entry.hash == hash && KeysEqual(entry.key, key, context)) {
+                    return slots_[slot];
+                }
+            }
+            if (MatchGroup(group_control, EMPTY) != 0) {
+                return NOT_FOUND;
+            }
+        }
+    }
+
+    void Dict::PlaceEntry(uint32_t entry_index, uint64_t hash) {
+        const size_t group_mask = control_.size() / GROUP_SIZE - 1;
+        for (size_t probe = 0, group = (hash >> 7) & group_mask;; ++probe, group = (group + probe) & group_mask) {
+            const uint32_t empty = MatchGroup(&control_[group * GROUP_SIZE], EMPTY);
+            if (empty != 0) {
+                const size_t slot = group * GROUP_SIZE + static_cast<size_t>(__builtin_ctz(empty));
+                control_[slot] = ControlByte(hash);
+                slots_[slot] = entry_index;
+                return;
+            }
+        }
+    }
+
+    void Dict::Rehash(size_t capacity) {
+        control_.assign(capacity, EMPTY);
+        slots_.assign(capacity, 0);
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            PlaceEntry(static_cast<uint32_t>(i), entries_[i].hash);
+        }
+    }
+
+    const ObjectHolder* Dict::Find(const ObjectHolder& key, Context& context) const {
+        const size_t index = Lookup(key, Hash(key, context), context);
+        return index == NOT_FOUND ? nullptr : &entries_[index].value;
+    }
+
+    void Dict::Set(ObjectHolder key, ObjectHolder value, Context& context) {
+        const uint64_t hash = Hash(key, context);
+        if (const size_t index = Lookup(key, hash, context); index != NOT_FOUND) {
+            entries_[index].value = std::move(value);
+            return;
+        }
+        // Таблица заполняется не более чем на 7/8, чтобы на пути поиска всегда встречалась пустая ячейка
+        if ((entries_.size() + 1) * 8 > control_.size() * 7) {
+            Rehash(control_.empty() ? GROUP_SIZE : control_.size() * 2);
+        }
+        entries_.push_back({std::move(key), std::move(value), hash});
+        PlaceEntry(static_cast<uint32_t>(entries_.size() - 1), hash);
+    }
+
+    ObjectHolder Dict::Call(const std::string& method, ObjectHolder* args, size_t argument_count,
+                            Context& context) {
+        if (method == "get"sv && (argument_count == 1 || argument_count == 2)) {
+            if (const ObjectHolder *value = Find(args[0], context)) {
+                return *value;
+            }
+            return argument_count == 2 ? std::move(args[1]) : ObjectHolder::None();
+        }
+        if ((method == "keys"sv || method == "values"sv) && argument_count == 0) {
+            const bool keys = method == "keys"sv;
+            std::vector<ObjectHolder> items;
+            items.reserve(entries_.size());
+            for (const Entry &entry : entries_) {
+                items.push_back(keys ? entry.key : entry.value);
+            }
+            return ObjectHolder::Own(List{std::move(items)});
+        }
+        throw runtime_error("dict hasn't got method "s + method);
+    }
+
+    void Dict::Print(std::ostream& os, Context& context) {
+        auto print = [&os, &context](const ObjectHolder& object) {
+            if (object) {
+                object->Print(os, context);
+            }
+            else {
+                os << "None"sv;
+            }
+        };
+        os << '{';
+        bool first = true;
+        for (const Entry &entry : entries_) {
+            if (!first) {
+                os << ", "sv;
+            }
+            first = false;
+            print(entry.key);
+            os << ": "sv;
+            print(entry.value);
+        }
+        os << '}';
+    }
+
+}  // namespace runtime
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace runtime {
+
+/*
+Словарь - отображение ключей в значения с сохранением порядка вставки.
+
+Пары ключ-значение хранятся подряд в порядке вставки, а поиск идёт по хеш-таблице
+с открытой адресацией в духе Swiss table: для каждой ячейки хранится управляющий байт
+(EMPTY либо младшие 7 бит хеша ключа), ячейки сгруппированы по GROUP_SIZE. Поиск сравнивает
+7 бит хеша сразу со всей группой (инструкциями SSE2, если они доступны) и обращается
+к самим ключам только для совпавших ячеек.
+
+Ключами могут быть None, Bool, числа, строки и объекты классов. Объект класса хешируется
+результатом своего метода __hash__(), а без него - по адресу. Ключи сравниваются функцией Equal,
+причём ключи разных типов считаются различными. Списки и словари ключами быть не могут
+*/
+    class Dict : public Object {
+    public:
+        struct Entry {
+            ObjectHolder key;
+            ObjectHolder value;
+            uint64_t hash;
+        };
+
+        // Выводит пары в порядке вставки, например "{a: 1, 2: [3]}"
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает указатель на значение, связанное с key, либо nullptr, если ключа нет.
+        // Для недопустимого ключа выбрасывает исключение runtime_error
+        [[nodiscard]] const ObjectHolder* Find(const ObjectHolder& key, Context& context) const;
+
+        // Связывает key со значением value. Новый ключ добавляется в конец порядка обхода,
+        // у существующего ключа заменяется только значение
+        void Set(ObjectHolder key, ObjectHolder value, Context& context);
+
+        // Вызывает встроенный метод словаря method: get(key), get(key, default), keys() или values().
+        // Для неизвестного метода выбрасывает исключение runtime_error
+        ObjectHolder Call(const std::string& method, ObjectHolder* args, size_t argument_count,
+                          Context& context);
+
+        // Пары ключ-значение в порядке вставки
+        [[nodiscard]] const std::vector<Entry>& GetEntries() const;
+
+        // Возвращает хеш ключа key. Для недопустимого ключа выбрасывает исключение runtime_error
+        static uint64_t Hash(const ObjectHolder& key, Context& context);
+
+    private:
+        static constexpr size_t GROUP_SIZE = 16;
+        static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+        // Возвращает индекс пары с ключом key в entries_ либо NOT_FOUND
+        [[nodiscard]] size_t Lookup(const ObjectHolder& key, uint64_t hash, Context& context) const;
+        // Записывает индекс пары entry_index в первую свободную ячейку на пути поиска hash
+        void PlaceEntry(uint32_t entry_index, uint64_t hash);
+        void Rehash(size_t capacity);
+
+        std::vector<Entry> entries_;
+        // Управляющие байты ячеек; размер таблицы - степень двойки, кратная GROUP_SIZE
+        std::vector<int8_t> control_;
+        // Индексы пар в entries_ для занятых ячеек
+        std::vector<uint32_t> slots_;
+    };
+
+}  // namespace runtime
@@ -0,0 +1,95 @@
+#include "dict.h"
+#include "test_runner_p.h"
+
+#include <string>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        ObjectHolder Num(int64_t value) {
+            return ObjectHolder::Own(Number{value});
+        }
+
+        void TestDictGrowsAndKeepsOrder() {
+            DummyContext context;
+            Dict dict;
+            ASSERT_EQUAL(dict.Find(Num(1), context), nullptr);
+
+            constexpr int64_t COUNT = 10'000;
+            for (int64_t i = 0; i < COUNT; ++i) {
+                dict.Set(Num(i * 7919 % COUNT), Num(i), context);
+            }
+            ASSERT_EQUAL(dict.Size(), static_cast<size_t>(COUNT));
+            for (int64_t i = 0; i < COUNT; ++i) {
+                const ObjectHolder *value = dict.Find(Num(i * 7919 % COUNT), context);
+                ASSERT(value != nullptr);
+                ASSERT_EQUAL(value->TryAs<Number>()->GetValue(), i);
+            }
+            ASSERT_EQUAL(dict.Find(Num(COUNT), context), nullptr);
+
+            // Замена значения не меняет положение ключа в порядке обхода
+            dict.Set(Num(0), ObjectHolder::Own(String{"zero"s}), context);
+            ASSERT_EQUAL(dict.Size(), static_cast<size_t>(COUNT));
+            const auto &entries = dict.GetEntries();
+            ASSERT_EQUAL(entries.front().key.TryAs<Number>()->GetValue(), 0);
+            ASSERT_EQUAL(entries.front().value.TryAs<String>()->GetValue(), "zero"s);
+            ASSERT_EQUAL(entries[1].key.TryAs<Number>()->GetValue(), 7919);
+        }
+
+        void TestDictKeyKinds() {
+            DummyContext context;
+            Dict dict;
+            dict.Set(ObjectHolder::Own(String{"key"s}), Num(1), context);
+            dict.Set(ObjectHolder::Own(Bool{true}), Num(2), context);
+            dict.Set(Num(1), Num(3), context);
+            dict.Set(ObjectHolder::None(), Num(4), context);
+            dict.Set(ObjectHolder::Own(BigNumber{BigInt::FromString("100000000000000000000"s)}), Num(5), context);
+            ASSERT_EQUAL(dict.Size(), 5U);
+
+            // Строки сравниваются по значению, а не по хранилищу
+            const string key = "ke"s;
+            ASSERT_EQUAL(dict.Find(ObjectHolder::Own(String{key + "y"s}), context)->TryAs<Number>()->GetValue(), 1);
+            ASSERT_EQUAL(dict.Find(ObjectHolder::Own(Bool{true}), context)->TryAs<Number>()->GetValue(), 2);
+            ASSERT_EQUAL(dict.Find(Num(1), context)->TryAs<Number>()->GetValue(), 3);
+            ASSERT_EQUAL(dict.Find(ObjectHolder::None(), context)->TryAs<Number>()->GetValue(), 4);
+            ASSERT_EQUAL(dict.Find(ObjectHolder::Own(BigNumber{BigInt::FromString("100000000000000000000"s)}),
+                                   context)->TryAs<Number>()->GetValue(), 5);
+            ASSERT_EQUAL(dict.Find(ObjectHolder::Own(Bool{false}), context), nullptr);
+
+            ASSERT_THROWS(dict.Set(ObjectHolder::Own(List{}), Num(0), context), std::runtime_error);
+            ASSERT_THROWS((void)dict.Find(ObjectHolder::Own(Dict{}), context), std::runtime_error);
+        }
+
+        void TestDictMethods() {
+            DummyContext context;
+            Dict dict;
+            dict.Set(ObjectHolder::Own(String{"b"s}), Num(2), context);
+            dict.Set(ObjectHolder::Own(String{"a"s}), Num(1), context);
+
+            ObjectHolder args[] = {ObjectHolder::Own(String{"a"s}), Num(0)};
+            ASSERT_EQUAL(dict.Call("get"s, args, 1, context).TryAs<Number>()->GetValue(), 1);
+            ObjectHolder missing[] = {ObjectHolder::Own(String{"c"s}), Num(0)};
+            ASSERT(!dict.Call("get"s, missing, 1, context));
+            ASSERT_EQUAL(dict.Call("get"s, missing, 2, context).TryAs<Number>()->GetValue(), 0);
+
+            dict.Call("keys"s, nullptr, 0, context)->Print(context.output, context);
+            context.output << ' ';
+            dict.Call("values"s, nullptr, 0, context)->Print(context.output, context);
+            context.output << ' ';
+            dict.Print(context.output, context);
+            ASSERT_EQUAL(context.output.str(), "[b, a] [2, 1] {b: 2, a: 1}"s);
+            ASSERT_THROWS(dict.Call("pop"s, nullptr, 0, context), std::runtime_error);
+        }
+
+    }  // namespace
+
+    void RunDictTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestDictGrowsAndKeepsOrder);
+        RUN_TEST(tr, runtime::TestDictKeyKinds);
+        RUN_TEST(tr, runtime::TestDictMethods);
+    }
+
+}  // namespace runtime
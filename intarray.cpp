@@ -0,0 +1,635 @@
+#include "intarray.h"
+
+#include <atomic>
+#include <limits>
+#include <ostream>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MYTHON_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        using Comparison = IntArray::Comparison;
+
+        constexpr int64_t INT32_LOW = numeric_limits<int32_t>::min();
+        constexpr int64_t INT32_HIGH = numeric_limits<int32_t>::max();
+
+        // Ядра операций над массивами. Функции, возвращающие bool, возвращают false при переполнении
+        struct Kernels {
+            SimdLevel level;
+            bool (*sum)(const int64_t* data, size_t size, int64_t& result);
+            void (*min_max)(const int64_t* data, size_t size, int64_t& min, int64_t& max);
+            // Возвращает true, если все элементы помещаются в int32_t
+            bool (*fits_int32)(const int64_t* data, size_t size);
+            // Скалярное произведение. Векторные реализации требуют, чтобы элементы помещались в int32_t
+            bool (*dot32)(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t& result);
+            bool (*add)(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size);
+            // Поэлементное произведение. Векторные реализации требуют, чтобы элементы помещались в int32_t
+            bool (*mul32)(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size);
+            void (*compare)(const int64_t* data, size_t size, Comparison comparison, int64_t value, int64_t* out);
+        };
+
+        // Скалярные реализации. Они же обрабатывают хвосты массивов, не кратные ширине вектора
+
+        bool SumScalar(const int64_t* data, size_t size, int64_t& result) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < size; ++i) {
+                if (__builtin_add_overflow(sum, data[i], &sum)) {
+                    return false;
+                }
+            }
+            result = sum;
+            return true;
+        }
+
+        void MinMaxScalar(const int64_t* data, size_t size, int64_t& min, int64_t& max) {
+            for (size_t i = 0; i < size; ++i) {
+                min = data[i] < min ? data[i] : min;
+                max = data[i] > max ? data[i] : max;
+            }
+        }
+
+        bool FitsInt32Scalar(const int64_t* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                if (data[i] < INT32_LOW || data[i] > INT32_HIGH) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool DotScalar(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t& result) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < size; ++i) {
+                int64_t product = 0;
+                if (__builtin_mul_overflow(lhs[i], rhs[i], &product) || __builtin_add_overflow(sum, product, &sum)) {
+                    return false;
+                }
+            }
+            result = sum;
+            return true;
+        }
+
+        bool AddScalar(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+            bool overflow = false;
+            for (size_t i = 0; i < size; ++i) {
+                overflow |= __builtin_add_overflow(lhs[i], rhs[i], &out[i]);
+            }
+            return !overflow;
+        }
+
+        bool MulScalar(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+            bool overflow = false;
+            for (size_t i = 0; i < size; ++i) {
+                overflow |= __builtin_mul_overflow(lhs[i], rhs[i], &out[i]);
+            }
+            return !overflow;
+        }
+
+        void CompareScalar(const int64_t* data, size_t size, Comparison comparison, int64_t value, int64_t* out) {
+            for (size_t i = 0; i < size; ++i) {
+                switch (comparison) {
+                    case Comparison::kLess:
+                        out[i] = data[i] < value;
+                        break;
+                    case Comparison::kGreater:
+                        out[i] = data[i] > value;
+                        break;
+                    case Comparison::kEqual:
+                        out[i] = data[i] == value;
+                        break;
+                }
+            }
+        }
+
+        // Складывает частичные суммы векторных регистров и хвост массива с проверкой переполнения
+        bool FinishSum(const int64_t* lanes, size_t lane_count, const int64_t* tail, size_t tail_size,
+                       int64_t& result) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < lane_count; ++i) {
+                if (__builtin_add_overflow(sum, lanes[i], &sum)) {
+                    return false;
+                }
+            }
+            int64_t tail_sum = 0;
+            if (!SumScalar(tail, tail_size, tail_sum) || __builtin_add_overflow(sum, tail_sum, &sum)) {
+                return false;
+            }
+            result = sum;
+            return true;
+        }
+
+        constexpr Kernels SCALAR_KERNELS = {
+                SimdLevel::kScalar, SumScalar, MinMaxScalar, FitsInt32Scalar, DotScalar, AddScalar, MulScalar,
+                CompareScalar,
+        };
+
+#ifdef MYTHON_X86_SIMD
+        // Переполнение при сложении a + b = sum произошло в тех разрядах, где знак sum отличается
+        // от знаков обоих слагаемых: старший бит (a ^ sum) & (b ^ sum)
+
+        __attribute__((target("avx2")))
+        bool SumAvx2(const int64_t* data, size_t size, int64_t& result) {
+            __m256i sum = _mm256_setzero_si256();
+            __m256i overflow = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                const __m256i next = _mm256_add_epi64(sum, value);
+                overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(sum, next),
+                                                                      _mm256_xor_si256(value, next)));
+                sum = next;
+            }
+            if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0) {
+                return false;
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+            return FinishSum(lanes, 4, data + i, size - i, result);
+        }
+
+        __attribute__((target("avx2")))
+        void MinMaxAvx2(const int64_t* data, size_t size, int64_t& min, int64_t& max) {
+            __m256i min_lanes = _mm256_set1_epi64x(min);
+            __m256i max_lanes = _mm256_set1_epi64x(max);
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                min_lanes = _mm256_blendv_epi8(min_lanes, value, _mm256_cmpgt_epi64(min_lanes, value));
+                max_lanes = _mm256_blendv_epi8(max_lanes, value, _mm256_cmpgt_epi64(value, max_lanes));
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), min_lanes);
+            MinMaxScalar(lanes, 4, min, max);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), max_lanes);
+            MinMaxScalar(lanes, 4, min, max);
+            MinMaxScalar(data + i, size - i, min, max);
+        }
+
+        __attribute__((target("avx2")))
+        bool FitsInt32Avx2(const int64_t* data, size_t size) {
+            const __m256i low = _mm256_set1_epi64x(INT32_LOW);
+            const __m256i high = _mm256_set1_epi64x(INT32_HIGH);
+            __m256i outside = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                outside = _mm256_or_si256(outside, _mm256_or_si256(_mm256_cmpgt_epi64(low, value),
+                                                                   _mm256_cmpgt_epi64(value, high)));
+            }
+            return _mm256_testz_si256(outside, outside) && FitsInt32Scalar(data + i, size - i);
+        }
+
+        __attribute__((target("avx2")))
+        bool Dot32Avx2(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t& result) {
+            __m256i sum = _mm256_setzero_si256();
+            __m256i overflow = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                // Умножаются младшие 32 бита со знаком; для чисел из диапазона int32_t это точное произведение
+                const __m256i product = _mm256_mul_epi32(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+                const __m256i next = _mm256_add_epi64(sum, product);
+                overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(sum, next),
+                                                                      _mm256_xor_si256(product, next)));
+                sum = next;
+            }
+            if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0) {
+                return false;
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+            int64_t tail = 0;
+            return DotScalar(lhs + i, rhs + i, size - i, tail) && FinishSum(lanes, 4, &tail, 1, result);
+        }
+
+        __attribute__((target("avx2")))
+        bool AddAvx2(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+            __m256i overflow = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+                const __m256i sum = _mm256_add_epi64(a, b);
+                overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(a, sum),
+                                                                      _mm256_xor_si256(b, sum)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+            }
+            return _mm256_movemask_pd(_mm256_castsi256_pd(overflow)) == 0
+                   && AddScalar(lhs + i, rhs + i, out + i, size - i);
+        }
+
+        __attribute__((target("avx2")))
+        bool Mul32Avx2(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mul_epi32(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i))));
+            }
+            return MulScalar(lhs + i, rhs + i, out + i, size - i);
+        }
+
+        __attribute__((target("avx2")))
+        void CompareAvx2(const int64_t* data, size_t size, Comparison comparison, int64_t value, int64_t* out) {
+            const __m256i broadcast = _mm256_set1_epi64x(value);
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                const __m256i element = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                __m256i mask;
+                switch (comparison) {
+                    case Comparison::kLess:
+                        mask = _mm256_cmpgt_epi64(broadcast, element);
+                        break;
+                    case Comparison::kGreater:
+                        mask = _mm256_cmpgt_epi64(element, broadcast);
+                        break;
+                    default:
+                        mask = _mm256_cmpeq_epi64(element, broadcast);
+                        break;
+                }
+                // Маска из единиц во всех разрядах превращается в 1
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_srli_epi64(mask, 63));
+            }
+            CompareScalar(data + i, size - i, comparison, value, out + i);
+        }
+
+        __attribute__((target("sse4.2")))
+        bool SumSse42(const int64_t* data, size_t size, int64_t& result) {
+            __m128i sum = _mm_setzero_si128();
+            __m128i overflow = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                const __m128i next = _mm_add_epi64(sum, value);
+                overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(sum, next), _mm_xor_si128(value, next)));
+                sum = next;
+            }
+            if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) {
+                return false;
+            }
+            alignas(16) int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+            return FinishSum(lanes, 2, data + i, size - i, result);
+        }
+
+        __attribute__((target("sse4.2")))
+        void MinMaxSse42(const int64_t* data, size_t size, int64_t& min, int64_t& max) {
+            __m128i min_lanes = _mm_set1_epi64x(min);
+            __m128i max_lanes = _mm_set1_epi64x(max);
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                min_lanes = _mm_blendv_epi8(min_lanes, value, _mm_cmpgt_epi64(min_lanes, value));
+                max_lanes = _mm_blendv_epi8(max_lanes, value, _mm_cmpgt_epi64(value, max_lanes));
+            }
+            alignas(16) int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), min_lanes);
+            MinMaxScalar(lanes, 2, min, max);
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), max_lanes);
+            MinMaxScalar(lanes, 2, min, max);
+            MinMaxScalar(data + i, size - i, min, max);
+        }
+
+        __attribute__((target("sse4.2")))
+        bool FitsInt32Sse42(const int64_t* data, size_t size) {
+            const __m128i low = _mm_set1_epi64x(INT32_LOW);
+            const __m128i high = _mm_set1_epi64x(INT32_HIGH);
+            __m128i outside = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                outside = _mm_or_si128(outside, _mm_or_si128(_mm_cmpgt_epi64(low, value), _mm_cmpgt_epi64(value, high)));
+            }
+            return _mm_testz_si128(outside, outside) && FitsInt32Scalar(data + i, size - i);
+        }
+
+        __attribute__((target("sse4.2")))
+        bool Dot32Sse42(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t& result) {
+            __m128i sum = _mm_setzero_si128();
+            __m128i overflow = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                const __m128i product = _mm_mul_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)),
+                                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+                const __m128i next = _mm_add_epi64(sum, product);
+                overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(sum, next),
+                                                                _mm_xor_si128(product, next)));
+                sum = next;
+            }
+            if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) {
+                return false;
+            }
+            alignas(16) int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+            int64_t tail = 0;
+            return DotScalar(lhs + i, rhs + i, size - i, tail) && FinishSum(lanes, 2, &tail, 1, result);
+        }
+
+        __attribute__((target("sse4.2")))
+        bool AddSse42(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+            __m128i overflow = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+                const __m128i sum = _mm_add_epi64(a, b);
+                overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(a, sum), _mm_xor_si128(b, sum)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sum);
+            }
+            return _mm_movemask_pd(_mm_castsi128_pd(overflow)) == 0 && AddScalar(lhs + i, rhs + i, out + i, size - i);
+        }
+
+        __attribute__((target("sse4.2")))
+        bool Mul32Sse42(const int64_t* lhs, const int64_t* rhs, int64_t* out, size_t size) {
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                                 _mm_mul_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)),
+                                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i))));
+            }
+            return MulScalar(lhs + i, rhs + i, out + i, size - i);
+        }
+
+        __attribute__((target("sse4.2")))
+        void CompareSse42(const int64_t* data, size_t size, Comparison comparison, int64_t value, int64_t* out) {
+            const __m128i broadcast = _mm_set1_epi64x(value);
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                const __m128i element = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                __m128i mask;
+                switch (comparison) {
+                    case Comparison::kLess:
+                        mask = _mm_cmpgt_epi64(broadcast, element);
+                        break;
+                    case Comparison::kGreater:
+                        mask = _mm_cmpgt_epi64(element, broadcast);
+                        break;
+                    default:
+                        mask = _mm_cmpeq_epi64(element, broadcast);
+                        break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_srli_epi64(mask, 63));
+            }
+            CompareScalar(data + i, size - i, comparison, value, out + i);
+        }
+
+        constexpr Kernels AVX2_KERNELS = {
+                SimdLevel::kAvx2, SumAvx2, MinMaxAvx2, FitsInt32Avx2, Dot32Avx2, AddAvx2, Mul32Avx2, CompareAvx2,
+        };
+
+        constexpr Kernels SSE42_KERNELS = {
+                SimdLevel::kSse42, SumSse42, MinMaxSse42, FitsInt32Sse42, Dot32Sse42, AddSse42, Mul32Sse42,
+                CompareSse42,
+        };
+#endif
+
+        SimdLevel DetectSimdLevel() {
+#ifdef MYTHON_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return SimdLevel::kAvx2;
+            }
+            if (__builtin_cpu_supports("sse4.2")) {
+                return SimdLevel::kSse42;
+            }
+#endif
+            return SimdLevel::kScalar;
+        }
+
+        const Kernels* KernelsFor(SimdLevel level) {
+#ifdef MYTHON_X86_SIMD
+            switch (level) {
+                case SimdLevel::kAvx2:
+                    return &AVX2_KERNELS;
+                case SimdLevel::kSse42:
+                    return &SSE42_KERNELS;
+                case SimdLevel::kScalar:
+                    break;
+            }
+#else
+            (void)level;
+#endif
+            return &SCALAR_KERNELS;
+        }
+
+        std::atomic<const Kernels*>& ActiveKernels() {
+            static std::atomic<const Kernels*> kernels{KernelsFor(DetectSimdLevel())};
+            return kernels;
+        }
+
+        const Kernels& Active() {
+            return *ActiveKernels().load(std::memory_order_relaxed);
+        }
+
+        int64_t ToInt64(const ObjectHolder& object, const std::string& method) {
+            const auto *number = object.TryAs<Number>();
+            if (!number) {
+                throw runtime_error("intarray."s + method + " expects an integer"s);
+            }
+            return number->GetValue();
+        }
+
+        const IntArray& ToIntArray(const ObjectHolder& object, const std::string& method) {
+            const auto *array = object.TryAs<IntArray>();
+            if (!array) {
+                throw runtime_error("intarray."s + method + " expects an intarray"s);
+            }
+            return *array;
+        }
+
+    }  // namespace
+
+    IntArray::IntArray(std::vector<int64_t> values)
+            : values_(std::move(values)) {
+    }
+
+    void IntArray::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << "intarray(["sv;
+        for (size_t i = 0; i < values_.size(); ++i) {
+            if (i > 0) {
+                os << ", "sv;
+            }
+            os << values_[i];
+        }
+        os << "])"sv;
+    }
+
+    size_t IntArray::Size() const {
+        return values_.size();
+    }
+
+    const std::vector<int64_t>& IntArray::GetValues() const {
+        return values_;
+    }
+
+    size_t IntArray::Position(int64_t index) const {
+        const auto size = static_cast<int64_t>(values_.size());
+        const int64_t position = index < 0 ? index + size : index;
+        if (position < 0 || position >= size) {
+            throw runtime_error("intarray index out of range");
+        }
+        return static_cast<size_t>(position);
+    }
+
+    int64_t IntArray::At(int64_t index) const {
+        return values_[Position(index)];
+    }
+
+    void IntArray::Set(int64_t index, int64_t value) {
+        values_[Position(index)] = value;
+    }
+
+    void IntArray::Append(int64_t value) {
+        values_.push_back(value);
+    }
+
+    void IntArray::CheckSameSize(const IntArray& other) const {
+        if (values_.size() != other.values_.size()) {
+            throw runtime_error("intarray sizes differ");
+        }
+    }
+
+    ObjectHolder IntArray::Sum() const {
+        int64_t result = 0;
+        if (Active().sum(values_.data(), values_.size(), result)) {
+            return ObjectHolder::Own(Number{result});
+        }
+        BigInt sum;
+        for (int64_t value : values_) {
+            sum = sum + BigInt{value};
+        }
+        return MakeInteger(std::move(sum));
+    }
+
+    int64_t IntArray::Min() const {
+        if (values_.empty()) {
+            throw runtime_error("min of an empty intarray");
+        }
+        int64_t min = values_.front();
+        int64_t max = values_.front();
+        Active().min_max(values_.data(), values_.size(), min, max);
+        return min;
+    }
+
+    int64_t IntArray::Max() const {
+        if (values_.empty()) {
+            throw runtime_error("max of an empty intarray");
+        }
+        int64_t min = values_.front();
+        int64_t max = values_.front();
+        Active().min_max(values_.data(), values_.size(), min, max);
+        return max;
+    }
+
+    ObjectHolder IntArray::Dot(const IntArray& other) const {
+        CheckSameSize(other);
+        const Kernels &kernels = Active();
+        const int64_t *lhs = values_.data();
+        const int64_t *rhs = other.values_.data();
+        const size_t size = values_.size();
+
+        int64_t result = 0;
+        const bool narrow = kernels.fits_int32(lhs, size) && kernels.fits_int32(rhs, size);
+        if (narrow ? kernels.dot32(lhs, rhs, size, result) : DotScalar(lhs, rhs, size, result)) {
+            return ObjectHolder::Own(Number{result});
+        }
+        BigInt sum;
+        for (size_t i = 0; i < size; ++i) {
+            sum = sum + BigInt{lhs[i]} * BigInt{rhs[i]};
+        }
+        return MakeInteger(std::move(sum));
+    }
+
+    IntArray IntArray::Add(const IntArray& other) const {
+        CheckSameSize(other);
+        std::vector<int64_t> result(values_.size());
+        if (!Active().add(values_.data(), other.values_.data(), result.data(), result.size())) {
+            throw runtime_error("intarray addition overflow");
+        }
+        return IntArray{std::move(result)};
+    }
+
+    IntArray IntArray::Mul(const IntArray& other) const {
+        CheckSameSize(other);
+        const Kernels &kernels = Active();
+        const int64_t *lhs = values_.data();
+        const int64_t *rhs = other.values_.data();
+        std::vector<int64_t> result(values_.size());
+
+        const bool narrow = kernels.fits_int32(lhs, result.size()) && kernels.fits_int32(rhs, result.size());
+        if (!(narrow ? kernels.mul32 : MulScalar)(lhs, rhs, result.data(), result.size())) {
+            throw runtime_error("intarray multiplication overflow");
+        }
+        return IntArray{std::move(result)};
+    }
+
+    IntArray IntArray::CompareMask(Comparison comparison, int64_t value) const {
+        std::vector<int64_t> result(values_.size());
+        Active().compare(values_.data(), values_.size(), comparison, value, result.data());
+        return IntArray{std::move(result)};
+    }
+
+    ObjectHolder IntArray::Call(const std::string& method, ObjectHolder* args, size_t argument_count) {
+        if (argument_count == 0) {
+            if (method == "sum"sv) {
+                return Sum();
+            }
+            if (method == "min"sv) {
+                return ObjectHolder::Own(Number{Min()});
+            }
+            if (method == "max"sv) {
+                return ObjectHolder::Own(Number{Max()});
+            }
+        }
+        else if (argument_count == 1) {
+            if (method == "append"sv) {
+                Append(ToInt64(args[0], method));
+                return ObjectHolder::None();
+            }
+            if (method == "dot"sv) {
+                return Dot(ToIntArray(args[0], method));
+            }
+            if (method == "add"sv) {
+                return ObjectHolder::Own(Add(ToIntArray(args[0], method)));
+            }
+            if (method == "mul"sv) {
+                return ObjectHolder::Own(Mul(ToIntArray(args[0], method)));
+            }
+            if (method == "lt"sv) {
+                return ObjectHolder::Own(CompareMask(Comparison::kLess, ToInt64(args[0], method)));
+            }
+            if (method == "gt"sv) {
+                return ObjectHolder::Own(CompareMask(Comparison::kGreater, ToInt64(args[0], method)));
+            }
+            if (method == "eq"sv) {
+                return ObjectHolder::Own(CompareMask(Comparison::kEqual, ToInt64(args[0], method)));
+            }
+        }
+        throw runtime_error("intarray hasn't got method "s + method);
+    }
+
+    SimdLevel IntArray::GetSimdLevel() {
+        return Active().level;
+    }
+
+    SimdLevel IntArray::GetSupportedSimdLevel() {
+        static const SimdLevel level = DetectSimdLevel();
+        return level;
+    }
+
+    void IntArray::SetSimdLevel(SimdLevel level) {
+        if (static_cast<int>(level) > static_cast<int>(GetSupportedSimdLevel())) {
+            level = GetSupportedSimdLevel();
+        }
+        ActiveKernels().store(KernelsFor(level), std::memory_order_relaxed);
+    }
+
+}  // namespace runtime
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace runtime {
+
+// Набор инструкций, которым выполняются операции IntArray
+    enum class SimdLevel {
+        kScalar,
+        kSse42,
+        kAvx2,
+    };
+
+/*
+Массив целых чисел int64_t, хранящихся подряд без упаковки в объекты Number.
+Объект Number создаётся только при чтении отдельного элемента.
+
+Свёртки (сумма, минимум, максимум, скалярное произведение), поэлементные сложение
+и умножение и сравнение с числом выполняются векторными инструкциями SSE4.2 или AVX2.
+Набор инструкций выбирается при первом обращении по возможностям процессора;
+на других процессорах и платформах используется скалярная реализация.
+
+Сумма и скалярное произведение, не помещающиеся в int64_t, вычисляются точно и возвращаются
+как BigNumber. Поэлементные операции, результат которых не помещается в int64_t,
+выбрасывают исключение runtime_error
+*/
+    class IntArray : public Object {
+    public:
+        IntArray() = default;
+        explicit IntArray(std::vector<int64_t> values);
+
+        // Выводит массив в виде "intarray([1, 2, 3])"
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] size_t Size() const;
+        [[nodiscard]] const std::vector<int64_t>& GetValues() const;
+
+        // Индекс трактуется так же, как в List::At: отрицательный отсчитывается от конца.
+        // Если индекс выходит за границы массива, выбрасывается исключение runtime_error
+        [[nodiscard]] int64_t At(int64_t index) const;
+        void Set(int64_t index, int64_t value);
+        void Append(int64_t value);
+
+        // Возвращает Number либо BigNumber
+        [[nodiscard]] ObjectHolder Sum() const;
+        // Для пустого массива выбрасывают исключение runtime_error
+        [[nodiscard]] int64_t Min() const;
+        [[nodiscard]] int64_t Max() const;
+        // Скалярное произведение массивов одинаковой длины. Возвращает Number либо BigNumber
+        [[nodiscard]] ObjectHolder Dot(const IntArray& other) const;
+
+        // Поэлементные сумма и произведение массивов одинаковой длины
+        [[nodiscard]] IntArray Add(const IntArray& other) const;
+        [[nodiscard]] IntArray Mul(const IntArray& other) const;
+
+        enum class Comparison {
+            kLess,
+            kGreater,
+            kEqual,
+        };
+        // Маска сравнения каждого элемента с value: 1, если сравнение истинно, иначе 0
+        [[nodiscard]] IntArray CompareMask(Comparison comparison, int64_t value) const;
+
+        // Вызывает встроенный метод массива method: append, sum, min, max, dot, add, mul, lt, gt или eq.
+        // Для неизвестного метода или неверных аргументов выбрасывает исключение runtime_error
+        ObjectHolder Call(const std::string& method, ObjectHolder* args, size_t argument_count);
+
+        // Возвращает набор инструкций, которым сейчас выполняются операции
+        static SimdLevel GetSimdLevel();
+        // Возвращает наиболее широкий набор инструкций, поддерживаемый процессором
+        static SimdLevel GetSupportedSimdLevel();
+        // Выбирает набор инструкций (например, для сравнения реализаций).
+        // Уровень выше поддерживаемого процессором понижается до поддерживаемого
+        static void SetSimdLevel(SimdLevel level);
+
+    private:
+        [[nodiscard]] size_t Position(int64_t index) const;
+        void CheckSameSize(const IntArray& other) const;
+
+        std::vector<int64_t> values_;
+    };
+
+}  // namespace runtime
@@ -0,0 +1,147 @@
+#include "intarray.h"
+#include "test_runner_p.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        // Уровни, которые можно проверить на текущем процессоре
+        vector<SimdLevel> SupportedLevels() {
+            vector<SimdLevel> levels;
+            for (SimdLevel level : {SimdLevel::kScalar, SimdLevel::kSse42, SimdLevel::kAvx2}) {
+                if (static_cast<int>(level) <= static_cast<int>(IntArray::GetSupportedSimdLevel())) {
+                    levels.push_back(level);
+                }
+            }
+            return levels;
+        }
+
+        // Восстанавливает выбранный набор инструкций по окончании теста
+        class SimdLevelGuard {
+        public:
+            SimdLevelGuard()
+                    : level_(IntArray::GetSimdLevel()) {
+            }
+
+            ~SimdLevelGuard() {
+                IntArray::SetSimdLevel(level_);
+            }
+
+        private:
+            SimdLevel level_;
+        };
+
+        string ToString(const ObjectHolder& object) {
+            DummyContext context;
+            object->Print(context.output, context);
+            return context.output.str();
+        }
+
+        void TestIntArrayElements() {
+            DummyContext context;
+            IntArray array{{1, 2, 3}};
+            array.Append(4);
+            array.Set(-1, 5);
+            ASSERT_EQUAL(array.Size(), 4U);
+            ASSERT_EQUAL(array.At(0), 1);
+            ASSERT_EQUAL(array.At(-1), 5);
+            ASSERT_THROWS((void)array.At(4), runtime_error);
+            ASSERT_THROWS((void)array.At(-5), runtime_error);
+            array.Print(context.output, context);
+            ASSERT_EQUAL(context.output.str(), "intarray([1, 2, 3, 5])"s);
+
+            ASSERT_THROWS((void)IntArray{}.Min(), runtime_error);
+            ASSERT_THROWS((void)array.Add(IntArray{{1}}), runtime_error);
+            ObjectHolder arg = ObjectHolder::Own(String{"x"s});
+            ASSERT_THROWS(array.Call("append"s, &arg, 1), runtime_error);
+            ASSERT_THROWS(array.Call("pop"s, nullptr, 0), runtime_error);
+        }
+
+        void TestIntArrayKernelsAgree() {
+            SimdLevelGuard guard;
+            mt19937_64 random(42);
+            // Длины, не кратные ширине вектора, проверяют обработку хвостов
+            for (size_t size : {0U, 1U, 3U, 4U, 7U, 17U, 1000U}) {
+                uniform_int_distribution<int64_t> narrow(-1'000'000, 1'000'000);
+                uniform_int_distribution<int64_t> wide(-(int64_t{1} << 40), int64_t{1} << 40);
+                vector<int64_t> lhs(size);
+                vector<int64_t> rhs(size);
+                for (size_t i = 0; i < size; ++i) {
+                    lhs[i] = narrow(random);
+                    rhs[i] = i % 2 == 0 ? narrow(random) : wide(random);
+                }
+                const IntArray a{lhs};
+                const IntArray b{rhs};
+
+                IntArray::SetSimdLevel(SimdLevel::kScalar);
+                const string sum = ToString(a.Sum());
+                const string dot = ToString(a.Dot(b));
+                const string dot_narrow = ToString(a.Dot(a));
+                const vector<int64_t> added = a.Add(b).GetValues();
+                const vector<int64_t> multiplied = a.Mul(b).GetValues();
+                const vector<int64_t> squared = a.Mul(a).GetValues();
+                const vector<int64_t> less = b.CompareMask(IntArray::Comparison::kLess, 0).GetValues();
+                const vector<int64_t> equal = a.CompareMask(IntArray::Comparison::kEqual, lhs.empty() ? 0 : lhs[0])
+                        .GetValues();
+
+                for (SimdLevel level : SupportedLevels()) {
+                    IntArray::SetSimdLevel(level);
+                    ASSERT(IntArray::GetSimdLevel() == level);
+                    ASSERT_EQUAL(ToString(a.Sum()), sum);
+                    ASSERT_EQUAL(ToString(a.Dot(b)), dot);
+                    ASSERT_EQUAL(ToString(a.Dot(a)), dot_narrow);
+                    ASSERT(a.Add(b).GetValues() == added);
+                    ASSERT(a.Mul(b).GetValues() == multiplied);
+                    ASSERT(a.Mul(a).GetValues() == squared);
+                    ASSERT(b.CompareMask(IntArray::Comparison::kLess, 0).GetValues() == less);
+                    ASSERT(a.CompareMask(IntArray::Comparison::kEqual, lhs.empty() ? 0 : lhs[0]).GetValues()
+                           == equal);
+                    if (size > 0) {
+                        ASSERT_EQUAL(b.Min(), *min_element(rhs.begin(), rhs.end()));
+                        ASSERT_EQUAL(b.Max(), *max_element(rhs.begin(), rhs.end()));
+                    }
+                }
+            }
+        }
+
+        void TestIntArrayOverflow() {
+            SimdLevelGuard guard;
+            const int64_t max = numeric_limits<int64_t>::max();
+            const int64_t min = numeric_limits<int64_t>::min();
+            const IntArray big{vector<int64_t>(9, max)};
+            const IntArray small{vector<int64_t>(9, min)};
+            const IntArray twos{vector<int64_t>(9, 2)};
+            const IntArray extremes{{min, max, min, max, -1, 1, 0}};
+            for (SimdLevel level : SupportedLevels()) {
+                IntArray::SetSimdLevel(level);
+                ASSERT(big.Sum().TryAs<BigNumber>());
+                ASSERT_EQUAL(ToString(big.Sum()), "83010348331692982263"s);
+                ASSERT_EQUAL(ToString(small.Sum()), "-83010348331692982272"s);
+                ASSERT_EQUAL(ToString(big.Dot(twos)), "166020696663385964526"s);
+                ASSERT(extremes.Sum().TryAs<Number>());
+                ASSERT_EQUAL(ToString(extremes.Sum()), "-2"s);
+                ASSERT_EQUAL(extremes.Min(), min);
+                ASSERT_EQUAL(extremes.Max(), max);
+                ASSERT_THROWS((void)big.Add(twos), runtime_error);
+                ASSERT_THROWS((void)small.Mul(twos), runtime_error);
+                ASSERT(extremes.CompareMask(IntArray::Comparison::kGreater, -1).GetValues()
+                       == (vector<int64_t>{0, 1, 0, 1, 0, 1, 1}));
+            }
+        }
+
+    }  // namespace
+
+    void RunIntArrayTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestIntArrayElements);
+        RUN_TEST(tr, runtime::TestIntArrayKernelsAgree);
+        RUN_TEST(tr, runtime::TestIntArrayOverflow);
+    }
+
+}  // namespace runtime
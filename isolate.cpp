@@ -0,0 +1,413 @@
+#include "isolate.h"
+
+#include "dict.h"
+#include "intarray.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        const string RECEIVE_METHOD = "receive"s;
+        const string INIT_METHOD = "__init__"s;
+
+        class Copier {
+        public:
+            explicit Copier(Context& context)
+                    : context_(context) {
+            }
+
+            ObjectHolder Copy(const ObjectHolder& value) {
+                if (!value) {
+                    return ObjectHolder::None();
+                }
+                if (auto it = copies_.find(value.Get()); it != copies_.end()) {
+                    return it->second;
+                }
+                ObjectHolder result = CopyObject(value);
+                copies_.emplace(value.Get(), result);
+                return result;
+            }
+
+        private:
+            // Копирует объект, ещё не встречавшийся в копируемом значении.
+            // Контейнеры запоминают свою копию до копирования элементов, чтобы сохранить циклы
+            ObjectHolder CopyObject(const ObjectHolder& value) {
+                if (const auto *number = value.TryAs<Number>()) {
+                    return ObjectHolder::Own(Number{number->GetValue()});
+                }
+                if (const auto *big = value.TryAs<BigNumber>()) {
+                    return ObjectHolder::Own(BigNumber{big->GetValue()});
+                }
+                if (const auto *boolean = value.TryAs<Bool>()) {
+                    return ObjectHolder::Own(Bool{boolean->GetValue()});
+                }
+                if (const auto *str = value.TryAs<String>()) {
+                    // Новая строка не разделяет хранилище символов с исходной
+                    return ObjectHolder::Own(String{std::string(str->GetView())});
+                }
+                if (const auto *array = value.TryAs<IntArray>()) {
+                    return ObjectHolder::Own(IntArray{array->GetValues()});
+                }
+                if (const auto *handle = value.TryAs<IsolateHandle>()) {
+                    return ObjectHolder::Own(IsolateHandle{handle->GetIsolate().shared_from_this()});
+                }
+                if (const auto *list = value.TryAs<List>()) {
+                    ObjectHolder result = ObjectHolder::Own(List{});
+                    copies_.emplace(value.Get(), result);
+                    auto &copy = *result.TryAs<List>();
+                    for (const ObjectHolder &item : list->GetItems()) {
+                        copy.Append(Copy(item));
+                    }
+                    return result;
+                }
+                if (const auto *dict = value.TryAs<Dict>()) {
+                    ObjectHolder result = ObjectHolder::Own(Dict{});
+                    copies_.emplace(value.Get(), result);
+                    auto &copy = *result.TryAs<Dict>();
+                    for (const Dict::Entry &entry : dict->GetEntries()) {
+                        copy.Set(Copy(entry.key), Copy(entry.value), context_);
+                    }
+                    return result;
+                }
+                if (const auto *instance = value.TryAs<ClassInstance>()) {
+                    throw runtime_error("an instance of class "s + instance->GetClass().GetName()
+                                        + " can't be sent to another isolate"s);
+                }
+                throw runtime_error("this value can't be sent to another isolate"s);
+            }
+
+            Context& context_;
+            unordered_map<const Object*, ObjectHolder> copies_;
+        };
+
+        Isolate& TargetOf(const ObjectHolder& target) {
+            const auto *handle = target.TryAs<IsolateHandle>();
+            if (!handle) {
+                throw runtime_error("send() expects an isolate returned by spawn()"s);
+            }
+            return handle->GetIsolate();
+        }
+
+    }  // namespace
+
+    ObjectHolder CopyForIsolate(const ObjectHolder& value, Context& context) {
+        return Copier{context}.Copy(value);
+    }
+
+    // Контекст изолята: вывод накапливается в буфере и передаётся в поток вывода пула
+    // на границах сообщений, чтобы вывод разных изолятов не перемешивался внутри строк
+    class Isolate::ExecutionContext : public Context {
+    public:
+        explicit ExecutionContext(Isolate& isolate)
+                : isolate_(isolate) {
+        }
+
+        std::ostream& GetOutputStream() override {
+            return output_;
+        }
+
+        CallStack& GetCallStack() override {
+            return call_stack_;
+        }
+
+        Isolate* GetIsolate() override {
+            return &isolate_;
+        }
+
+        // Возвращает накопленный вывод и очищает буфер
+        std::string TakeOutput() {
+            std::string text = output_.str();
+            output_.str({});
+            return text;
+        }
+
+    private:
+        Isolate& isolate_;
+        std::ostringstream output_;
+        CallStack call_stack_;
+    };
+
+    Isolate::Isolate(IsolatePool& pool, size_t id, const Class* cls)
+            : pool_(pool)
+            , id_(id)
+            , cls_(cls)
+            , context_(make_unique<ExecutionContext>(*this)) {
+        if (cls_) {
+            receive_ = cls_->GetMethod(RECEIVE_METHOD);
+            if (!receive_ || receive_->formal_params.size() != 2) {
+                throw runtime_error("Class "s + cls_->GetName() + " can't be spawned: it hasn't got method "s
+                                    + RECEIVE_METHOD + "(sender, message)"s);
+            }
+        }
+    }
+
+    Isolate::~Isolate() = default;
+
+    ObjectHolder Isolate::Spawn(const Class& cls, const ObjectHolder* args, size_t argument_count, Context& context) {
+        FlushOutput();
+        vector<ObjectHolder> init_args;
+        init_args.reserve(argument_count);
+        for (size_t i = 0; i < argument_count; ++i) {
+            init_args.push_back(CopyForIsolate(args[i], context));
+        }
+        return ObjectHolder::Own(IsolateHandle{pool_.Spawn(cls, std::move(init_args))});
+    }
+
+    void Isolate::Send(const ObjectHolder& target, const ObjectHolder& message, Context& context) {
+        Isolate &receiver = TargetOf(target);
+        FlushOutput();
+        pool_.Deliver(receiver, Message{shared_from_this(), CopyForIsolate(message, context)});
+    }
+
+    ObjectHolder Isolate::Receive() {
+        if (cls_) {
+            throw runtime_error("recv() is only available in the main isolate; spawned isolates get messages "
+                                "through "s + RECEIVE_METHOD + "(sender, message)"s);
+        }
+        FlushOutput();
+        unique_lock lock(mutex_);
+        while (mailbox_.empty()) {
+            bool idle;
+            {
+                lock_guard pool_lock(pool_.mutex_);
+                idle = pool_.active_ == 0;
+                if (idle && pool_.error_) {
+                    rethrow_exception(std::exchange(pool_.error_, nullptr));
+                }
+            }
+            if (idle) {
+                throw runtime_error("recv() would wait forever: no isolate is running"s);
+            }
+            arrived_.wait(lock);
+        }
+        ObjectHolder message = std::move(mailbox_.front().value);
+        mailbox_.pop_front();
+        return message;
+    }
+
+    size_t Isolate::GetId() const {
+        return id_;
+    }
+
+    void Isolate::FlushOutput() {
+        std::string text = context_->TakeOutput();
+        if (!text.empty()) {
+            pool_.Write(text);
+        }
+    }
+
+    IsolateHandle::IsolateHandle(std::shared_ptr<Isolate> isolate)
+            : isolate_(std::move(isolate)) {
+    }
+
+    void IsolateHandle::Print(std::ostream& os, Context& /*context*/) {
+        os << "<isolate "sv << isolate_->GetId() << '>';
+    }
+
+    Isolate& IsolateHandle::GetIsolate() const {
+        return *isolate_;
+    }
+
+    IsolatePool::IsolatePool(std::ostream& output, size_t thread_count)
+            : output_(output)
+            , main_(make_shared<Isolate>(*this, 0, nullptr))
+            , thread_count_(std::max<size_t>(thread_count, 1)) {
+        isolates_.push_back(main_);
+    }
+
+    IsolatePool::~IsolatePool() {
+        try {
+            Wait();
+        } catch (...) {
+            // Ошибки изолятов, не полученные через Wait, при уничтожении пула отбрасываются
+        }
+        {
+            lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        work_available_.notify_all();
+        for (thread &worker : threads_) {
+            worker.join();
+        }
+        // Объекты изолятов могут хранить описатели друг друга; разрываем циклы владения
+        for (const auto &isolate : isolates_) {
+            isolate->actor_ = ObjectHolder::None();
+            isolate->init_args_.clear();
+            isolate->mailbox_.clear();
+        }
+    }
+
+    Context& IsolatePool::GetMainContext() {
+        return *main_->context_;
+    }
+
+    void IsolatePool::Wait() {
+        main_->FlushOutput();
+        unique_lock lock(mutex_);
+        idle_.wait(lock, [this] {
+            return active_ == 0;
+        });
+        if (error_) {
+            rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+    size_t IsolatePool::GetThreadCount() const {
+        return thread_count_;
+    }
+
+    bool IsolatePool::HasStartedThreads() {
+        lock_guard lock(mutex_);
+        return !threads_.empty();
+    }
+
+    std::shared_ptr<Isolate> IsolatePool::Spawn(const Class& cls, std::vector<ObjectHolder> init_args) {
+        lock_guard lock(mutex_);
+        auto isolate = make_shared<Isolate>(*this, isolates_.size(), &cls);
+        isolate->init_args_ = std::move(init_args);
+        // Первый проход изолята создаёт его объект, даже если сообщений ещё нет
+        isolate->scheduled_ = true;
+        isolates_.push_back(isolate);
+        StartThreads();
+        Enqueue(isolate);
+        return isolate;
+    }
+
+    void IsolatePool::Deliver(Isolate& target, Isolate::Message message) {
+        bool schedule = false;
+        {
+            lock_guard lock(target.mutex_);
+            if (target.failed_) {
+                return;
+            }
+            target.mailbox_.push_back(std::move(message));
+            if (&target != main_.get() && !target.scheduled_) {
+                target.scheduled_ = true;
+                schedule = true;
+            }
+        }
+        if (&target == main_.get()) {
+            target.arrived_.notify_one();
+        }
+        else if (schedule) {
+            lock_guard lock(mutex_);
+            Enqueue(target.shared_from_this());
+        }
+    }
+
+    void IsolatePool::Enqueue(std::shared_ptr<Isolate> isolate) {
+        ++active_;
+        run_queue_.push_back(std::move(isolate));
+        work_available_.notify_one();
+    }
+
+    void IsolatePool::StartThreads() {
+        if (!threads_.empty()) {
+            return;
+        }
+        threads_.reserve(thread_count_);
+        for (size_t i = 0; i < thread_count_; ++i) {
+            threads_.emplace_back([this] {
+                WorkerLoop();
+            });
+        }
+    }
+
+    void IsolatePool::Retire() {
+        bool idle;
+        {
+            lock_guard lock(mutex_);
+            idle = --active_ == 0;
+        }
+        if (idle) {
+            idle_.notify_all();
+            // Главный изолят мог ждать в recv() сообщения, которое уже никто не отправит
+            lock_guard lock(main_->mutex_);
+            main_->arrived_.notify_all();
+        }
+    }
+
+    void IsolatePool::WorkerLoop() {
+        while (true) {
+            std::shared_ptr<Isolate> isolate;
+            {
+                unique_lock lock(mutex_);
+                work_available_.wait(lock, [this] {
+                    return stopping_ || !run_queue_.empty();
+                });
+                if (run_queue_.empty()) {
+                    return;
+                }
+                isolate = std::move(run_queue_.front());
+                run_queue_.pop_front();
+            }
+            RunTurn(isolate);
+        }
+    }
+
+    void IsolatePool::RunTurn(const std::shared_ptr<Isolate>& isolate) {
+        Context &context = *isolate->context_;
+        bool finished = false;
+        try {
+            if (!isolate->actor_) {
+                isolate->actor_ = ObjectHolder::Own(ClassInstance{*isolate->cls_});
+                auto &instance = *isolate->actor_.TryAs<ClassInstance>();
+                auto init_args = std::move(isolate->init_args_);
+                if (instance.HasMethod(INIT_METHOD, init_args.size())) {
+                    instance.Call(INIT_METHOD, init_args, context);
+                }
+            }
+            auto &actor = *isolate->actor_.TryAs<ClassInstance>();
+            for (size_t processed = 0; processed < MESSAGES_PER_TURN; ++processed) {
+                Isolate::Message message;
+                {
+                    lock_guard lock(isolate->mutex_);
+                    if (isolate->mailbox_.empty()) {
+                        isolate->scheduled_ = false;
+                        finished = true;
+                        break;
+                    }
+                    message = std::move(isolate->mailbox_.front());
+                    isolate->mailbox_.pop_front();
+                }
+                ObjectHolder args[] = {ObjectHolder::Own(IsolateHandle{std::move(message.sender)}),
+                                       std::move(message.value)};
+                actor.Call(*isolate->receive_, args, 2, context);
+            }
+        } catch (...) {
+            {
+                lock_guard lock(isolate->mutex_);
+                isolate->failed_ = true;
+                isolate->scheduled_ = false;
+                isolate->mailbox_.clear();
+            }
+            lock_guard lock(mutex_);
+            if (!error_) {
+                error_ = current_exception();
+            }
+            finished = true;
+        }
+        isolate->FlushOutput();
+        if (finished) {
+            Retire();
+        }
+        else {
+            // Сообщения ещё есть: изолят уступает поток и встаёт в конец очереди
+            lock_guard lock(mutex_);
+            run_queue_.push_back(isolate);
+            work_available_.notify_one();
+        }
+    }
+
+    void IsolatePool::Write(const std::string& text) {
+        lock_guard lock(output_mutex_);
+        output_ << text;
+    }
+
+}  // namespace runtime
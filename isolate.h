@@ -0,0 +1,168 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Изоляты - независимые экземпляры интерпретатора внутри одного процесса (модель акторов).
+
+Каждый изолят владеет своими объектами, своим стеком вызовов и буфером вывода. Изоляты не имеют
+общих значений: они обмениваются только сообщениями, а сообщение при отправке копируется
+(см. CopyForIsolate). Поэтому счётчики ссылок объектов одного изолята никогда не изменяются
+из других потоков.
+
+Изолят, созданный встроенной функцией spawn(ClassName, args...), хранит объект класса ClassName
+и обрабатывает входящие сообщения вызовом его метода receive(sender, message), где sender -
+описатель отправителя. Изоляты выполняются на фиксированном пуле потоков IsolatePool; в каждый
+момент изолят выполняется не более чем одним потоком, а метод receive не блокируется.
+Код главного изолята выполняется потоком владельца пула и ждёт сообщения встроенной функцией recv()
+*/
+namespace runtime {
+
+    class IsolatePool;
+
+// Изолят пула IsolatePool. Создаётся только пулом
+    class Isolate : public std::enable_shared_from_this<Isolate> {
+    public:
+        // cls равен nullptr для главного изолята
+        Isolate(IsolatePool& pool, size_t id, const Class* cls);
+        ~Isolate();
+
+        Isolate(const Isolate&) = delete;
+        Isolate& operator=(const Isolate&) = delete;
+
+        // Создаёт изолят с объектом класса cls, конструктору которого передаются копии argument_count
+        // аргументов, начиная с args. Возвращает описатель нового изолята (IsolateHandle).
+        // Если у класса нет метода receive(sender, message), выбрасывает runtime_error
+        ObjectHolder Spawn(const Class& cls, const ObjectHolder* args, size_t argument_count, Context& context);
+
+        // Отправляет изоляту с описателем target копию message
+        void Send(const ObjectHolder& target, const ObjectHolder& message, Context& context);
+
+        // Ждёт и возвращает следующее сообщение главному изоляту. Если сообщений нет и ни один изолят
+        // не выполняется, выбрасывает ошибку изолята, если она была, а иначе runtime_error
+        ObjectHolder Receive();
+
+        [[nodiscard]] size_t GetId() const;
+
+    private:
+        friend class IsolatePool;
+        class ExecutionContext;
+
+        struct Message {
+            std::shared_ptr<Isolate> sender;
+            ObjectHolder value;
+        };
+
+        // Передаёт накопленный вывод изолята в поток вывода пула
+        void FlushOutput();
+
+        IsolatePool& pool_;
+        const size_t id_;
+        const Class* cls_;
+        const Method* receive_ = nullptr;
+
+        // Доступны только потоку, выполняющему изолят
+        std::unique_ptr<ExecutionContext> context_;
+        ObjectHolder actor_;
+        std::vector<ObjectHolder> init_args_;
+
+        // Очередь сообщений и признаки планирования защищены mutex_
+        std::mutex mutex_;
+        std::condition_variable arrived_;
+        std::deque<Message> mailbox_;
+        bool scheduled_ = false;
+        bool failed_ = false;
+    };
+
+// Описатель изолята - значение, через которое программа отправляет изоляту сообщения.
+// Выводится как "<isolate N>"
+    class IsolateHandle : public Object {
+    public:
+        explicit IsolateHandle(std::shared_ptr<Isolate> isolate);
+
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] Isolate& GetIsolate() const;
+
+    private:
+        std::shared_ptr<Isolate> isolate_;
+    };
+
+/*
+Возвращает глубокую копию value для передачи в другой изолят: числа, строки, Bool, None,
+списки, словари и intarray копируются целиком (общие подобъекты и циклы сохраняются),
+описатели изолятов - как новые описатели тех же изолятов.
+Для объектов классов и объектов C++ выбрасывает runtime_error
+*/
+    ObjectHolder CopyForIsolate(const ObjectHolder& value, Context& context);
+
+/*
+Фиксированный пул потоков, на котором выполняются изоляты.
+Программа главного изолята выполняется в контексте GetMainContext() потоком владельца пула.
+Потоки запускаются при создании первого изолята spawn, поэтому программа без изолятов не создаёт потоков.
+Деструктор дожидается обработки всех сообщений и останавливает потоки
+*/
+    class IsolatePool {
+    public:
+        // Сколько сообщений изолят обрабатывает подряд, прежде чем уступить поток другим изолятам
+        static constexpr size_t MESSAGES_PER_TURN = 64;
+
+        explicit IsolatePool(std::ostream& output, size_t thread_count = std::thread::hardware_concurrency());
+        ~IsolatePool();
+
+        IsolatePool(const IsolatePool&) = delete;
+        IsolatePool& operator=(const IsolatePool&) = delete;
+
+        // Контекст главного изолята: выполняемый в нём код может вызывать spawn, send и recv
+        [[nodiscard]] Context& GetMainContext();
+
+        // Ждёт, пока изоляты обработают все сообщения, и выводит их вывод.
+        // Если при обработке сообщения изолят выбросил исключение, перевыбрасывает первое из них
+        void Wait();
+
+        [[nodiscard]] size_t GetThreadCount() const;
+        // Возвращает true, если потоки пула уже запущены
+        [[nodiscard]] bool HasStartedThreads();
+
+    private:
+        friend class Isolate;
+
+        std::shared_ptr<Isolate> Spawn(const Class& cls, std::vector<ObjectHolder> init_args);
+        void Deliver(Isolate& target, Isolate::Message message);
+        // Ставит изолят в очередь выполнения. Вызывается при захваченном mutex_
+        void Enqueue(std::shared_ptr<Isolate> isolate);
+        // Запускает потоки пула, если они ещё не запущены. Вызывается при захваченном mutex_
+        void StartThreads();
+        // Снимает изолят с учёта выполняемых и будит ожидающих
+        void Retire();
+        void WorkerLoop();
+        void RunTurn(const std::shared_ptr<Isolate>& isolate);
+        void Write(const std::string& text);
+
+        std::ostream& output_;
+        std::mutex output_mutex_;
+
+        std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::condition_variable idle_;
+        std::deque<std::shared_ptr<Isolate>> run_queue_;
+        std::vector<std::shared_ptr<Isolate>> isolates_;
+        // Количество изолятов в очереди выполнения или выполняемых сейчас
+        size_t active_ = 0;
+        bool stopping_ = false;
+        std::exception_ptr error_;
+
+        std::shared_ptr<Isolate> main_;
+        const size_t thread_count_;
+        std::vector<std::thread> threads_;
+    };
+
+}  // namespace runtime
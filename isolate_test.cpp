@@ -0,0 +1,176 @@
+#include "dict.h"
+#include "isolate.h"
+#include "program.h"
+#include "test_runner_p.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        string Run(const string& text, size_t threads = 4) {
+            istringstream input(text);
+            const mython::Program program{input};
+            ostringstream output;
+            {
+                IsolatePool pool{output, threads};
+                Closure closure;
+                program.Execute(closure, pool.GetMainContext());
+                pool.Wait();
+            }
+            return output.str();
+        }
+
+        void TestCopyForIsolate() {
+            DummyContext context;
+            ObjectHolder text = ObjectHolder::Own(String{"hello"s});
+            ObjectHolder list = ObjectHolder::Own(List{});
+            auto &items = *list.TryAs<List>();
+            items.Append(ObjectHolder::Own(Number{1}));
+            items.Append(text);
+            items.Append(text);
+            ObjectHolder dict = ObjectHolder::Own(Dict{});
+            dict.TryAs<Dict>()->Set(text, list, context);
+            items.Append(dict);
+
+            ObjectHolder copy = CopyForIsolate(list, context);
+            const auto &copied = copy.TryAs<List>()->GetItems();
+            ASSERT(copy.Get() != list.Get());
+            ASSERT_EQUAL(copied.size(), 4U);
+            ASSERT_EQUAL(copied[0].TryAs<Number>()->GetValue(), 1);
+            ASSERT(copied[1].Get() != text.Get());
+            ASSERT_EQUAL(copied[1].TryAs<String>()->GetView(), "hello"sv);
+            // Общие подобъекты и циклы сохраняются в копии
+            ASSERT_EQUAL(copied[1].Get(), copied[2].Get());
+            const auto &entry = copied[3].TryAs<Dict>()->GetEntries().front();
+            ASSERT_EQUAL(entry.key.Get(), copied[1].Get());
+            ASSERT_EQUAL(entry.value.Get(), copy.Get());
+
+            ASSERT(!CopyForIsolate(ObjectHolder::None(), context));
+            Class cls{"Point"s, {}, nullptr};
+            ASSERT_THROWS(CopyForIsolate(ObjectHolder::Own(ClassInstance{cls}), context), runtime_error);
+            // Циклы владения list -> dict -> list разрываются вручную
+            dict.TryAs<Dict>()->Set(text, ObjectHolder::None(), context);
+            copy.TryAs<List>()->Set(3, ObjectHolder::None());
+        }
+
+        void TestMessages() {
+            const string program = R"(
+class Squarer:
+  def __init__(offset):
+    self.offset = offset
+    self.count = 0
+
+  def receive(sender, message):
+    self.count = self.count + 1
+    send(sender, [message, message * message + self.offset, self.count])
+
+class Relay:
+  def __init__(target):
+    self.target = target
+    self.waiting = False
+
+  def receive(sender, message):
+    if self.waiting:
+      send(self.client, message)
+    else:
+      self.waiting = True
+      self.client = sender
+      send(self.target, message)
+
+squarer = spawn(Squarer, 100)
+for i in range(5):
+  send(squarer, i)
+total = 0
+last = 0
+for i in range(5):
+  reply = recv()
+  total = total + reply[1]
+  last = reply[2]
+print total, last
+
+relay = spawn(Relay, squarer)
+send(relay, 7)
+print recv()
+print squarer
+)"s;
+            for (size_t threads : {1, 4}) {
+                ASSERT_EQUAL(Run(program, threads), "530 5\n[7, 149, 6]\n<isolate 1>\n"s);
+            }
+        }
+
+        void TestOutputAndErrors() {
+            ASSERT_EQUAL(Run(R"(
+class Printer:
+  def __init__(name):
+    print 'started', name
+
+  def receive(sender, message):
+    print 'got', message
+    send(sender, message)
+
+print 'main'
+p = spawn(Printer, 'p')
+send(p, 'a')
+recv()
+print 'done'
+)"), "main\nstarted p\ngot a\ndone\n"s);
+
+            // Ошибка изолята перевыбрасывается из recv(), который иначе ждал бы вечно
+            ASSERT_THROWS(Run(R"(
+class Broken:
+  def receive(sender, message):
+    send(sender, message + 1)
+
+b = spawn(Broken)
+send(b, 'text')
+recv()
+)"), runtime_error);
+            ASSERT_THROWS(Run("print recv()\n"), runtime_error);
+            ASSERT_THROWS(Run("class A:\n  def f():\n    return 1\n\nspawn(A)\n"), runtime_error);
+            ASSERT_THROWS(Run("class A:\n  def receive(sender, message):\n    recv()\n\nsend(spawn(A), 1)\n"),
+                          runtime_error);
+            ASSERT_THROWS(Run("class A:\n  def receive(sender, message):\n    return 1\n\nsend(spawn(A), A())\n"),
+                          runtime_error);
+
+            // Без пула изолятов встроенные функции недоступны
+            istringstream input("class A:\n  def receive(sender, message):\n    return 1\n\nx = spawn(A)\n");
+            const mython::Program program{input};
+            DummyContext context;
+            Closure closure;
+            ASSERT_THROWS(program.Execute(closure, context), runtime_error);
+        }
+
+        void TestThreadsStartOnFirstSpawn() {
+            const string echo = "class Echo:\n  def receive(sender, message):\n    send(sender, message)\n\n"s;
+            istringstream input(echo + "print 'no isolates'\n"s);
+            const mython::Program program{input};
+            istringstream spawn_input(echo + "e = spawn(Echo)\nsend(e, 5)\nprint recv()\n"s);
+            const mython::Program spawn_program{spawn_input};
+            ostringstream output;
+            IsolatePool pool{output, 2};
+            Closure closure;
+            program.Execute(closure, pool.GetMainContext());
+            pool.Wait();
+            ASSERT(!pool.HasStartedThreads());
+            ASSERT_EQUAL(pool.GetThreadCount(), 2U);
+
+            spawn_program.Execute(closure, pool.GetMainContext());
+            pool.Wait();
+            ASSERT(pool.HasStartedThreads());
+            ASSERT_EQUAL(output.str(), "no isolates\n5\n"s);
+        }
+
+    }  // namespace
+
+    void RunIsolateTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestCopyForIsolate);
+        RUN_TEST(tr, runtime::TestMessages);
+        RUN_TEST(tr, runtime::TestOutputAndErrors);
+        RUN_TEST(tr, runtime::TestThreadsStartOnFirstSpawn);
+    }
+
+}  // namespace runtime
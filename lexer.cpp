@@ -22,6 +22,9 @@ namespace parse {
         if (lhs.Is<Number>()) {
             return lhs.As<Number>().value == rhs.As<Number>().value;
         }
+        if (lhs.Is<BigNumber>()) {
+            return lhs.As<BigNumber>().value == rhs.As<BigNumber>().value;
+        }
         if (lhs.Is<String>()) {
             return lhs.As<String>().value == rhs.As<String>().value;
         }
@@ -42,6 +45,7 @@ namespace parse {
     if (auto p = rhs.TryAs<type>()) return os << #type << '{' << p->value << '}';
 
         VALUED_OUTPUT(Number);
+        VALUED_OUTPUT(BigNumber);
         VALUED_OUTPUT(Id);
         VALUED_OUTPUT(String);
         VALUED_OUTPUT(Char);
@@ -55,6 +59,9 @@ namespace parse {
         UNVALUED_OUTPUT(Return);
         UNVALUED_OUTPUT(If);
         UNVALUED_OUTPUT(Else);
+        UNVALUED_OUTPUT(While);
+        UNVALUED_OUTPUT(For);
+        UNVALUED_OUTPUT(In);
         UNVALUED_OUTPUT(Def);
         UNVALUED_OUTPUT(Newline);
         UNVALUED_OUTPUT(Print);
@@ -212,7 +219,12 @@ namespace parse {
         for (char sym; std::isdigit(in_.peek()) && in_ >> sym;) {
             ans.push_back(sym);
         }
-        return token_type::Number{stoi(ans)};
+        int64_t value = 0;
+        auto [end, error] = std::from_chars(ans.data(), ans.data() + ans.size(), value);
+        if (error == std::errc::result_out_of_range) {
+            return token_type::BigNumber{std::move(ans)};
+        }
+        return token_type::Number{value};
     }
 
     Token Lexer::ReadString() {
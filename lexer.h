@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iosfwd>
 #include <optional>
 #include <sstream>
@@ -10,8 +11,12 @@
 namespace parse {
 
     namespace token_type {
-        struct Number {  // Лексема «число»
-            int value;   // число
+        struct Number {     // Лексема «число»
+            int64_t value;  // число
+        };
+
+        struct BigNumber {      // Лексема «число», не помещающееся в int64_t
+            std::string value;  // десятичная запись числа
         };
 
         struct Id {             // Лексема «идентификатор»
@@ -30,6 +35,9 @@ namespace parse {
         struct Return {};   // Лексема «return»
         struct If {};       // Лексема «if»
         struct Else {};     // Лексема «else»
+        struct While {};    // Лексема «while»
+        struct For {};      // Лексема «for»
+        struct In {};       // Лексема «in»
         struct Def {};      // Лексема «def»
         struct Newline {};  // Лексема «конец строки»
         struct Print {};    // Лексема «print»
@@ -49,8 +57,9 @@ namespace parse {
     }  // namespace token_type
 
     using TokenBase
-            = std::variant<token_type::Number, token_type::Id, token_type::Char, token_type::String,
-            token_type::Class, token_type::Return, token_type::If, token_type::Else,
+            = std::variant<token_type::Number, token_type::BigNumber, token_type::Id, token_type::Char, token_type::String,
+            token_type::Class, token_type::Return, token_type::If, token_type::Else, token_type::While,
+            token_type::For, token_type::In,
             token_type::Def, token_type::Newline, token_type::Print, token_type::Indent,
             token_type::Dedent, token_type::And, token_type::Or, token_type::Not,
             token_type::Eq, token_type::NotEq, token_type::LessOrEq, token_type::GreaterOrEq,
@@ -173,6 +182,15 @@ namespace parse {
             else if (command == "else") {
                 return {parse::token_type::Else{}};
             }
+            else if (command == "while") {
+                return {parse::token_type::While{}};
+            }
+            else if (command == "for") {
+                return {parse::token_type::For{}};
+            }
+            else if (command == "in") {
+                return {parse::token_type::In{}};
+            }
             else if (command == "def") {
                 return {parse::token_type::Def{}};
             }
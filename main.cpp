@@ -1,7 +1,8 @@
-#include "lexer.h"
-#include "parse.h"
+#include "isolate.h"
+#include "program.h"
 #include "runtime.h"
 #include "statement.h"
+#include "tasks.h"
 #include "test_runner_p.h"
 
 #include <iostream>
@@ -14,23 +15,50 @@ namespace parse {
 
 namespace ast {
     void RunUnitTests(TestRunner& tr);
+    void RunSpecializationTests(TestRunner& tr);
+    void RunStringifyTests(TestRunner& tr);
+    void RunControlFlowTests(TestRunner& tr);
 }
 namespace runtime {
     void RunObjectHolderTests(TestRunner& tr);
     void RunObjectsTests(TestRunner& tr);
+    void RunStringTests(TestRunner& tr);
+    void RunCallTests(TestRunner& tr);
+    void RunListTests(TestRunner& tr);
+    void RunBigIntTests(TestRunner& tr);
+    void RunDictTests(TestRunner& tr);
+    void RunIntArrayTests(TestRunner& tr);
+    void RunModuleTests(TestRunner& tr);
+    void RunIsolateTests(TestRunner& tr);
+    void RunTaskTests(TestRunner& tr);
 }  // namespace runtime
 
 void TestParseProgram(TestRunner& tr);
 
+namespace bytecode {
+    void RunBytecodeTests(TestRunner& tr);
+}  // namespace bytecode
+
+namespace ast {
+    void RunSuperinstructionTests(TestRunner& tr);
+    void RunTailCallTests(TestRunner& tr);
+}  // namespace ast
+
+namespace mython {
+    void RunProgramTests(TestRunner& tr);
+}  // namespace mython
+
 namespace {
 
     void RunMythonProgram(istream& input, ostream& output) {
-        parse::Lexer lexer(input);
-        auto program = ParseProgram(lexer);
+        const mython::Program program{input};
 
-        runtime::SimpleContext context{output};
+        runtime::IsolatePool isolates{output};
+        runtime::TaskPool tasks{isolates.GetMainContext()};
         runtime::Closure closure;
-        program->Execute(closure, context);
+        program.Execute(closure, tasks.GetMainContext());
+        tasks.Wait();
+        isolates.Wait();
     }
 
     void TestSimplePrints() {
@@ -111,18 +139,412 @@ print y.value
         ASSERT_EQUAL(output.str(), "2\n3\n");
     }
 
+    void TestWideIntegers() {
+        istringstream input(R"(
+big = 9223372036854775807
+print big + 1, big * big
+print 9223372036854775808 - 1, -9223372036854775808
+x = 170141183460469231722463931679029329921 / 18446744073709551617
+print x, x - 1 < big
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "9223372036854775808 85070591730234615847396907784232501249\n"
+                                   "9223372036854775807 -9223372036854775808\n"
+                                   "9223372036854775807 True\n");
+    }
+
+    void TestWhileLoop() {
+        istringstream input(R"(
+class Finder:
+  def first_multiple(start, divisor):
+    n = start
+    while True:
+      if n / divisor * divisor == n:
+        return n
+      n = n + 1
+
+i = 0
+total = 0
+while i < 3:
+  j = 0
+  while j < i + 1:
+    total = total + 1
+    j = j + 1
+  i = i + 1
+print i, total
+
+s = 'abc'
+while s:
+  s = ''
+f = Finder()
+print f.first_multiple(10, 7)
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "3 6\n14\n");
+    }
+
+    void TestReturn() {
+        istringstream input(R"(
+class Search:
+  def in_range(n):
+    for i in range(100):
+      for j in range(i):
+        if i * j == n:
+          return str(j) + 'x' + str(i)
+    return 'none'
+
+  def in_list(items, value):
+    for item in items:
+      if item == value:
+        print 'found', item
+        return True
+      print 'skip', item
+    return False
+
+  def in_dict(d):
+    for key in d:
+      return key
+
+  def in_array(a):
+    for x in a:
+      if x > 2:
+        return x
+
+  def nested(n):
+    return self.in_range(n) + ' ' + str(self.in_array(intarray([n, n + 1])))
+
+  def nothing():
+    x = 1
+
+s = Search()
+print s.in_range(12), s.in_range(10007)
+print s.in_list([1, 2, 3], 2), s.in_list([], 5)
+print s.in_dict({'b': 1, 'a': 2}), s.in_array(intarray([1, 2, 3, 4])), s.in_array(intarray([1]))
+print s.nested(6), s.nothing()
+return 5
+print 'unreachable'
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "3x4 none\nskip 1\nfound 2\nTrue False\nb 3 None\n2x3 6 None\n");
+    }
+
+    void TestForLoop() {
+        istringstream input(R"(
+class Countdown:
+  def __init__(start):
+    self.current = start
+
+  def __iter__():
+    return self
+
+  def __next__():
+    if self.current > 0:
+      self.current = self.current - 1
+      return self.current + 1
+    return None
+
+class Evens:
+  def __init__(limit):
+    self.limit = limit
+
+  def __iter__():
+    return range(0, self.limit, 2)
+
+total = 0
+for i in range(5):
+  total = total + i
+print total, i
+
+kept = 0
+for i in range(10, 0, -3):
+  kept = i
+  print i
+print kept
+
+for x in Countdown(3):
+  print 'x =', x
+for x in Evens(5):
+  print 'even', x
+r = range(2, 4)
+print r, range(0, 10, 5)
+for n in r:
+  print n
+for n in range(0):
+  print 'never'
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "10 4\n10\n7\n4\n1\n1\nx = 3\nx = 2\nx = 1\neven 0\neven 2\neven 4\n"
+                                   "range(2, 4) range(0, 10, 5)\n2\n3\n");
+    }
+
+    void TestLists() {
+        istringstream input(R"(
+class Stack:
+  def __init__():
+    self.items = []
+
+  def push(value):
+    self.items.append(value)
+
+  def top():
+    return self.items[-1]
+
+empty = []
+xs = [1, 'two', None, [3, 4]]
+print xs, len(xs), len(empty), len('abc')
+print xs[0], xs[-1][1], [5, 6, 7][2]
+xs[1] = 2
+xs.append(xs[0] + xs[1])
+print xs, xs[4]
+if empty:
+  print 'never'
+total = 0
+for x in [10, 20, 30]:
+  total = total + x
+print total
+
+s = Stack()
+for i in range(3):
+  s.push(i * i)
+print s.top(), len(s.items), s.items == [0, 1, 4], [1] == [2]
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "[1, two, None, [3, 4]] 4 0 3\n1 4 7\n[1, 2, None, [3, 4], 3] 3\n60\n"
+                                   "4 3 True False\n");
+
+        for (const char *program : {"xs = [1]\nprint xs[1]\n", "xs = [1]\nprint xs['a']\n",
+                                    "x = 1\nprint x[0]\n", "xs = []\nxs.push(1)\n"}) {
+            istringstream bad_input(program);
+            ostringstream bad_output;
+            ASSERT_THROWS(RunMythonProgram(bad_input, bad_output), std::runtime_error);
+        }
+    }
+
+    void TestStringBuilding() {
+        istringstream input(R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __str__():
+    return '(' + str(self.x) + ', ' + str(self.y) + ')'
+
+  def __add__(other):
+    return str(self.x + other)
+
+p = Point(1, 2)
+items = ['a', 1, None, p]
+print 'p = ' + str(p) + '!'
+print join(', ', 1, True, p), join('-', items), join('-', []), join(', ', 'x')
+print format('{} + {} = {}', 2, 3, 2 + 3), format('{{{}}}', 'x'), format('plain')
+q = p + 1 + '|' + 'z'
+print q
+line = ''
+for i in range(30):
+  line = line + str(i) + ','
+print line
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "p = (1, 2)!\n1, True, (1, 2) a-1-None-(1, 2)  x\n2 + 3 = 5 {x} plain\n"
+                                   "2|z\n0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,"
+                                   "27,28,29,\n");
+
+        for (const char *program : {"print 'a' + 1 + 'b'\n", "print join(1, 2)\n", "print format('{}')\n",
+                                    "print format('{}', 1, 2)\n", "print format('{', 1)\n"}) {
+            istringstream bad_input(program);
+            ostringstream bad_output;
+            ASSERT_THROWS(RunMythonProgram(bad_input, bad_output), std::runtime_error);
+        }
+    }
+
+    void TestStringSlices() {
+        istringstream input(R"(
+line = 'GET /index.html 200'
+first = line.find(' ')
+second = line.find(' ', first + 1)
+method = line[:first]
+path = line[first + 1:second]
+print method, path, line[second + 1:], line[-3:], line[0], line[-1]
+print '[' + line[5:100] + ']', '[' + line[100:] + ']', '[' + line[3:1] + ']', line[:] == line
+print line.find('POST'), line.find('GET', -100), len(path)
+counts = {}
+counts[path[1:6]] = 1
+print counts['index']
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "GET /index.html 200 200 G 0\n[index.html 200] [] [] True\n-1 0 11\n1\n");
+
+        for (const char *program : {"print 'abc'[3]\n", "print 'abc'['a':]\n", "x = [1]\nprint x[0:1]\n",
+                                    "print 'abc'.find(1)\n"}) {
+            istringstream bad_input(program);
+            ostringstream bad_output;
+            ASSERT_THROWS(RunMythonProgram(bad_input, bad_output), std::runtime_error);
+        }
+    }
+
+    void TestDicts() {
+        istringstream input(R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __hash__():
+    return self.x * 31 + self.y
+
+  def __eq__(other):
+    return self.x == other.x and self.y == other.y
+
+ages = {'bob': 31, 'alice': 27}
+ages['carol'] = 40
+ages['bob'] = 32
+print ages, len(ages), ages['alice']
+print ages.get('dave'), ages.get('dave', 0), ages.keys(), {}
+for name in ages:
+  print name, ages[name]
+
+names = {Point(1, 2): 'a', Point(2, 1): 'b'}
+names[Point(1, 2)] = 'c'
+print len(names), names[Point(1, 2)], names[Point(2, 1)]
+print {1: [1, 2], True: None, None: 'none'}[1][1], {1: 2} == {1: 2}, {1: 2} == {1: 3}
+if {}:
+  print 'never'
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "{bob: 32, alice: 27, carol: 40} 3 27\nNone 0 [bob, alice, carol] {}\n"
+                                   "bob 32\nalice 27\ncarol 40\n2 c b\n2 True False\n");
+
+        for (const char *program : {"d = {}\nprint d['a']\n", "d = {[1]: 2}\n", "d = {}\nd.pop(1)\n"}) {
+            istringstream bad_input(program);
+            ostringstream bad_output;
+            ASSERT_THROWS(RunMythonProgram(bad_input, bad_output), std::runtime_error);
+        }
+    }
+
+    void TestIntArrays() {
+        istringstream input(R"(
+xs = intarray(range(1, 6))
+ys = intarray([10, 20, 30, 40, 50])
+print xs, len(xs), xs[0], xs[-1]
+print xs.sum(), xs.min(), xs.max(), xs.dot(ys)
+print xs.add(ys), xs.mul(ys)
+mask = xs.lt(3)
+print xs.gt(2), mask.sum(), xs.eq(4)
+xs[0] = 7
+xs.append(9)
+total = 0
+for x in xs:
+  total = total + x
+print total, intarray(3), intarray(xs) == xs
+big = intarray([9000000000000000000, 9000000000000000000])
+print big.sum()
+if intarray(0):
+  print 'never'
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "intarray([1, 2, 3, 4, 5]) 5 1 5\n15 1 5 550\n"
+                                   "intarray([11, 22, 33, 44, 55]) intarray([10, 40, 90, 160, 250])\n"
+                                   "intarray([0, 0, 1, 1, 1]) 2 intarray([0, 0, 0, 1, 0])\n"
+                                   "30 intarray([0, 0, 0]) True\n18000000000000000000\n");
+
+        for (const char *program : {"xs = intarray(['a'])\n", "xs = intarray(2)\nxs[0] = 'a'\n",
+                                    "xs = intarray(2)\nprint xs.add(intarray(3))\n",
+                                    "xs = intarray([9000000000000000000])\nprint xs.add(xs)\n"}) {
+            istringstream bad_input(program);
+            ostringstream bad_output;
+            ASSERT_THROWS(RunMythonProgram(bad_input, bad_output), std::runtime_error);
+        }
+    }
+
+    void TestRecursionLimit() {
+        const string program = R"(
+class Counter:
+  def depth(n):
+    if n == 0:
+      return 0
+    return 1 + self.depth(n - 1)
+
+c = Counter()
+print c.depth(100)
+print c.depth(10000000)
+)";
+        istringstream input(program);
+        ostringstream output;
+        try {
+            RunMythonProgram(input, output);
+            ASSERT(false);
+        } catch (const runtime_error& e) {
+            ASSERT_EQUAL(string(e.what()), "maximum recursion depth exceeded"s);
+        }
+        ASSERT_EQUAL(output.str(), "100\n");
+    }
+
     void TestAll() {
         TestRunner tr;
 //        parse::RunOpenLexerTests(tr);
 //        runtime::RunObjectHolderTests(tr);
 //        runtime::RunObjectsTests(tr);
+        runtime::RunStringTests(tr);
+        runtime::RunCallTests(tr);
+        runtime::RunListTests(tr);
 //        ast::RunUnitTests(tr);
+        ast::RunSpecializationTests(tr);
+        ast::RunStringifyTests(tr);
+        ast::RunControlFlowTests(tr);
         TestParseProgram(tr);
+        bytecode::RunBytecodeTests(tr);
+        ast::RunSuperinstructionTests(tr);
+        ast::RunTailCallTests(tr);
+        runtime::RunBigIntTests(tr);
+        runtime::RunDictTests(tr);
+        runtime::RunIntArrayTests(tr);
+        runtime::RunModuleTests(tr);
+        runtime::RunIsolateTests(tr);
+        runtime::RunTaskTests(tr);
+        mython::RunProgramTests(tr);
 
 //        RUN_TEST(tr, TestSimplePrints);
 //        RUN_TEST(tr, TestAssignments);
 //        RUN_TEST(tr, TestArithmetics);
 //        RUN_TEST(tr, TestVariablesArePointers);
+        RUN_TEST(tr, TestWideIntegers);
+        RUN_TEST(tr, TestWhileLoop);
+        RUN_TEST(tr, TestReturn);
+        RUN_TEST(tr, TestForLoop);
+        RUN_TEST(tr, TestLists);
+        RUN_TEST(tr, TestStringBuilding);
+        RUN_TEST(tr, TestStringSlices);
+        RUN_TEST(tr, TestDicts);
+        RUN_TEST(tr, TestIntArrays);
+        RUN_TEST(tr, TestRecursionLimit);
     }
 
 }  // namespace
@@ -0,0 +1,57 @@
+#include "module.h"
+
+using namespace std;
+
+namespace runtime {
+
+    ObjectHolder NativeFunction::Call(Object* self, ObjectHolder* args, size_t argument_count,
+                                      Context& context) const {
+        if (argument_count != arity) {
+            throw runtime_error(name + "() takes "s + to_string(arity) + " arguments, "s
+                                + to_string(argument_count) + " given"s);
+        }
+        return invoke(*this, self, args, context);
+    }
+
+    void NativeObject::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << this;
+    }
+
+    const std::string& NativeClass::GetName() const {
+        return name_;
+    }
+
+    const NativeFunction* NativeClass::GetMethod(const std::string& name) const {
+        auto it = methods_.find(name);
+        return it == methods_.end() ? nullptr : &it->second;
+    }
+
+    void NativeClass::SetName(std::string name) {
+        name_ = std::move(name);
+    }
+
+    void NativeClass::AddMethod(NativeFunction method) {
+        // Имя метода в таблице - часть полного имени после имени класса
+        string name = method.name.substr(method.name.rfind('.') + 1);
+        methods_[std::move(name)] = std::move(method);
+    }
+
+    const NativeFunction* Module::FindFunction(const std::string& name) const {
+        auto it = functions_.find(name);
+        return it == functions_.end() ? nullptr : &it->second;
+    }
+
+    namespace native_detail {
+
+        void ThrowArgumentError(const NativeFunction& function, size_t index, std::string_view expected) {
+            throw runtime_error("argument "s + to_string(index + 1) + " of "s + function.name + "() must be "s
+                                + string(expected));
+        }
+
+        void ThrowResultError(const NativeFunction& function) {
+            throw runtime_error("result of "s + function.name + "() doesn't fit into an integer"s);
+        }
+
+    }  // namespace native_detail
+
+}  // namespace runtime
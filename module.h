@@ -0,0 +1,350 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace runtime {
+
+    class NativeClass;
+
+/*
+Функция или метод C++, доступные из Mython.
+
+Указатель на функцию C++ хранится в target как есть, а invoke - сгенерированная шаблоном
+функция, которая распаковывает аргументы Mython в параметры функции C++, вызывает её
+и упаковывает результат в ObjectHolder. Вызов обходится без Closure и без выделения памяти
+под аргументы: стоимость - два косвенных вызова и проверки типов аргументов
+*/
+    struct NativeFunction {
+        using Invoker = ObjectHolder (*)(const NativeFunction& function, Object* self, ObjectHolder* args,
+                                         Context& context);
+
+        std::string name;
+        size_t arity = 0;
+        Invoker invoke = nullptr;
+        // Указатель на функцию или на метод класса C++
+        alignas(std::max_align_t) unsigned char target[2 * sizeof(void*)] = {};
+
+        // Вызывает функцию с argument_count аргументами, начиная с args; self - объект,
+        // метод которого вызывается, или nullptr для свободной функции.
+        // Если количество аргументов не совпадает с arity, выбрасывает исключение runtime_error
+        ObjectHolder Call(Object* self, ObjectHolder* args, size_t argument_count, Context& context) const;
+    };
+
+// Базовый класс объектов, реализованных на C++. Методы такого объекта, зарегистрированные
+// в его NativeClass, вызываются из Mython как методы объектов классов: obj.method(args)
+    class NativeObject : public Object {
+    public:
+        [[nodiscard]] virtual const NativeClass& GetNativeClass() const = 0;
+
+        // Выводит адрес объекта, как и объект класса Mython без метода __str__
+        void Print(std::ostream& os, Context& context) override;
+    };
+
+// Таблица методов класса C++, доступных из Mython. Для каждого типа T существует
+// единственная таблица NativeClass::Of<T>(), общая для всех модулей
+    class NativeClass {
+    public:
+        template <typename T>
+        static NativeClass& Of() {
+            static NativeClass cls;
+            return cls;
+        }
+
+        [[nodiscard]] const std::string& GetName() const;
+        // Возвращает метод с именем name или nullptr
+        [[nodiscard]] const NativeFunction* GetMethod(const std::string& name) const;
+
+        void SetName(std::string name);
+        // Добавляет метод или заменяет ранее зарегистрированный метод с тем же именем
+        void AddMethod(NativeFunction method);
+
+    private:
+        NativeClass() = default;
+
+        std::string name_;
+        std::unordered_map<std::string, NativeFunction> methods_;
+    };
+
+// Удобный базовый класс для объектов C++: связывает тип T с его таблицей методов
+//
+// class Counter : public runtime::Native<Counter> { ... };
+    template <typename T>
+    class Native : public NativeObject {
+    public:
+        [[nodiscard]] const NativeClass& GetNativeClass() const override {
+            return NativeClass::Of<T>();
+        }
+    };
+
+    namespace native_detail {
+
+        [[noreturn]] void ThrowArgumentError(const NativeFunction& function, size_t index, std::string_view expected);
+        [[noreturn]] void ThrowResultError(const NativeFunction& function);
+
+        template <typename T>
+        inline constexpr bool dependent_false = false;
+
+        // Возвращает true, если целое value представимо типом To
+        template <typename To, typename From>
+        constexpr bool InRange(From value) {
+            if constexpr (std::is_signed_v<From> == std::is_signed_v<To>) {
+                return value >= std::numeric_limits<To>::min() && value <= std::numeric_limits<To>::max();
+            }
+            else if constexpr (std::is_signed_v<From>) {
+                return value >= 0 && static_cast<std::make_unsigned_t<From>>(value) <= std::numeric_limits<To>::max();
+            }
+            else {
+                return value <= static_cast<std::make_unsigned_t<To>>(std::numeric_limits<To>::max());
+            }
+        }
+
+        // Преобразует аргумент Mython value в значение параметра типа T функции C++
+        template <typename T>
+        decltype(auto) Unbox(const ObjectHolder& value, const NativeFunction& function, size_t index) {
+            using Value = std::remove_cv_t<std::remove_reference_t<T>>;
+            if constexpr (std::is_same_v<Value, ObjectHolder>) {
+                return (value);
+            }
+            else if constexpr (std::is_same_v<Value, bool>) {
+                const auto *boolean = value.TryAs<Bool>();
+                if (!boolean) {
+                    ThrowArgumentError(function, index, "a bool");
+                }
+                return boolean->GetValue();
+            }
+            else if constexpr (std::is_integral_v<Value>) {
+                const auto *number = value.TryAs<Number>();
+                if (!number || !InRange<Value>(number->GetValue())) {
+                    ThrowArgumentError(function, index, "an integer");
+                }
+                return static_cast<Value>(number->GetValue());
+            }
+            else if constexpr (std::is_same_v<Value, std::string> || std::is_same_v<Value, std::string_view>) {
+                const auto *str = value.TryAs<String>();
+                if (!str) {
+                    ThrowArgumentError(function, index, "a string");
+                }
+                if constexpr (std::is_same_v<Value, std::string_view>) {
+                    return str->GetView();
+                }
+                else {
+                    return (str->GetValue());
+                }
+            }
+            else if constexpr (std::is_pointer_v<Value>
+                               && std::is_base_of_v<Object, std::remove_cv_t<std::remove_pointer_t<Value>>>) {
+                // None передаётся как nullptr
+                auto *object = value.TryAs<std::remove_cv_t<std::remove_pointer_t<Value>>>();
+                if (value && !object) {
+                    ThrowArgumentError(function, index, "an object of another type");
+                }
+                return object;
+            }
+            else if constexpr (std::is_base_of_v<Object, Value>) {
+                auto *object = value.TryAs<Value>();
+                if (!object) {
+                    ThrowArgumentError(function, index, "an object of another type");
+                }
+                return (*object);
+            }
+            else {
+                static_assert(dependent_false<T>, "unsupported parameter type of a native function");
+            }
+        }
+
+        // Упаковывает результат функции C++ в значение Mython
+        template <typename R>
+        ObjectHolder Box(R&& result, const NativeFunction& function) {
+            using Value = std::remove_cv_t<std::remove_reference_t<R>>;
+            if constexpr (std::is_same_v<Value, ObjectHolder>) {
+                return std::forward<R>(result);
+            }
+            else if constexpr (std::is_same_v<Value, bool>) {
+                return ObjectHolder::Own(Bool{result});
+            }
+            else if constexpr (std::is_integral_v<Value>) {
+                if (!InRange<int64_t>(result)) {
+                    ThrowResultError(function);
+                }
+                return ObjectHolder::Own(Number{static_cast<int64_t>(result)});
+            }
+            else if constexpr (std::is_same_v<Value, BigInt>) {
+                return MakeInteger(std::forward<R>(result));
+            }
+            else if constexpr (std::is_convertible_v<R, std::string_view>) {
+                return ObjectHolder::Own(String{std::string(std::string_view(result))});
+            }
+            else if constexpr (std::is_base_of_v<Object, Value>) {
+                return ObjectHolder::Own(Value(std::forward<R>(result)));
+            }
+            else {
+                static_assert(dependent_false<R>, "unsupported result type of a native function");
+            }
+        }
+
+        template <typename Fn>
+        Fn LoadTarget(const NativeFunction& function) {
+            Fn fn;
+            std::memcpy(&fn, function.target, sizeof(Fn));
+            return fn;
+        }
+
+        template <typename Fn>
+        void StoreTarget(NativeFunction& function, Fn fn) {
+            static_assert(std::is_trivially_copyable_v<Fn> && sizeof(Fn) <= sizeof(function.target),
+                          "native function pointer doesn't fit into NativeFunction::target");
+            std::memcpy(function.target, &fn, sizeof(Fn));
+        }
+
+        template <typename R, typename... Args, size_t... I>
+        ObjectHolder InvokeFunction(const NativeFunction& function, ObjectHolder* args, std::index_sequence<I...>) {
+            auto fn = LoadTarget<R (*)(Args...)>(function);
+            if constexpr (std::is_void_v<R>) {
+                fn(Unbox<Args>(args[I], function, I)...);
+                return ObjectHolder::None();
+            }
+            else {
+                return Box(fn(Unbox<Args>(args[I], function, I)...), function);
+            }
+        }
+
+        template <typename R, typename... Args>
+        ObjectHolder FunctionInvoker(const NativeFunction& function, Object* /*self*/, ObjectHolder* args,
+                                     Context& /*context*/) {
+            return InvokeFunction<R, Args...>(function, args, std::index_sequence_for<Args...>{});
+        }
+
+        template <typename T, typename Method, typename R, typename... Args, size_t... I>
+        ObjectHolder InvokeMethod(const NativeFunction& function, T& self, ObjectHolder* args,
+                                  std::index_sequence<I...>) {
+            auto method = LoadTarget<Method>(function);
+            if constexpr (std::is_void_v<R>) {
+                (self.*method)(Unbox<Args>(args[I], function, I)...);
+                return ObjectHolder::None();
+            }
+            else {
+                return Box((self.*method)(Unbox<Args>(args[I], function, I)...), function);
+            }
+        }
+
+        // Self - класс, в таблицу которого добавлен метод; Method может быть методом его базового класса
+        template <typename Self, typename Method, typename R, typename... Args>
+        ObjectHolder MethodInvoker(const NativeFunction& function, Object* self, ObjectHolder* args,
+                                   Context& /*context*/) {
+            return InvokeMethod<Self, Method, R, Args...>(function, static_cast<Self&>(*self), args,
+                                                          std::index_sequence_for<Args...>{});
+        }
+
+        template <typename Self, typename Method>
+        struct MethodTraits;
+
+        template <typename Self, typename C, typename R, typename... Args>
+        struct MethodTraits<Self, R (C::*)(Args...)> {
+            static constexpr size_t ARITY = sizeof...(Args);
+            static constexpr NativeFunction::Invoker INVOKER = MethodInvoker<Self, R (C::*)(Args...), R, Args...>;
+        };
+
+        template <typename Self, typename C, typename R, typename... Args>
+        struct MethodTraits<Self, R (C::*)(Args...) const> {
+            static constexpr size_t ARITY = sizeof...(Args);
+            static constexpr NativeFunction::Invoker INVOKER =
+                    MethodInvoker<Self, R (C::*)(Args...) const, R, Args...>;
+        };
+
+        template <typename T, typename... Args>
+        T Construct(Args... args) {
+            return T(std::move(args)...);
+        }
+
+    }  // namespace native_detail
+
+/*
+Набор функций и классов C++, которые программа на Mython может вызывать по имени.
+Модуль передаётся парсеру (ParseProgram), и вызов name(args) зарегистрированной функции
+компилируется в узел, вызывающий функцию C++ напрямую.
+
+Параметры функций могут иметь типы bool, целочисленные типы, std::string, std::string_view,
+ObjectHolder, ссылки и указатели на наследников Object (None передаётся как nullptr).
+Результат может иметь тип void (None), bool, целочисленный тип, BigInt, строку, ObjectHolder
+или наследника Object, который перемещается в новый объект Mython.
+Аргумент неподходящего типа приводит к исключению runtime_error.
+
+runtime::Module module;
+module.Def("gcd", &Gcd);
+module.Class<Counter>("Counter")
+    .Init<int64_t>()
+    .Def("add", &Counter::Add)
+    .Def("get", &Counter::Get);
+*/
+    class Module {
+    public:
+        // Привязывает методы класса T (наследника NativeObject) к его таблице NativeClass::Of<T>()
+        template <typename T>
+        class ClassBinder {
+        public:
+            ClassBinder(Module& module, std::string name)
+                    : module_(module)
+                    , name_(std::move(name)) {
+                NativeClass::Of<T>().SetName(name_);
+            }
+
+            // Регистрирует конструктор: вызов Name(args) создаёт объект T(args)
+            template <typename... Args>
+            ClassBinder& Init() {
+                module_.Def(name_, &native_detail::Construct<T, Args...>);
+                return *this;
+            }
+
+            template <typename Method>
+            ClassBinder& Def(std::string name, Method method) {
+                using Traits = native_detail::MethodTraits<T, Method>;
+                NativeFunction function;
+                function.name = name_ + "." + name;
+                function.arity = Traits::ARITY;
+                function.invoke = Traits::INVOKER;
+                native_detail::StoreTarget(function, method);
+                NativeClass::Of<T>().AddMethod(std::move(function));
+                return *this;
+            }
+
+        private:
+            Module& module_;
+            std::string name_;
+        };
+
+        template <typename R, typename... Args>
+        Module& Def(std::string name, R (*fn)(Args...)) {
+            NativeFunction function;
+            function.name = name;
+            function.arity = sizeof...(Args);
+            function.invoke = native_detail::FunctionInvoker<R, Args...>;
+            native_detail::StoreTarget(function, fn);
+            functions_[std::move(name)] = std::move(function);
+            return *this;
+        }
+
+        template <typename T>
+        ClassBinder<T> Class(std::string name) {
+            static_assert(std::is_base_of_v<NativeObject, T>, "native classes must derive from NativeObject");
+            return {*this, std::move(name)};
+        }
+
+        // Возвращает функцию с именем name или nullptr. Адрес функции не меняется
+        // при регистрации других функций
+        [[nodiscard]] const NativeFunction* FindFunction(const std::string& name) const;
+
+    private:
+        std::unordered_map<std::string, NativeFunction> functions_;
+    };
+
+}  // namespace runtime
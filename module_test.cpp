@@ -0,0 +1,155 @@
+#include "module.h"
+#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        int64_t Gcd(int64_t a, int64_t b) {
+            while (b != 0) {
+                a = exchange(b, a % b);
+            }
+            return a;
+        }
+
+        string Repeat(string_view text, int count) {
+            string result;
+            for (int i = 0; i < count; ++i) {
+                result += text;
+            }
+            return result;
+        }
+
+        bool IsEmpty(const ObjectHolder& value) {
+            return !value;
+        }
+
+        int64_t ListSize(List& list) {
+            return static_cast<int64_t>(list.Size());
+        }
+
+        class Counter : public Native<Counter> {
+        public:
+            explicit Counter(int64_t start)
+                    : value_(start) {
+            }
+
+            void Add(int64_t delta) {
+                value_ += delta;
+            }
+
+            [[nodiscard]] int64_t Get() const {
+                return value_;
+            }
+
+            Counter Copy() const {
+                return *this;
+            }
+
+            bool Same(const Counter* other) const {
+                return other == this;
+            }
+
+        private:
+            int64_t value_;
+        };
+
+        Module MakeModule() {
+            Module module;
+            module.Def("gcd", &Gcd)
+                    .Def("repeat", &Repeat)
+                    .Def("is_empty", &IsEmpty)
+                    .Def("list_size", &ListSize);
+            module.Class<Counter>("Counter")
+                    .Init<int64_t>()
+                    .Def("add", &Counter::Add)
+                    .Def("get", &Counter::Get)
+                    .Def("copy", &Counter::Copy)
+                    .Def("same", &Counter::Same);
+            return module;
+        }
+
+        string Run(const string& program, const Module& module) {
+            istringstream input(program);
+            parse::Lexer lexer(input);
+            auto tree = ParseProgram(lexer, module);
+            ostringstream output;
+            SimpleContext context{output};
+            Closure closure;
+            tree->Execute(closure, context);
+            return output.str();
+        }
+
+        void TestNativeFunctions() {
+            const Module module = MakeModule();
+            ASSERT(module.FindFunction("gcd"s) != nullptr);
+            ASSERT(module.FindFunction("lcm"s) == nullptr);
+
+            DummyContext context;
+            ObjectHolder args[] = {ObjectHolder::Own(Number{12}), ObjectHolder::Own(Number{18})};
+            ASSERT_EQUAL(module.FindFunction("gcd"s)->Call(nullptr, args, 2, context).TryAs<Number>()->GetValue(), 6);
+            ASSERT_THROWS(module.FindFunction("gcd"s)->Call(nullptr, args, 1, context), runtime_error);
+
+            ASSERT_EQUAL(Run("print gcd(84, 36), repeat('ab', 3), is_empty(None), is_empty(1)\n"
+                             "print list_size([1, 2, 3])\n"
+                             "gcd(1, 2)\n", module),
+                         "12 ababab True False\n3\n"s);
+
+            for (const char *program : {"print gcd('a', 1)\n", "print gcd(1)\n", "print repeat('a', 10000000000)\n",
+                                        "print list_size(1)\n"}) {
+                ASSERT_THROWS(Run(program, module), runtime_error);
+            }
+            // Без модуля имена функций C++ неизвестны парсеру
+            istringstream input("print gcd(1, 2)\n");
+            parse::Lexer lexer(input);
+            ASSERT_THROWS(ParseProgram(lexer), ParseError);
+        }
+
+        void TestNativeClasses() {
+            const Module module = MakeModule();
+            ASSERT_EQUAL(NativeClass::Of<Counter>().GetName(), "Counter"s);
+            ASSERT(NativeClass::Of<Counter>().GetMethod("add"s) != nullptr);
+            ASSERT(NativeClass::Of<Counter>().GetMethod("reset"s) == nullptr);
+
+            ASSERT_EQUAL(Run(R"(
+class Wrapper:
+  def __init__(counter):
+    self.counter = counter
+
+  def bump():
+    self.counter.add(10)
+    return self.counter.get()
+
+c = Counter(5)
+c.add(2)
+d = c.copy()
+d.add(1)
+w = Wrapper(c)
+print c.get(), d.get(), w.bump(), c.same(c), c.same(d), c.same(None)
+for i in range(3):
+  c.add(i)
+print c.get()
+)", module),
+                         "7 8 17 True False False\n20\n"s);
+
+            for (const char *program : {"c = Counter(1)\nc.reset()\n", "c = Counter(1)\nc.add()\n",
+                                        "c = Counter(1)\nprint c.same(1)\n", "c = Counter('a')\n"}) {
+                ASSERT_THROWS(Run(program, module), runtime_error);
+            }
+        }
+
+    }  // namespace
+
+    void RunModuleTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestNativeFunctions);
+        RUN_TEST(tr, runtime::TestNativeClasses);
+    }
+
+}  // namespace runtime
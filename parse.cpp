@@ -3,6 +3,8 @@
 #include "lexer.h"
 #include "statement.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace TokenType = parse::token_type;
@@ -17,10 +19,36 @@ namespace {
         return !(token == c);
     }
 
+    // Возвращает true, если выражение заведомо вычисляется в строку
+    bool IsStringExpression(const ast::Statement& expression) {
+        return dynamic_cast<const ast::StringConst*>(&expression) != nullptr
+               || dynamic_cast<const ast::Stringify*>(&expression) != nullptr
+               || dynamic_cast<const ast::Join*>(&expression) != nullptr
+               || dynamic_cast<const ast::Format*>(&expression) != nullptr
+               || dynamic_cast<const ast::Concat*>(&expression) != nullptr;
+    }
+
+    // Цепочку сложений с хотя бы двумя знаками + и строковым операндом превращает в один узел Concat,
+    // остальные - во вложенные узлы Add
+    unique_ptr<ast::Statement> MakeSum(vector<unique_ptr<ast::Statement>> operands) {
+        if (operands.size() > 2 && any_of(operands.begin(), operands.end(), [](const auto& operand) {
+                return IsStringExpression(*operand);
+            })) {
+            return make_unique<ast::Concat>(std::move(operands));
+        }
+        unique_ptr<ast::Statement> result = std::move(operands.front());
+        for (size_t i = 1; i < operands.size(); ++i) {
+            result = make_unique<ast::Add>(std::move(result), std::move(operands[i]));
+        }
+        return result;
+    }
+
     class Parser {
     public:
-        explicit Parser(parse::Lexer& lexer)
-                : lexer_(lexer) {
+        // module - функции и классы C++, доступные программе, или nullptr
+        Parser(parse::Lexer& lexer, const runtime::Module* module)
+                : lexer_(lexer)
+                , module_(module) {
         }
 
         // Program -> eps
@@ -135,11 +163,25 @@ namespace {
         }
 
         //  AssgnOrCall -> DottedIds = Expr
+        //               | DottedIds '[' Expr ']' = Expr
         //               | DottedIds '(' ExprList ')'
+        //               | NativeFunction '(' ExprList ')'
+        //               | BuiltinFunction '(' ExprList ')'
+        //               | SpawnTask
         unique_ptr<ast::Statement> ParseAssignmentOrCall() {
             lexer_.Expect<TokenType::Id>();
 
             vector<string> id_list = ParseDottedIds();
+            if (IsSpawnTask(id_list)) {
+                return ParseSpawnTask();
+            }
+            if (lexer_.CurrentToken() == '[') {
+                auto index = ParseIndex();
+                lexer_.Expect<TokenType::Char>('=');
+                lexer_.NextToken();
+                return make_unique<ast::ItemAssignment>(make_unique<ast::VariableValue>(std::move(id_list)),
+                                                        std::move(index), ParseTest());
+            }
             string last_name = id_list.back();
             id_list.pop_back();
 
@@ -155,10 +197,6 @@ namespace {
             lexer_.Expect<TokenType::Char>('(');
             lexer_.NextToken();
 
-            if (id_list.empty()) {
-                throw ParseError("Mython doesn't support functions, only methods: "s + last_name);
-            }
-
             vector<unique_ptr<ast::Statement>> args;
             if (lexer_.CurrentToken() != ')') {
                 args = ParseTestList();
@@ -166,6 +204,16 @@ namespace {
             lexer_.Expect<TokenType::Char>(')');
             lexer_.NextToken();
 
+            if (id_list.empty()) {
+                if (const auto *native = FindNativeFunction(last_name)) {
+                    return make_unique<ast::NativeCall>(*native, std::move(args));
+                }
+                if (auto call = MakeBuiltinCall(last_name, std::move(args))) {
+                    return call;
+                }
+                throw ParseError("Mython doesn't support functions, only methods: "s + last_name);
+            }
+
             return make_unique<ast::MethodCall>(make_unique<ast::VariableValue>(std::move(id_list)),
                                                 std::move(last_name), std::move(args));
         }
@@ -179,7 +227,14 @@ namespace {
                 lexer_.NextToken();
 
                 if (op == '+') {
-                    result = make_unique<ast::Add>(std::move(result), ParseAdder());
+                    vector<unique_ptr<ast::Statement>> operands;
+                    operands.push_back(std::move(result));
+                    operands.push_back(ParseAdder());
+                    while (lexer_.CurrentToken() == '+') {
+                        lexer_.NextToken();
+                        operands.push_back(ParseAdder());
+                    }
+                    result = MakeSum(std::move(operands));
                 } else {
                     result = make_unique<ast::Sub>(std::move(result), ParseAdder());
                 }
@@ -204,15 +259,17 @@ namespace {
             return result;
         }
 
-        // Mult -> '(' Expr ')'
+        // Mult -> '(' Expr ')' Subscripts
+        //       | '[' [ExprList] ']' Subscripts
+        //       | '{' [Expr ':' Expr [',' Expr ':' Expr]*] '}' Subscripts
         //       | NUMBER
         //       | '-' Mult
         //       | STRING
         //       | NONE
         //       | TRUE
         //       | FALSE
-        //       | DottedIds '(' ExprList ')'
-        //       | DottedIds
+        //       | DottedIds '(' ExprList ')' Subscripts
+        //       | DottedIds Subscripts
         unique_ptr<ast::Statement> ParseMult()  // NOLINT
         {
             if (lexer_.CurrentToken() == '(') {
@@ -220,19 +277,52 @@ namespace {
                 auto result = ParseTest();
                 lexer_.Expect<TokenType::Char>(')');
                 lexer_.NextToken();
-                return result;
+                return ParseSubscripts(std::move(result));
+            }
+            if (lexer_.CurrentToken() == '[') {
+                vector<unique_ptr<ast::Statement>> items;
+                if (lexer_.NextToken() != ']') {
+                    items = ParseTestList();
+                }
+                lexer_.Expect<TokenType::Char>(']');
+                lexer_.NextToken();
+                return ParseSubscripts(make_unique<ast::NewList>(std::move(items)));
+            }
+            if (lexer_.CurrentToken() == '{') {
+                vector<unique_ptr<ast::Statement>> keys;
+                vector<unique_ptr<ast::Statement>> values;
+                if (lexer_.NextToken() != '}') {
+                    for (;;) {
+                        keys.push_back(ParseTest());
+                        lexer_.Expect<TokenType::Char>(':');
+                        lexer_.NextToken();
+                        values.push_back(ParseTest());
+                        if (lexer_.CurrentToken() != ',') {
+                            break;
+                        }
+                        lexer_.NextToken();
+                    }
+                }
+                lexer_.Expect<TokenType::Char>('}');
+                lexer_.NextToken();
+                return ParseSubscripts(make_unique<ast::NewDict>(std::move(keys), std::move(values)));
             }
             if (lexer_.CurrentToken() == '-') {
                 lexer_.NextToken();
                 return make_unique<ast::Mult>(ParseMult(), make_unique<ast::NumericConst>(-1));
             }
             if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::Number>()) {
-                int result = num->value;
+                int64_t result = num->value;
                 lexer_.NextToken();
                 return make_unique<ast::NumericConst>(result);
             }
+            if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::BigNumber>()) {
+                auto result = runtime::BigInt::FromString(num->value);
+                lexer_.NextToken();
+                return make_unique<ast::BigNumericConst>(std::move(result));
+            }
             if (const auto* str = lexer_.CurrentToken().TryAs<TokenType::String>()) {
-                string result = str->value;
+                auto result = runtime::String::Intern(str->value);
                 lexer_.NextToken();
                 return make_unique<ast::StringConst>(std::move(result));
             }
@@ -249,11 +339,156 @@ namespace {
                 return make_unique<ast::None>();
             }
 
-            return ParseDottedIdsInMultExpr();
+            return ParseSubscripts(ParseDottedIdsInMultExpr());
+        }
+
+        // '[' Expr ']'
+        unique_ptr<ast::Statement> ParseIndex() {
+            lexer_.Expect<TokenType::Char>('[');
+            lexer_.NextToken();
+            auto index = ParseTest();
+            lexer_.Expect<TokenType::Char>(']');
+            lexer_.NextToken();
+            return index;
+        }
+
+        // Subscripts -> ['[' Expr ']' | '[' [Expr] ':' [Expr] ']']*
+        unique_ptr<ast::Statement> ParseSubscripts(unique_ptr<ast::Statement> object) {
+            while (lexer_.CurrentToken() == '[') {
+                lexer_.NextToken();
+                unique_ptr<ast::Statement> start;
+                if (lexer_.CurrentToken() != ':') {
+                    start = ParseTest();
+                }
+                if (lexer_.CurrentToken() == ':') {
+                    unique_ptr<ast::Statement> stop;
+                    if (lexer_.NextToken() != ']') {
+                        stop = ParseTest();
+                    }
+                    object = make_unique<ast::Slice>(std::move(object), std::move(start), std::move(stop));
+                }
+                else {
+                    object = make_unique<ast::ItemValue>(std::move(object), std::move(start));
+                }
+                lexer_.Expect<TokenType::Char>(']');
+                lexer_.NextToken();
+            }
+            return object;
+        }
+
+        // Возвращает true, если разобранный идентификатор начинает выражение spawn obj.method(...)
+        bool IsSpawnTask(const vector<string>& names) {
+            return names.size() == 1 && names.front() == "spawn"sv && lexer_.CurrentToken().Is<TokenType::Id>();
+        }
+
+        // SpawnTask -> spawn DottedIds '.' id '(' ExprList ')'
+        unique_ptr<ast::Statement> ParseSpawnTask() {
+            vector<string> names = ParseDottedIds();
+            if (names.size() < 2 || lexer_.CurrentToken() != '(') {
+                throw ParseError("spawn expects a method call object.method(args)"s);
+            }
+            vector<unique_ptr<ast::Statement>> args;
+            if (lexer_.NextToken() != ')') {
+                args = ParseTestList();
+            }
+            lexer_.Expect<TokenType::Char>(')');
+            lexer_.NextToken();
+
+            string method_name = std::move(names.back());
+            names.pop_back();
+            return make_unique<ast::SpawnTask>(make_unique<ast::VariableValue>(std::move(names)),
+                                               std::move(method_name), std::move(args));
+        }
+
+        // Возвращает узел вызова встроенной функции name с аргументами args
+        // либо nullptr, если такой встроенной функции нет
+        unique_ptr<ast::Statement> MakeBuiltinCall(const string& name, vector<unique_ptr<ast::Statement>> args) {
+            if (name == "str"sv) {
+                if (args.size() != 1) {
+                    throw ParseError("Function str takes exactly one argument"s);
+                }
+                return make_unique<ast::Stringify>(std::move(args.front()));
+            }
+            if (name == "join"sv) {
+                if (args.empty()) {
+                    throw ParseError("Function join takes a future or a separator and items"s);
+                }
+                // С одним аргументом join дожидается задачи, запущенной spawn obj.method(...)
+                if (args.size() == 1) {
+                    return make_unique<ast::JoinTask>(std::move(args.front()));
+                }
+                return make_unique<ast::Join>(std::move(args));
+            }
+            if (name == "pmap"sv || name == "pfilter"sv) {
+                if (args.size() != 3 && args.size() != 4) {
+                    throw ParseError("Function "s + name + " takes an object, a method name, items and a grain"s);
+                }
+                return make_unique<ast::ParallelOperation>(
+                        name == "pmap"sv ? ast::ParallelOperation::Kind::kMap : ast::ParallelOperation::Kind::kFilter,
+                        std::move(args));
+            }
+            if (name == "preduce"sv) {
+                if (args.size() != 4 && args.size() != 5) {
+                    throw ParseError("Function preduce takes an object, a method name, items, "
+                                     "an initial value and a grain"s);
+                }
+                return make_unique<ast::ParallelOperation>(ast::ParallelOperation::Kind::kReduce, std::move(args));
+            }
+            if (name == "format"sv) {
+                if (args.empty()) {
+                    throw ParseError("Function format takes a format string and arguments"s);
+                }
+                return make_unique<ast::Format>(std::move(args));
+            }
+            if (name == "len"sv) {
+                if (args.size() != 1) {
+                    throw ParseError("Function len takes exactly one argument"s);
+                }
+                return make_unique<ast::Len>(std::move(args.front()));
+            }
+            if (name == "intarray"sv) {
+                if (args.size() != 1) {
+                    throw ParseError("Function intarray takes exactly one argument"s);
+                }
+                return make_unique<ast::NewIntArray>(std::move(args.front()));
+            }
+            if (name == "range"sv) {
+                if (args.empty() || args.size() > 3) {
+                    throw ParseError("Function range takes from one to three arguments"s);
+                }
+                return make_unique<ast::NewRange>(std::move(args));
+            }
+            if (name == "spawn"sv) {
+                const auto *cls = args.empty() ? nullptr : dynamic_cast<ast::VariableValue*>(args.front().get());
+                const auto it = cls && cls->GetDottedIds().size() == 1
+                                ? declared_classes_.find(cls->GetDottedIds().front()) : declared_classes_.end();
+                if (it == declared_classes_.end()) {
+                    throw ParseError("Function spawn takes a class name and constructor arguments"s);
+                }
+                args.erase(args.begin());
+                return make_unique<ast::Spawn>(static_cast<const runtime::Class&>(*it->second),  // NOLINT
+                                               std::move(args));
+            }
+            if (name == "send"sv) {
+                if (args.size() != 2) {
+                    throw ParseError("Function send takes an isolate and a message"s);
+                }
+                return make_unique<ast::Send>(std::move(args[0]), std::move(args[1]));
+            }
+            if (name == "recv"sv) {
+                if (!args.empty()) {
+                    throw ParseError("Function recv takes no arguments"s);
+                }
+                return make_unique<ast::Receive>();
+            }
+            return nullptr;
         }
 
         std::unique_ptr<ast::Statement> ParseDottedIdsInMultExpr() {
             vector<string> names = ParseDottedIds();
+            if (IsSpawnTask(names)) {
+                return ParseSpawnTask();
+            }
 
             if (lexer_.CurrentToken() == '(') {
                 // various calls
@@ -276,11 +511,12 @@ namespace {
                     return make_unique<ast::NewInstance>(
                             static_cast<const runtime::Class&>(*it->second), std::move(args));  // NOLINT
                 }
-                if (method_name == "str"sv) {
-                    if (args.size() != 1) {
-                        throw ParseError("Function str takes exactly one argument"s);
-                    }
-                    return make_unique<ast::Stringify>(std::move(args.front()));
+                // Функции модуля C++ имеют приоритет над встроенными функциями с тем же именем
+                if (const auto *native = FindNativeFunction(method_name)) {
+                    return make_unique<ast::NativeCall>(*native, std::move(args));
+                }
+                if (auto call = MakeBuiltinCall(method_name, std::move(args))) {
+                    return call;
                 }
                 throw ParseError("Unknown call to "s + method_name + "()"s);
             }
@@ -323,6 +559,40 @@ namespace {
                                             std::move(else_body));
         }
 
+        // Loop -> while LogicalExpr: Suite
+        unique_ptr<ast::Statement> ParseLoop()  // NOLINT
+        {
+            lexer_.Expect<TokenType::While>();
+            lexer_.NextToken();
+
+            auto condition = ParseTest();
+
+            lexer_.Expect<TokenType::Char>(':');
+            lexer_.NextToken();
+
+            auto body = ParseSuite();
+
+            return make_unique<ast::While>(std::move(condition), std::move(body));
+        }
+
+        // ForLoop -> for Id in LogicalExpr: Suite
+        unique_ptr<ast::Statement> ParseForLoop()  // NOLINT
+        {
+            lexer_.Expect<TokenType::For>();
+            string var_name = lexer_.ExpectNext<TokenType::Id>().value;
+            lexer_.ExpectNext<TokenType::In>();
+            lexer_.NextToken();
+
+            auto iterable = ParseTest();
+
+            lexer_.Expect<TokenType::Char>(':');
+            lexer_.NextToken();
+
+            auto body = ParseSuite();
+
+            return make_unique<ast::For>(std::move(var_name), std::move(iterable), std::move(body));
+        }
+
         // LogicalExpr -> AndTest [OR AndTest]
         // AndTest -> NotTest [AND NotTest]
         // NotTest -> [NOT] NotTest
@@ -399,6 +669,8 @@ namespace {
         // Statement -> SimpleStatement Newline
         //           | class ClassDefinition
         //           | if Condition
+        //           | while Loop
+        //           | for ForLoop
         unique_ptr<ast::Statement> ParseStatement()  // NOLINT
         {
             const auto& tok = lexer_.CurrentToken();
@@ -410,6 +682,12 @@ namespace {
             if (tok.Is<TokenType::If>()) {
                 return ParseCondition();
             }
+            if (tok.Is<TokenType::While>()) {
+                return ParseLoop();
+            }
+            if (tok.Is<TokenType::For>()) {
+                return ParseForLoop();
+            }
             auto result = ParseSimpleStatement();
             lexer_.Expect<TokenType::Newline>();
             lexer_.NextToken();
@@ -437,12 +715,22 @@ namespace {
             return ParseAssignmentOrCall();
         }
 
+        // Возвращает функцию C++ с именем name или nullptr
+        const runtime::NativeFunction* FindNativeFunction(const string& name) const {
+            return module_ ? module_->FindFunction(name) : nullptr;
+        }
+
         parse::Lexer& lexer_;
+        const runtime::Module* module_;
         runtime::Closure declared_classes_;
     };
 
 }  // namespace
 
 unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer) {
-    return Parser{lexer}.ParseProgram();
+    return Parser{lexer, nullptr}.ParseProgram();
+}
+
+unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer, const runtime::Module& module) {
+    return Parser{lexer, &module}.ParseProgram();
 }
\ No newline at end of file
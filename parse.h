@@ -9,10 +9,14 @@ namespace parse {
 
 namespace runtime {
     class Executable;
+    class Module;
 }
 
 struct ParseError : std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
-std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
\ No newline at end of file
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
+// Разбирает программу, которой доступны функции и классы C++ из module.
+// Модуль должен существовать, пока выполняется программа
+std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer, const runtime::Module& module);
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "program.h"
+
+#include "bytecode.h"
+#include "lexer.h"
+#include "parse.h"
+#include "superinstructions.h"
+#include "tail_calls.h"
+
+using namespace std;
+
+namespace mython {
+
+    namespace {
+
+        // Константы программы выдаются невладеющими ссылками: программа живёт дольше результатов
+        // своего выполнения, а потоки и изоляты, выполняющие её, не конкурируют за счётчики ссылок
+        void FreezeConstants(runtime::Executable& node) {
+            if (auto *number = dynamic_cast<ast::NumericConst*>(&node)) {
+                number->Freeze();
+            }
+            else if (auto *big = dynamic_cast<ast::BigNumericConst*>(&node)) {
+                big->Freeze();
+            }
+            else if (auto *str = dynamic_cast<ast::StringConst*>(&node)) {
+                str->Freeze();
+            }
+            else if (auto *boolean = dynamic_cast<ast::BoolConst*>(&node)) {
+                boolean->Freeze();
+            }
+            else if (auto *compiled = dynamic_cast<bytecode::CompiledExpression*>(&node)) {
+                compiled->FreezeConstants();
+            }
+            node.ForEachChild([](unique_ptr<runtime::Executable>& child) {
+                FreezeConstants(*child);
+            });
+        }
+
+        unique_ptr<runtime::Executable> Optimize(unique_ptr<runtime::Executable> tree) {
+            ast::EliminateTailCalls(tree);
+            ast::FuseSuperinstructions(tree);
+            bytecode::CompileExpressions(tree);
+            FreezeConstants(*tree);
+            return tree;
+        }
+
+    }  // namespace
+
+    Program::Program(istream& input) {
+        parse::Lexer lexer(input);
+        tree_ = Optimize(ParseProgram(lexer));
+    }
+
+    Program::Program(istream& input, const runtime::Module& module) {
+        parse::Lexer lexer(input);
+        tree_ = Optimize(ParseProgram(lexer, module));
+    }
+
+    runtime::ObjectHolder Program::Execute(runtime::Closure& closure, runtime::Context& context) const {
+        runtime::ObjectHolder result = tree_->Execute(closure, context);
+        runtime::CallStack &stack = context.GetCallStack();
+        return stack.IsReturning() ? stack.TakeReturnValue() : result;
+    }
+
+}  // namespace mython
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <iosfwd>
+#include <memory>
+
+namespace runtime {
+    class Module;
+}
+
+namespace mython {
+
+/*
+Программа Mython, разобранная и оптимизированная один раз (устранение хвостовых вызовов,
+суперинструкции, байткод выражений).
+После компиляции программа не изменяется: узлы дерева меняют только свои атомарные подсказки
+специализации (см. ast::SpecializationState). Поэтому один объект Program можно выполнять
+одновременно в нескольких потоках без блокировок, если у каждого выполнения свои Closure и Context.
+Значения, созданные одним выполнением, не предназначены для одновременного использования
+из других потоков.
+Program должна существовать, пока используются полученные при её выполнении значения:
+классы, их методы и константы принадлежат программе (константы выдаются невладеющими ссылками,
+чтобы потоки не конкурировали за их счётчики ссылок).
+Для программ, создающих изоляты (spawn, send, recv), выполнение ведётся в контексте
+runtime::IsolatePool::GetMainContext() (см. isolate.h)
+*/
+    class Program {
+    public:
+        // Компилирует программу из input. Выбрасывает ParseError при синтаксической ошибке
+        explicit Program(std::istream& input);
+        // Компилирует программу, которой доступны функции и классы C++ из module.
+        // Модуль должен существовать, пока существует программа
+        Program(std::istream& input, const runtime::Module& module);
+
+        // Выполняет программу над переменными closure в контексте context.
+        // Инструкция return вне метода завершает программу, её результат возвращается.
+        // Безопасно вызывается одновременно из разных потоков
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) const;
+
+    private:
+        std::unique_ptr<runtime::Executable> tree_;
+    };
+
+}  // namespace mython
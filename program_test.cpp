@@ -0,0 +1,111 @@
+#include "parse.h"
+#include "program.h"
+#include "test_runner_p.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace mython {
+
+    namespace {
+
+        // Места вызовов и операции видят в разных потоках разные типы,
+        // поэтому их специализации переключаются одновременно из нескольких потоков
+        const string POLYMORPHIC_PROGRAM = R"(
+class Shape:
+  def area():
+    return 0
+
+  def describe(n):
+    return self.name() + ' #' + str(n) + ': ' + str(self.area())
+
+class Square(Shape):
+  def __init__(side):
+    self.side = side
+
+  def name():
+    return 'square'
+
+  def area():
+    return self.side * self.side
+
+class Circle(Shape):
+  def __init__(r):
+    self.r = r
+
+  def name():
+    return 'circle'
+
+  def area():
+    return 3 * self.r * self.r
+
+shapes = [Square(seed), Circle(seed), Square(seed + 1)]
+total = 0
+text = ''
+for i in range(20):
+  for shape in shapes:
+    total = total + shape.area()
+    text = shape.describe(i)
+print seed, total, text
+)";
+
+        string Run(const Program& program, int seed) {
+            ostringstream output;
+            runtime::SimpleContext context{output};
+            runtime::Closure closure;
+            closure["seed"s] = runtime::ObjectHolder::Own(runtime::Number{seed});
+            program.Execute(closure, context);
+            return output.str();
+        }
+
+        void TestExecuteManyTimes() {
+            istringstream input(POLYMORPHIC_PROGRAM);
+            const Program program{input};
+            const string first = Run(program, 2);
+            ASSERT_EQUAL(first, "2 500 square #19: 9\n"s);
+            for (int i = 0; i < 3; ++i) {
+                ASSERT_EQUAL(Run(program, 2), first);
+            }
+            ASSERT_EQUAL(Run(program, 1), "1 160 square #19: 4\n"s);
+
+            istringstream broken("f(1)\n");
+            ASSERT_THROWS(Program{broken}, ParseError);
+        }
+
+        void TestConcurrentExecution() {
+            istringstream input(POLYMORPHIC_PROGRAM);
+            const Program program{input};
+            constexpr int THREADS = 8;
+            constexpr int RUNS = 50;
+            vector<string> expected;
+            for (int seed = 0; seed < THREADS; ++seed) {
+                expected.push_back(Run(program, seed));
+            }
+
+            vector<int> mismatches(THREADS, 0);
+            vector<thread> workers;
+            for (int seed = 0; seed < THREADS; ++seed) {
+                workers.emplace_back([&, seed] {
+                    for (int run = 0; run < RUNS; ++run) {
+                        if (Run(program, seed) != expected[seed]) {
+                            ++mismatches[seed];
+                        }
+                    }
+                });
+            }
+            for (thread &worker : workers) {
+                worker.join();
+            }
+            ASSERT_EQUAL(mismatches, vector<int>(THREADS, 0));
+        }
+
+    }  // namespace
+
+    void RunProgramTests(TestRunner& tr) {
+        RUN_TEST(tr, mython::TestExecuteManyTimes);
+        RUN_TEST(tr, mython::TestConcurrentExecution);
+    }
+
+}  // namespace mython
@@ -1,9 +1,52 @@
 #include "runtime.h"
 
+#include "dict.h"
+#include "intarray.h"
+#include "module.h"
+#include "tasks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <iterator>
+#include <mutex>
+
 using namespace std;
 
 namespace runtime {
 
+    namespace {
+
+        bool IsInteger(const ObjectHolder& object) {
+            return object.TryAs<Number>() || object.TryAs<BigNumber>();
+        }
+
+        // Требует IsInteger(object) == true
+        BigInt ToBigInt(const ObjectHolder& object) {
+            if (const auto *number = object.TryAs<Number>()) {
+                return number->GetValue();
+            }
+            return object.TryAs<BigNumber>()->GetValue();
+        }
+
+        // Вычисляет целочисленную операцию: сначала в int64_t через checked, а при переполнении
+        // или операнде BigNumber - через wide в BigInt. Если операнды не целые, возвращает None
+        template <typename Checked, typename Wide>
+        ObjectHolder IntegerArithmetic(const ObjectHolder& lhs, const ObjectHolder& rhs, Checked checked, Wide wide) {
+            const auto *lhs_number = lhs.TryAs<Number>();
+            const auto *rhs_number = rhs.TryAs<Number>();
+            int64_t result = 0;
+            if (lhs_number && rhs_number && checked(lhs_number->GetValue(), rhs_number->GetValue(), result)) {
+                return ObjectHolder::Own(Number{result});
+            }
+            if (IsInteger(lhs) && IsInteger(rhs)) {
+                return MakeInteger(wide(ToBigInt(lhs), ToBigInt(rhs)));
+            }
+            return ObjectHolder::None();
+        }
+
+    }  // namespace
+
     ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
             : data_(std::move(data)) {
     }
@@ -13,8 +56,9 @@ namespace runtime {
     }
 
     ObjectHolder ObjectHolder::Share(Object& object) {
-        // Возвращаем невладеющий shared_ptr (его deleter ничего не делает)
-        return ObjectHolder(std::shared_ptr<Object>(&object, [](auto* /*p*/) { /* do nothing */ }));
+        // Невладеющий shared_ptr: конструктор-псевдоним с пустым владельцем
+        // не создаёт блок управления и не обращается к куче
+        return ObjectHolder(std::shared_ptr<Object>(std::shared_ptr<Object>(), &object));
     }
 
     ObjectHolder ObjectHolder::None() {
@@ -35,6 +79,10 @@ namespace runtime {
         return data_.get();
     }
 
+    long ObjectHolder::UseCount() const {
+        return data_.use_count();
+    }
+
     ObjectHolder::operator bool() const {
         return Get() != nullptr;
     }
@@ -47,13 +95,92 @@ namespace runtime {
             return object.TryAs<Number>()->GetValue();
         }
         else if (object.TryAs<String>()) {
-            return !object.TryAs<String>()->GetValue().empty();
+            return object.TryAs<String>()->Size() != 0;
+        }
+        else if (object.TryAs<BigNumber>()) {
+            return !object.TryAs<BigNumber>()->GetValue().IsZero();
+        }
+        else if (object.TryAs<List>()) {
+            return object.TryAs<List>()->Size() != 0;
+        }
+        else if (object.TryAs<Dict>()) {
+            return object.TryAs<Dict>()->Size() != 0;
+        }
+        else if (object.TryAs<IntArray>()) {
+            return object.TryAs<IntArray>()->Size() != 0;
         }
         else {
             return false;
         }
     }
 
+    CallStack::CallStack(size_t max_depth, size_t native_stack_budget)
+            : max_depth_(max_depth)
+            , native_stack_budget_(native_stack_budget) {
+    }
+
+    void CallStack::SetMaxDepth(size_t max_depth) {
+        max_depth_ = max_depth;
+    }
+
+    void CallStack::SetNativeStackBudget(size_t bytes) {
+        native_stack_budget_ = bytes;
+    }
+
+    Closure& CallStack::Push() {
+        // Адрес локальной переменной показывает, насколько глубоко в стеке C++ выполняется вызов
+        char marker = 0;
+        const auto position = reinterpret_cast<uintptr_t>(&marker);
+        if (depth_ == 0) {
+            native_base_ = position;
+        }
+        const uintptr_t used = native_base_ > position ? native_base_ - position : position - native_base_;
+        if (depth_ >= max_depth_ || used > native_stack_budget_) {
+            throw runtime_error("maximum recursion depth exceeded");
+        }
+        if (depth_ == frames_.size()) {
+            frames_.emplace_back();
+        }
+        return frames_[depth_++];
+    }
+
+    void CallStack::Pop() {
+        // Кадр очищается сразу, чтобы не продлевать жизнь объектам, на которые ссылались
+        // локальные переменные. Память таблицы остаётся за кадром для следующего вызова
+        frames_[--depth_].clear();
+    }
+
+    void CallStack::AddPendingTask(ObjectHolder future) {
+        pending_tasks_.emplace_back(depth_, std::move(future));
+    }
+
+    std::vector<ObjectHolder> CallStack::TakePendingTasks(size_t depth) {
+        auto first = pending_tasks_.end();
+        while (first != pending_tasks_.begin() && std::prev(first)->first >= depth) {
+            --first;
+        }
+        std::vector<ObjectHolder> result;
+        result.reserve(static_cast<size_t>(pending_tasks_.end() - first));
+        for (auto it = first; it != pending_tasks_.end(); ++it) {
+            result.push_back(std::move(it->second));
+        }
+        pending_tasks_.erase(first, pending_tasks_.end());
+        return result;
+    }
+
+    CallStack::Frame::Frame(CallStack& stack)
+            : stack_(stack)
+            , locals_(stack.Push()) {
+    }
+
+    CallStack::Frame::~Frame() {
+        stack_.Pop();
+    }
+
+    bool Executable::EvaluateCondition(Closure& closure, Context& context) {
+        return IsTrue(Execute(closure, context));
+    }
+
     void ClassInstance::Print(std::ostream& os, Context& context) {
         if (HasMethod("__str__"s, 0)) {
             Call("__str__", {}, context)->Print(os, context);
@@ -81,11 +208,69 @@ namespace runtime {
         return closure_;
     }
 
+    Closure& ClassInstance::MutableFields() {
+        if (task_shares_.load(std::memory_order_acquire) != 0) {
+            throw runtime_error("cannot assign fields of an object used by a running task");
+        }
+        return closure_;
+    }
+
+    void ClassInstance::BeginTaskShare() {
+        task_shares_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ClassInstance::EndTaskShare() {
+        task_shares_.fetch_sub(1, std::memory_order_release);
+    }
+
     ClassInstance::ClassInstance(const Class& cls)
             : cls_ptr_(&cls)
     {
     }
 
+    ClassInstance::ClassInstance(const ClassInstance& other)
+            : cls_ptr_(other.cls_ptr_)
+            , closure_(other.closure_) {
+    }
+
+    ClassInstance::ClassInstance(ClassInstance&& other) noexcept
+            : cls_ptr_(other.cls_ptr_)
+            , closure_(std::move(other.closure_)) {
+    }
+
+    const Class& ClassInstance::GetClass() const {
+        return *cls_ptr_;
+    }
+
+    namespace {
+
+        // Выполняет тело метода в кадре на вершине стека вызовов. Задачи, запущенные в кадре
+        // (см. tasks.h), дожидаются перед выходом из него, в том числе при выходе по исключению
+        ObjectHolder ExecuteMethodBody(const Method& method, Closure& locals, Context& context) {
+            CallStack &stack = context.GetCallStack();
+            const size_t depth = stack.Depth();
+            try {
+                ObjectHolder result = method.body->Execute(locals, context);
+                if (stack.HasPendingTasks(depth)) {
+                    context.GetTaskPool()->JoinPending(depth, context);
+                }
+                return result;
+            }
+            catch (...) {
+                if (stack.HasPendingTasks(depth)) {
+                    try {
+                        context.GetTaskPool()->JoinPending(depth, context);
+                    }
+                    catch (...) {
+                        // Выполняющееся исключение важнее ошибок задач
+                    }
+                }
+                throw;
+            }
+        }
+
+    }  // namespace
+
     ObjectHolder ClassInstance::Call(const std::string& method,
                                      const std::vector<ObjectHolder>& actual_args,
                                      Context& context) {
@@ -93,14 +278,108 @@ namespace runtime {
         if (!method_body || method_body->formal_params.size() != actual_args.size()) {
             throw runtime_error("hasn't got this method");
         }
-        Closure method_closure;
+        return Call(*method_body, actual_args, context);
+    }
+
+    ObjectHolder ClassInstance::Call(const Method& method,
+                                     const std::vector<ObjectHolder>& actual_args,
+                                     Context& context) {
+        CallStack::Frame frame(context.GetCallStack());
+        Closure &method_closure = frame.Locals();
         method_closure["self"] = ObjectHolder::Share(*this);
-        auto it1 = method_body->formal_params.begin();
+        auto it1 = method.formal_params.begin();
         auto it2 = actual_args.begin();
-        for (;it1 != method_body->formal_params.end() && it2 != actual_args.end(); ++it1, ++it2) {
+        for (;it1 != method.formal_params.end() && it2 != actual_args.end(); ++it1, ++it2) {
             method_closure[*it1] = *it2;
         }
-        return method_body->body->Execute(method_closure, context);
+        return ExecuteMethodBody(method, method_closure, context);
+    }
+
+    ObjectHolder ClassInstance::Call(const Method& method, ObjectHolder* args, size_t argument_count,
+                                     Context& context) {
+        CallStack::Frame frame(context.GetCallStack());
+        Closure &method_closure = frame.Locals();
+        method_closure.emplace("self"s, ObjectHolder::Share(*this));
+        for (size_t i = 0; i < argument_count && i < method.formal_params.size(); ++i) {
+            method_closure.emplace(method.formal_params[i], std::move(args[i]));
+        }
+        return ExecuteMethodBody(method, method_closure, context);
+    }
+
+    ObjectHolder ClassInstance::Call(const Method& method, const ObjectHolder* args, size_t argument_count,
+                                     Context& context) {
+        CallStack::Frame frame(context.GetCallStack());
+        Closure &method_closure = frame.Locals();
+        method_closure.emplace("self"s, ObjectHolder::Share(*this));
+        for (size_t i = 0; i < argument_count && i < method.formal_params.size(); ++i) {
+            method_closure.emplace(method.formal_params[i], args[i]);
+        }
+        return ExecuteMethodBody(method, method_closure, context);
+    }
+
+    PreparedMethod::PreparedMethod(const Class& cls, std::string name, size_t argument_count)
+            : cls_(&cls)
+            , method_(cls.GetMethod(name))
+            , name_(std::move(name)) {
+        if (!method_ || method_->formal_params.size() != argument_count) {
+            throw runtime_error("Class "s + cls.GetName() + " hasn't got method "s + name_ + " with "s
+                                + to_string(argument_count) + " arguments"s);
+        }
+    }
+
+    const Class& PreparedMethod::GetClass() const {
+        return *cls_;
+    }
+
+    const Method& PreparedMethod::GetMethod() const {
+        return *method_;
+    }
+
+    size_t PreparedMethod::GetArgumentCount() const {
+        return method_->formal_params.size();
+    }
+
+    const Method& PreparedMethod::Resolve(const Class& cls) const {
+        if (&cls == cls_) {
+            return *method_;
+        }
+        const Method *method = cls.GetMethod(name_);
+        if (!method || method->formal_params.size() != method_->formal_params.size()) {
+            throw runtime_error("Class "s + cls.GetName() + " hasn't got method "s + name_);
+        }
+        return *method;
+    }
+
+    ObjectHolder PreparedMethod::Invoke(ClassInstance& self, const ObjectHolder* args, size_t argument_count,
+                                        Context& context) const {
+        if (argument_count != method_->formal_params.size()) {
+            throw runtime_error(name_ + "() takes "s + to_string(method_->formal_params.size())
+                                + " arguments, "s + to_string(argument_count) + " given"s);
+        }
+        return self.Call(Resolve(self.GetClass()), args, argument_count, context);
+    }
+
+    ObjectHolder PreparedMethod::Invoke(ClassInstance& self, std::initializer_list<ObjectHolder> args,
+                                        Context& context) const {
+        return Invoke(self, args.begin(), args.size(), context);
+    }
+
+    void PreparedMethod::InvokeBatch(ClassInstance* const* instances, size_t count, const ObjectHolder* args,
+                                     ObjectHolder* results, Context& context) const {
+        const size_t argument_count = method_->formal_params.size();
+        const Class *cls = cls_;
+        const Method *method = method_;
+        for (size_t i = 0; i < count; ++i) {
+            ClassInstance &self = *instances[i];
+            if (&self.GetClass() != cls) {
+                cls = &self.GetClass();
+                method = &Resolve(*cls);
+            }
+            ObjectHolder result = self.Call(*method, args + i * argument_count, argument_count, context);
+            if (results) {
+                results[i] = std::move(result);
+            }
+        }
     }
 
     Class::Class(std::string name, std::vector<Method> methods, const Class* parent)
@@ -126,6 +405,14 @@ namespace runtime {
         }
     }
 
+    void Class::ForEachMethod(const std::function<void(Method&)>& visitor) {
+        for (auto& [name, overloads] : methods_) {
+            for (auto& [params_count, method] : overloads) {
+                visitor(method);
+            }
+        }
+    }
+
     [[nodiscard]] const std::string& Class::GetName() const {
         return name_;
     }
@@ -135,6 +422,479 @@ namespace runtime {
         (void)context;
     }
 
+    // Узел верёвки: либо лист с частью строки, либо конкатенация left и right
+    // Неизменяемое хранилище символов строки
+    struct String::Data {
+        std::string value;
+        // Хеш значения; 0 означает, что хеш ещё не вычислен
+        mutable std::atomic<size_t> hash{0};
+
+        explicit Data(std::string v)
+                : value(std::move(v)) {
+        }
+    };
+
+    struct String::RopeNode {
+        Payload leaf;
+        std::shared_ptr<const RopeNode> left;
+        std::shared_ptr<const RopeNode> right;
+        size_t size = 0;
+
+        explicit RopeNode(Payload value)
+                : leaf(std::move(value))
+                , size(leaf->value.size()) {
+        }
+
+        RopeNode(std::shared_ptr<const RopeNode> lhs, std::shared_ptr<const RopeNode> rhs)
+                : left(std::move(lhs))
+                , right(std::move(rhs))
+                , size(left->size + right->size) {
+        }
+
+        RopeNode(const RopeNode&) = delete;
+        RopeNode& operator=(const RopeNode&) = delete;
+
+        // Цикл s = s + x строит цепочку узлов, глубина которой равна числу итераций,
+        // поэтому узлы, у которых не осталось других владельцев, освобождаются без рекурсии
+        ~RopeNode() {
+            std::vector<std::shared_ptr<const RopeNode>> pending;
+            pending.push_back(std::move(left));
+            pending.push_back(std::move(right));
+            while (!pending.empty()) {
+                std::shared_ptr<const RopeNode> node = std::move(pending.back());
+                pending.pop_back();
+                if (node && node.use_count() == 1) {
+                    auto &owned = const_cast<RopeNode&>(*node);
+                    pending.push_back(std::move(owned.left));
+                    pending.push_back(std::move(owned.right));
+                }
+            }
+        }
+    };
+
+    String::String(std::string value)
+            : value_(std::make_shared<const Data>(std::move(value))) {
+    }
+
+    String::String(const String& other)
+            : value_(other.value_)
+            , rope_(other.rope_)
+            , slice_offset_(other.slice_offset_)
+            , slice_size_(other.slice_size_)
+            , interned_(other.interned_)
+            , flat_(rope_ || HasSliceBounds() ? other.LoadFlat() : nullptr) {
+    }
+
+    String& String::operator=(const String& other) {
+        if (this != &other) {
+            *this = String{other};
+        }
+        return *this;
+    }
+
+    String::String(Payload value, bool interned)
+            : value_(std::move(value))
+            , interned_(interned) {
+    }
+
+    String String::Intern(std::string_view value) {
+        // Ключи ссылаются на символы хранящихся в пуле строк
+        static std::mutex mutex;
+        static std::unordered_map<std::string_view, Payload> pool;
+
+        std::lock_guard guard(mutex);
+        auto it = pool.find(value);
+        if (it == pool.end()) {
+            auto payload = std::make_shared<const Data>(std::string{value});
+            it = pool.emplace(payload->value, payload).first;
+        }
+        return {it->second, true};
+    }
+
+    String::String(Payload value, size_t slice_offset, size_t slice_size)
+            : value_(std::move(value))
+            , slice_offset_(slice_offset)
+            , slice_size_(slice_size) {
+    }
+
+    String::String(std::shared_ptr<const RopeNode> rope)
+            : rope_(std::move(rope)) {
+    }
+
+    std::shared_ptr<const String::RopeNode> String::AsRope() const {
+        if (rope_) {
+            return rope_;
+        }
+        // Лист верёвки - строка целиком, поэтому срез получает собственную копию символов
+        return std::make_shared<const RopeNode>(Flatten());
+    }
+
+    String String::Concat(const String& lhs, const String& rhs) {
+        if (lhs.Size() + rhs.Size() < ROPE_MIN_SIZE) {
+            const std::string_view lhs_view = lhs.GetView();
+            const std::string_view rhs_view = rhs.GetView();
+            std::string value;
+            value.reserve(lhs_view.size() + rhs_view.size());
+            value.append(lhs_view).append(rhs_view);
+            return String{std::move(value)};
+        }
+        return String{std::make_shared<const RopeNode>(lhs.AsRope(), rhs.AsRope())};
+    }
+
+    String::Payload String::LoadFlat() const {
+        return std::atomic_load_explicit(&flat_, std::memory_order_acquire);
+    }
+
+    String::Payload String::Flatten() const {
+        if (!rope_ && !HasSliceBounds()) {
+            return value_;
+        }
+        if (Payload flat = LoadFlat()) {
+            return flat;
+        }
+        std::string value;
+        if (rope_) {
+            value.reserve(rope_->size);
+            std::vector<const RopeNode*> stack = {rope_.get()};
+            while (!stack.empty()) {
+                const RopeNode *node = stack.back();
+                stack.pop_back();
+                if (node->left) {
+                    stack.push_back(node->right.get());
+                    stack.push_back(node->left.get());
+                }
+                else {
+                    value += node->leaf->value;
+                }
+            }
+        }
+        else {
+            value = GetView();
+        }
+        // Если значение одновременно собрал другой поток, используется его результат
+        Payload expected;
+        Payload flat = std::make_shared<const Data>(std::move(value));
+        if (!std::atomic_compare_exchange_strong_explicit(&flat_, &expected, flat, std::memory_order_acq_rel,
+                                                          std::memory_order_acquire)) {
+            return expected;
+        }
+        return flat;
+    }
+
+    const std::string& String::GetValue() const {
+        if (!rope_ && !HasSliceBounds()) {
+            return value_->value;
+        }
+        // Хранилище удерживается полем flat_ до уничтожения строки
+        return Flatten()->value;
+    }
+
+    std::string_view String::GetView() const {
+        if (rope_) {
+            return GetValue();
+        }
+        const std::string_view value = value_->value;
+        return HasSliceBounds() ? value.substr(slice_offset_, slice_size_) : value;
+    }
+
+    size_t String::Size() const {
+        if (rope_) {
+            return rope_->size;
+        }
+        return HasSliceBounds() ? slice_size_ : value_->value.size();
+    }
+
+    size_t String::Hash() const {
+        if (HasSliceBounds()) {
+            // Хеш в Data относится ко всей исходной строке, поэтому хеш среза не кешируется
+            const size_t hash = std::hash<std::string_view>{}(GetView());
+            return hash == 0 ? 1 : hash;
+        }
+        const Payload flat = Flatten();
+        size_t hash = flat->hash.load(std::memory_order_relaxed);
+        if (hash == 0) {
+            hash = std::hash<std::string_view>{}(flat->value);
+            // Значение 0 зарезервировано за невычисленным хешем
+            hash = hash == 0 ? 1 : hash;
+            flat->hash.store(hash, std::memory_order_relaxed);
+        }
+        return hash;
+    }
+
+    bool String::IsRope() const {
+        return rope_ != nullptr && !LoadFlat();
+    }
+
+    bool String::IsInterned() const {
+        return interned_;
+    }
+
+    bool String::IsSlice() const {
+        return HasSliceBounds() && !LoadFlat();
+    }
+
+    bool String::HasSliceBounds() const {
+        return slice_size_ != NOT_SLICE;
+    }
+
+    String String::Substr(size_t start, size_t length) const {
+        const size_t size = Size();
+        start = std::min(start, size);
+        length = std::min(length, size - start);
+        if (start == 0 && length == size) {
+            return *this;
+        }
+        // Верёвка собирается в одну строку, на которую будет ссылаться срез
+        const Payload parent = rope_ ? Flatten() : value_;
+        const size_t parent_size = parent->value.size();
+        const size_t offset = (HasSliceBounds() ? slice_offset_ : 0) + start;
+        if (parent_size >= SLICE_PIN_MIN_SIZE && length * SLICE_PIN_RATIO < parent_size) {
+            return String{parent->value.substr(offset, length)};
+        }
+        return {parent, offset, length};
+    }
+
+    size_t String::Find(std::string_view needle, size_t start) const {
+        return GetView().find(needle, start);
+    }
+
+    ObjectHolder String::Call(const std::string& method, ObjectHolder* args, size_t argument_count) {
+        if (method == "find"sv && (argument_count == 1 || argument_count == 2)) {
+            const auto *needle = args[0].TryAs<String>();
+            const auto *start = argument_count == 2 ? args[1].TryAs<Number>() : nullptr;
+            if (!needle || (argument_count == 2 && !start)) {
+                throw runtime_error("find expects a string and an optional integer start");
+            }
+            int64_t position = start ? start->GetValue() : 0;
+            if (position < 0) {
+                position = std::max<int64_t>(position + static_cast<int64_t>(Size()), 0);
+            }
+            const size_t found = Find(needle->GetView(), static_cast<size_t>(position));
+            return ObjectHolder::Own(Number{found == std::string::npos ? -1 : static_cast<int64_t>(found)});
+        }
+        throw runtime_error("string hasn't got method "s + method);
+    }
+
+    bool operator==(const String& lhs, const String& rhs) {
+        if (lhs.interned_ && rhs.interned_) {
+            return lhs.value_ == rhs.value_;
+        }
+        if (lhs.Size() != rhs.Size()) {
+            return false;
+        }
+        if (lhs.Hash() != rhs.Hash()) {
+            return false;
+        }
+        if (!lhs.rope_ && !rhs.rope_ && lhs.value_ == rhs.value_ && !lhs.HasSliceBounds()
+            && !rhs.HasSliceBounds()) {
+            return true;
+        }
+        return lhs.GetView() == rhs.GetView();
+    }
+
+    bool operator<(const String& lhs, const String& rhs) {
+        if (!lhs.rope_ && !rhs.rope_ && lhs.value_ == rhs.value_ && !lhs.HasSliceBounds()
+            && !rhs.HasSliceBounds()) {
+            return false;
+        }
+        return lhs.GetView() < rhs.GetView();
+    }
+
+    bool operator!=(const String& lhs, const String& rhs) {
+        return !(lhs == rhs);
+    }
+
+    void String::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << GetView();
+    }
+
+    void StringBuilder::Reserve(size_t part_count) {
+        parts_.reserve(part_count);
+    }
+
+    void StringBuilder::Append(std::string_view text) {
+        parts_.emplace_back().text = text;
+        size_ += text.size();
+    }
+
+    void StringBuilder::Append(const ObjectHolder& object, Context& context) {
+        if (!object) {
+            Append("None"sv);
+        }
+        else if (const auto *str = object.TryAs<String>()) {
+            Part &part = parts_.emplace_back();
+            part.holder = object;
+            part.text = str->GetView();
+            size_ += part.text.size();
+        }
+        else if (const auto *number = object.TryAs<Number>()) {
+            Part &part = parts_.emplace_back();
+            auto [end, error] = std::to_chars(std::begin(part.digits), std::end(part.digits), number->GetValue());
+            part.digits_size = static_cast<uint8_t>(end - part.digits);
+            size_ += part.digits_size;
+        }
+        else if (const auto *boolean = object.TryAs<Bool>()) {
+            Append(boolean->GetValue() ? "True"sv : "False"sv);
+        }
+        else {
+            Append(ToString(object, context), context);
+        }
+    }
+
+    size_t StringBuilder::Size() const {
+        return size_;
+    }
+
+    String StringBuilder::Build() {
+        std::string result;
+        result.reserve(size_);
+        for (const Part &part : parts_) {
+            if (part.digits_size > 0) {
+                result.append(part.digits, part.digits_size);
+            }
+            else {
+                result.append(part.text);
+            }
+        }
+        parts_.clear();
+        size_ = 0;
+        return String{std::move(result)};
+    }
+
+    Range::Range(int64_t start, int64_t stop, int64_t step)
+            : start_(start)
+            , stop_(stop)
+            , step_(step) {
+        if (step_ == 0) {
+            throw runtime_error("range step must not be zero");
+        }
+    }
+
+    void Range::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << "range("sv << start_ << ", "sv << stop_;
+        if (step_ != 1) {
+            os << ", "sv << step_;
+        }
+        os << ')';
+    }
+
+    int64_t Range::GetStart() const {
+        return start_;
+    }
+
+    int64_t Range::GetStop() const {
+        return stop_;
+    }
+
+    int64_t Range::GetStep() const {
+        return step_;
+    }
+
+    bool Range::Continues(int64_t value) const {
+        return step_ > 0 ? value < stop_ : value > stop_;
+    }
+
+    uint64_t Range::Size() const {
+        if (!Continues(start_)) {
+            return 0;
+        }
+        // Разности берутся в uint64_t: расстояние между границами может не помещаться в int64_t
+        const auto start = static_cast<uint64_t>(start_);
+        const auto stop = static_cast<uint64_t>(stop_);
+        const auto step = static_cast<uint64_t>(step_);
+        const uint64_t distance = step_ > 0 ? stop - start : start - stop;
+        const uint64_t stride = step_ > 0 ? step : 0 - step;
+        return (distance - 1) / stride + 1;
+    }
+
+    int64_t Range::At(uint64_t index) const {
+        // Произведение и сумма по модулю 2^64 дают элемент, который сам помещается в int64_t
+        return static_cast<int64_t>(static_cast<uint64_t>(start_) + index * static_cast<uint64_t>(step_));
+    }
+
+    List::List(std::vector<ObjectHolder> items)
+            : items_(std::move(items)) {
+    }
+
+    void List::Print(std::ostream& os, Context& context) {
+        os << '[';
+        bool first = true;
+        for (const auto &item : items_) {
+            if (!first) {
+                os << ", "sv;
+            }
+            first = false;
+            if (item) {
+                item->Print(os, context);
+            }
+            else {
+                os << "None"sv;
+            }
+        }
+        os << ']';
+    }
+
+    size_t List::Size() const {
+        return items_.size();
+    }
+
+    size_t List::Position(int64_t index) const {
+        const auto size = static_cast<int64_t>(items_.size());
+        const int64_t position = index < 0 ? index + size : index;
+        if (position < 0 || position >= size) {
+            throw runtime_error("list index out of range");
+        }
+        return static_cast<size_t>(position);
+    }
+
+    const ObjectHolder& List::At(int64_t index) const {
+        return items_[Position(index)];
+    }
+
+    void List::Set(int64_t index, ObjectHolder value) {
+        items_[Position(index)] = std::move(value);
+    }
+
+    void List::Append(ObjectHolder value) {
+        items_.push_back(std::move(value));
+    }
+
+    ObjectHolder List::Call(const std::string& method, ObjectHolder* args, size_t argument_count) {
+        if (method == "append"sv && argument_count == 1) {
+            Append(std::move(args[0]));
+            return ObjectHolder::None();
+        }
+        throw runtime_error("list hasn't got method "s + method);
+    }
+
+    const std::vector<ObjectHolder>& List::GetItems() const {
+        return items_;
+    }
+
+    std::optional<ObjectHolder> CallBuiltinMethod(const ObjectHolder& object, const std::string& method,
+                                                  ObjectHolder* args, size_t argument_count, Context& context) {
+        if (auto *list = object.TryAs<List>()) {
+            return list->Call(method, args, argument_count);
+        }
+        if (auto *dict = object.TryAs<Dict>()) {
+            return dict->Call(method, args, argument_count, context);
+        }
+        if (auto *str = object.TryAs<String>()) {
+            return str->Call(method, args, argument_count);
+        }
+        if (auto *native = object.TryAs<NativeObject>()) {
+            const NativeFunction *function = native->GetNativeClass().GetMethod(method);
+            if (!function) {
+                throw runtime_error(native->GetNativeClass().GetName() + " hasn't got method "s + method);
+            }
+            return function->Call(native, args, argument_count, context);
+        }
+        if (auto *array = object.TryAs<IntArray>()) {
+            return array->Call(method, args, argument_count);
+        }
+        return nullopt;
+    }
+
     void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
         os << (GetValue() ? "True"sv : "False"sv);
     }
@@ -147,11 +907,43 @@ namespace runtime {
             return lhs.TryAs<Bool>()->GetValue() == rhs.TryAs<Bool>()->GetValue();
         }
         else if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
-            return lhs.TryAs<String>()->GetValue() == rhs.TryAs<String>()->GetValue();
+            return *lhs.TryAs<String>() == *rhs.TryAs<String>();
         }
         else if (lhs.TryAs<Number>() && rhs.TryAs<Number>()) {
             return lhs.TryAs<Number>()->GetValue() == rhs.TryAs<Number>()->GetValue();
         }
+        else if (IsInteger(lhs) && IsInteger(rhs)) {
+            return ToBigInt(lhs) == ToBigInt(rhs);
+        }
+        else if (lhs.TryAs<List>() && rhs.TryAs<List>()) {
+            const auto &lhs_items = lhs.TryAs<List>()->GetItems();
+            const auto &rhs_items = rhs.TryAs<List>()->GetItems();
+            if (lhs_items.size() != rhs_items.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < lhs_items.size(); ++i) {
+                if (!Equal(lhs_items[i], rhs_items[i], context)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        else if (lhs.TryAs<Dict>() && rhs.TryAs<Dict>()) {
+            const auto *rhs_dict = rhs.TryAs<Dict>();
+            if (lhs.TryAs<Dict>()->Size() != rhs_dict->Size()) {
+                return false;
+            }
+            for (const auto &entry : lhs.TryAs<Dict>()->GetEntries()) {
+                const ObjectHolder *value = rhs_dict->Find(entry.key, context);
+                if (!value || !Equal(entry.value, *value, context)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        else if (lhs.TryAs<IntArray>() && rhs.TryAs<IntArray>()) {
+            return lhs.TryAs<IntArray>()->GetValues() == rhs.TryAs<IntArray>()->GetValues();
+        }
         else if (lhs.TryAs<ClassInstance>()) {
             return lhs.TryAs<ClassInstance>()->Call("__eq__"s, {rhs}, context).TryAs<Bool>()->GetValue();
         }
@@ -168,11 +960,14 @@ namespace runtime {
             return lhs.TryAs<Bool>()->GetValue() < rhs.TryAs<Bool>()->GetValue();
         }
         else if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
-            return lhs.TryAs<String>()->GetValue() < rhs.TryAs<String>()->GetValue();
+            return *lhs.TryAs<String>() < *rhs.TryAs<String>();
         }
         else if (lhs.TryAs<Number>() && rhs.TryAs<Number>()) {
             return lhs.TryAs<Number>()->GetValue() < rhs.TryAs<Number>()->GetValue();
         }
+        else if (IsInteger(lhs) && IsInteger(rhs)) {
+            return ToBigInt(lhs) < ToBigInt(rhs);
+        }
         else if (lhs.TryAs<ClassInstance>()) {
             return lhs.TryAs<ClassInstance>()->Call("__lt__"s, {rhs}, context).TryAs<Bool>()->GetValue();
         }
@@ -217,4 +1012,82 @@ namespace runtime {
         }
     }
 
+    ObjectHolder MakeInteger(BigInt value) {
+        if (value.FitsInt64()) {
+            return ObjectHolder::Own(Number{value.ToInt64()});
+        }
+        return ObjectHolder::Own(BigNumber{std::move(value)});
+    }
+
+    ObjectHolder ToString(const ObjectHolder& object, Context& context) {
+        static const ObjectHolder none_string = ObjectHolder::Own(String::Intern("None"sv));
+        static const ObjectHolder true_string = ObjectHolder::Own(String::Intern("True"sv));
+        static const ObjectHolder false_string = ObjectHolder::Own(String::Intern("False"sv));
+
+        if (!object) {
+            return none_string;
+        }
+        if (object.TryAs<String>()) {
+            return object;
+        }
+        if (const auto *number = object.TryAs<Number>()) {
+            char buffer[std::numeric_limits<int64_t>::digits10 + 3];
+            auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), number->GetValue());
+            return ObjectHolder::Own(String{std::string(buffer, end)});
+        }
+        if (const auto *boolean = object.TryAs<Bool>()) {
+            return boolean->GetValue() ? true_string : false_string;
+        }
+        if (const auto *big = object.TryAs<BigNumber>()) {
+            return ObjectHolder::Own(String{big->GetValue().ToString()});
+        }
+        if (auto *instance = object.TryAs<ClassInstance>(); instance && instance->HasMethod("__str__"s, 0)) {
+            return ToString(instance->Call("__str__"s, {}, context), context);
+        }
+        std::ostringstream buf;
+        object->Print(buf, context);
+        return ObjectHolder::Own(String{buf.str()});
+    }
+
+    ObjectHolder Add(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+        if (ObjectHolder result = IntegerArithmetic(lhs, rhs, CheckedAdd, std::plus<>{})) {
+            return result;
+        }
+        else if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
+            return ObjectHolder::Own(String::Concat(*lhs.TryAs<String>(), *rhs.TryAs<String>()));
+        }
+        else if (lhs.TryAs<ClassInstance>() && lhs.TryAs<ClassInstance>()->HasMethod("__add__"s, 1)) {
+            return lhs.TryAs<ClassInstance>()->Call("__add__"s, {rhs}, context);
+        }
+        else {
+            throw runtime_error("non-summable types");
+        }
+    }
+
+    ObjectHolder Sub(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        if (ObjectHolder result = IntegerArithmetic(lhs, rhs, CheckedSub, std::minus<>{})) {
+            return result;
+        }
+        else {
+            throw runtime_error("incorrect types for subtraction");
+        }
+    }
+
+    ObjectHolder Mult(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        if (ObjectHolder result = IntegerArithmetic(lhs, rhs, CheckedMult, std::multiplies<>{})) {
+            return result;
+        }
+        else {
+            throw runtime_error("incorrect types for multiplying");
+        }
+    }
+
+    ObjectHolder Div(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        if (!IsInteger(lhs) || !IsInteger(rhs)) {
+            throw runtime_error("incorrect types for division");
+        }
+        // BigInt::operator/ выбрасывает исключение при делении на ноль
+        return IntegerArithmetic(lhs, rhs, CheckedDiv, std::divides<>{});
+    }
+
 }  // namespace runtime
\ No newline at end of file
@@ -1,9 +1,19 @@
 #pragma once
 
+#include "bigint.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <map>
 #include <cassert>
@@ -11,12 +21,31 @@
 
 namespace runtime {
 
+    class CallStack;
+    class Isolate;
+    class TaskPool;
+    struct Method;
+
 // Контекст исполнения инструкций Mython
     class Context {
     public:
         // Возвращает поток вывода для команд print
         virtual std::ostream& GetOutputStream() = 0;
 
+        // Возвращает стек кадров вызовов методов
+        virtual CallStack& GetCallStack() = 0;
+
+        // Возвращает изолят, в котором выполняется код (см. isolate.h), либо nullptr,
+        // если код выполняется вне пула изолятов и встроенные функции spawn, send и recv недоступны
+        virtual Isolate* GetIsolate() {
+            return nullptr;
+        }
+
+        // Возвращает пул задач (см. tasks.h) либо nullptr, если spawn obj.method(...) и join недоступны
+        virtual TaskPool* GetTaskPool() {
+            return nullptr;
+        }
+
     protected:
         ~Context() = default;
     };
@@ -57,6 +86,10 @@ namespace runtime {
 
         [[nodiscard]] Object* Get() const;
 
+        // Возвращает количество ObjectHolder, совместно владеющих объектом
+        // (для пустого ObjectHolder и для объекта, полученного через Share, - 0)
+        [[nodiscard]] long UseCount() const;
+
         // Возвращает указатель на объект типа T либо nullptr, если внутри ObjectHolder не хранится
         // объект данного типа
         template <typename T>
@@ -90,12 +123,204 @@ namespace runtime {
             return value_;
         }
 
+        // Заменяет значение объекта. Допустимо, только если на объект нет других ссылок,
+        // которые могли бы заметить изменение (например, счётчик цикла for)
+        void SetValue(T value) {
+            value_ = std::move(value);
+        }
+
     private:
         T value_;
     };
 
+/*
+Распределитель памяти с пулом свободных блоков. Одиночные объекты T после освобождения
+не возвращаются в кучу, а попадают в список свободных блоков своего потока и выдаются
+при следующем выделении. Массивы (например, корзины хеш-таблицы) выделяются обычным образом.
+
+Применяется для узлов Closure: кадры вызовов методов постоянно вставляют и удаляют
+одни и те же переменные, и после разогрева такие вставки не обращаются к куче
+*/
+    template <typename T>
+    class PoolAllocator {
+    public:
+        using value_type = T;
+
+        // Сколько свободных блоков поток хранит для повторного использования
+        static constexpr size_t MAX_FREE_BLOCKS = 1024;
+
+        PoolAllocator() noexcept = default;
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>& /*other*/) noexcept {  // NOLINT(google-explicit-constructor)
+        }
+
+        T* allocate(size_t n) {
+            FreeList &free_list = Free();
+            if (n == 1 && free_list.head != nullptr) {
+                Block *block = free_list.head;
+                free_list.head = block->next;
+                --free_list.size;
+                return reinterpret_cast<T*>(block);
+            }
+            return static_cast<T*>(::operator new(n == 1 ? BLOCK_SIZE : n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            FreeList &free_list = Free();
+            if (n == 1 && free_list.size < MAX_FREE_BLOCKS) {
+                auto *block = reinterpret_cast<Block*>(p);
+                block->next = free_list.head;
+                free_list.head = block;
+                ++free_list.size;
+                return;
+            }
+            ::operator delete(p);
+        }
+
+        friend bool operator==(const PoolAllocator& /*lhs*/, const PoolAllocator& /*rhs*/) {
+            return true;
+        }
+
+        friend bool operator!=(const PoolAllocator& /*lhs*/, const PoolAllocator& /*rhs*/) {
+            return false;
+        }
+
+    private:
+        struct Block {
+            Block* next;
+        };
+
+        static constexpr size_t BLOCK_SIZE = sizeof(T) > sizeof(Block) ? sizeof(T) : sizeof(Block);
+
+        struct FreeList {
+            Block* head = nullptr;
+            size_t size = 0;
+
+            ~FreeList() {
+                while (head != nullptr) {
+                    ::operator delete(std::exchange(head, head->next));
+                }
+                size = 0;
+            }
+        };
+
+        static FreeList& Free() {
+            thread_local FreeList free_list;
+            return free_list;
+        }
+    };
+
 // Таблица символов, связывающая имя объекта с его значением
-    using Closure = std::unordered_map<std::string, ObjectHolder>;
+    using Closure = std::unordered_map<std::string, ObjectHolder, std::hash<std::string>,
+                                       std::equal_to<std::string>,
+                                       PoolAllocator<std::pair<const std::string, ObjectHolder>>>;
+
+/*
+Стек кадров вызовов методов Mython. Локальные переменные вызова (Closure) хранятся
+не в стеке C++, а в растущей арене: освободившиеся кадры не удаляются и переиспользуются
+следующими вызовами, поэтому вызов метода не выделяет память под саму таблицу символов.
+
+Глубина рекурсии ограничена. Вызов, превышающий max_depth кадров или занимающий больше
+native_stack_budget байт стека C++ от первого кадра, выбрасывает runtime_error
+"maximum recursion depth exceeded" вместо аварийного завершения по переполнению стека
+*/
+    class CallStack {
+    public:
+        static constexpr size_t DEFAULT_MAX_DEPTH = 100'000;
+        static constexpr size_t DEFAULT_NATIVE_STACK_BUDGET = 4 << 20;
+
+        explicit CallStack(size_t max_depth = DEFAULT_MAX_DEPTH,
+                           size_t native_stack_budget = DEFAULT_NATIVE_STACK_BUDGET);
+
+        // Кадр вызова. Занимает кадр стека на время своего существования
+        class Frame {
+        public:
+            explicit Frame(CallStack& stack);
+            ~Frame();
+
+            Frame(const Frame&) = delete;
+            Frame& operator=(const Frame&) = delete;
+
+            // Локальные переменные вызова. Изначально пусты
+            [[nodiscard]] Closure& Locals() {
+                return locals_;
+            }
+
+        private:
+            CallStack& stack_;
+            Closure& locals_;
+        };
+
+        [[nodiscard]] size_t Depth() const {
+            return depth_;
+        }
+
+        [[nodiscard]] size_t MaxDepth() const {
+            return max_depth_;
+        }
+
+        void SetMaxDepth(size_t max_depth);
+        void SetNativeStackBudget(size_t bytes);
+
+        // Запоминает будущий результат задачи (см. tasks.h), запущенной в текущем кадре.
+        // Задачи кадра дожидаются при выходе из него
+        void AddPendingTask(ObjectHolder future);
+        // Возвращает true, если есть запомненные задачи, запущенные на глубине depth или глубже
+        [[nodiscard]] bool HasPendingTasks(size_t depth) const {
+            return !pending_tasks_.empty() && pending_tasks_.back().first >= depth;
+        }
+        // Извлекает задачи, запущенные на глубине depth или глубже, в порядке их запуска
+        [[nodiscard]] std::vector<ObjectHolder> TakePendingTasks(size_t depth);
+
+        // Инструкция return не выбрасывает исключение, а запоминает результат метода.
+        // Составные инструкции и циклы, увидев IsReturning(), прекращают выполнение,
+        // и тело метода (ast::MethodBody) забирает результат
+        void SetReturnValue(ObjectHolder value) {
+            return_value_ = std::move(value);
+            returning_ = true;
+        }
+        // Хвостовой вызов (см. tail_calls.h): вместо результата запоминается метод,
+        // тело которого ast::MethodBody выполняет в том же кадре
+        void SetTailCall(const Method& method) {
+            tail_call_ = &method;
+            returning_ = true;
+        }
+        [[nodiscard]] bool IsReturning() const {
+            return returning_;
+        }
+        // Возвращает метод хвостового вызова и сбрасывает признак возврата
+        // либо nullptr, если выполнена обычная инструкция return
+        [[nodiscard]] const Method* TakeTailCall() {
+            if (!tail_call_) {
+                return nullptr;
+            }
+            returning_ = false;
+            return std::exchange(tail_call_, nullptr);
+        }
+        [[nodiscard]] ObjectHolder TakeReturnValue() {
+            returning_ = false;
+            return std::move(return_value_);
+        }
+
+    private:
+        Closure& Push();
+        void Pop();
+
+        // deque не перемещает элементы при росте, поэтому ссылки на кадры остаются действительными
+        std::deque<Closure> frames_;
+        size_t depth_ = 0;
+        size_t max_depth_;
+        size_t native_stack_budget_;
+        // Адрес в стеке C++, с которого начался самый внешний вызов
+        uintptr_t native_base_ = 0;
+        // Глубина кадра и будущий результат задачи в порядке запуска задач
+        std::vector<std::pair<size_t, ObjectHolder>> pending_tasks_;
+        // Результат выполненной, но ещё не полученной методом инструкции return
+        bool returning_ = false;
+        ObjectHolder return_value_;
+        const Method* tail_call_ = nullptr;
+    };
 
 // Проверяет, содержится ли в object значение, приводимое к True
 // Для отличных от нуля чисел, True и непустых строк возвращается true. В остальных случаях - false.
@@ -108,12 +333,161 @@ namespace runtime {
         // Выполняет действие над объектами внутри closure, используя context
         // Возвращает результирующее значение либо None
         virtual ObjectHolder Execute(Closure& closure, Context& context) = 0;
+
+        // Вычисляет инструкцию как условие и возвращает результат приведения её значения к bool
+        // по правилам IsTrue. Сравнения и логические операции переопределяют метод,
+        // чтобы не создавать промежуточный объект Bool
+        virtual bool EvaluateCondition(Closure& closure, Context& context);
+
+        // Передаёт visitor каждую дочернюю инструкцию в порядке их вычисления.
+        // visitor может заменить дочернюю инструкцию (используется проходами по дереву программы)
+        virtual void ForEachChild([[maybe_unused]] const std::function<void(std::unique_ptr<Executable>&)>& visitor) {
+        }
     };
 
-// Строковое значение
-    using String = ValueObject<std::string>;
-// Числовое значение
-    using Number = ValueObject<int>;
+// Строковое значение. Символы строки неизменяемы и разделяются между копиями объекта,
+// поэтому копирование String не копирует символы.
+// Результат конкатенации длинных строк хранится в виде верёвки (rope) - дерева из частей строки, -
+// которая собирается в обычную строку при первом обращении к значению.
+// Сборка значения не изменяет полей строки, кроме кеша собранного значения, который
+// публикуется атомарно, поэтому строку можно одновременно читать из нескольких потоков
+    class String : public Object {
+    public:
+        String(std::string value);  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+        String(const String& other);
+        String(String&& other) noexcept = default;
+        String& operator=(const String& other);
+        String& operator=(String&& other) noexcept = default;
+
+        // Возвращает строку, символы которой хранятся в пуле строковых констант: все строки,
+        // полученные из Intern для одного значения, разделяют одно хранилище.
+        // Значения пула хранятся до завершения программы, поэтому Intern применяется к литералам
+        static String Intern(std::string_view value);
+
+        // Возвращает конкатенацию lhs и rhs. Результат длиной от ROPE_MIN_SIZE символов
+        // создаётся за O(1) и ссылается на части исходных строк, более короткий - хранится целиком
+        static String Concat(const String& lhs, const String& rhs);
+
+        void Print(std::ostream& os, Context& context) override;
+
+        // Возвращает значение строки, при необходимости собирая его из частей верёвки
+        // или копируя символы среза в собственный буфер. Собранное значение кешируется
+        [[nodiscard]] const std::string& GetValue() const;
+        // Возвращает символы строки; для среза - без копирования
+        [[nodiscard]] std::string_view GetView() const;
+        [[nodiscard]] size_t Size() const;
+        // Возвращает хеш значения строки. Хеш вычисляется один раз и разделяется копиями строки
+        [[nodiscard]] size_t Hash() const;
+        // Возвращает true, если значение строки ещё не собрано из частей
+        [[nodiscard]] bool IsRope() const;
+        // Возвращает true, если строка получена из пула строковых констант
+        [[nodiscard]] bool IsInterned() const;
+        // Возвращает true, если строка ссылается на часть символов другой строки
+        [[nodiscard]] bool IsSlice() const;
+
+        // Возвращает подстроку длиной до length символов, начиная с позиции start.
+        // Подстрока ссылается на символы этой строки без копирования. Символы копируются,
+        // только если срез удерживал бы в памяти намного более длинную строку:
+        // от SLICE_PIN_MIN_SIZE символов и более чем в SLICE_PIN_RATIO раз длиннее среза
+        [[nodiscard]] String Substr(size_t start, size_t length) const;
+        // Возвращает позицию первого вхождения needle, начиная с позиции start, или std::string::npos
+        [[nodiscard]] size_t Find(std::string_view needle, size_t start = 0) const;
+
+        // Вызывает встроенный метод строки: find(sub) или find(sub, start) возвращает позицию
+        // первого вхождения sub или -1. Для неизвестного метода или неверных аргументов
+        // выбрасывает исключение runtime_error
+        ObjectHolder Call(const std::string& method, ObjectHolder* args, size_t argument_count);
+
+        // Строки из пула сравниваются по адресу хранилища. Остальные строки с разной длиной
+        // или разным хешем считаются различными без сравнения символов
+        friend bool operator==(const String& lhs, const String& rhs);
+        friend bool operator<(const String& lhs, const String& rhs);
+
+        static constexpr size_t ROPE_MIN_SIZE = 64;
+        static constexpr size_t SLICE_PIN_MIN_SIZE = 4096;
+        static constexpr size_t SLICE_PIN_RATIO = 8;
+
+    private:
+        struct RopeNode;
+        struct Data;
+        using Payload = std::shared_ptr<const Data>;
+
+        String(Payload value, bool interned);
+        String(Payload value, size_t slice_offset, size_t slice_size);
+        explicit String(std::shared_ptr<const RopeNode> rope);
+        // Возвращает узел верёвки, соответствующий строке
+        [[nodiscard]] std::shared_ptr<const RopeNode> AsRope() const;
+        // Возвращает хранилище со значением строки целиком. Для верёвки и среза значение
+        // собирается при первом вызове и сохраняется в flat_
+        [[nodiscard]] Payload Flatten() const;
+        [[nodiscard]] bool HasSliceBounds() const;
+        // Возвращает собранное значение верёвки или среза либо nullptr, если оно ещё не собрано
+        [[nodiscard]] Payload LoadFlat() const;
+
+        static constexpr size_t NOT_SLICE = std::string::npos;
+
+        // Ровно одно из полей value_ и rope_ не пусто. У среза slice_size_ не равно NOT_SLICE,
+        // а символами строки служат slice_size_ символов value_, начиная с slice_offset_.
+        // Эти поля не изменяются после создания строки
+        Payload value_;
+        std::shared_ptr<const RopeNode> rope_;
+        size_t slice_offset_ = 0;
+        size_t slice_size_ = NOT_SLICE;
+        bool interned_ = false;
+        // Собранное значение верёвки или среза. Читается и записывается только функциями
+        // std::atomic_load и std::atomic_compare_exchange_strong
+        mutable Payload flat_;
+    };
+
+    bool operator!=(const String& lhs, const String& rhs);
+
+// Хеш-функция для контейнеров, ключами которых служат строки Mython
+    struct StringHasher {
+        size_t operator()(const String& value) const {
+            return value.Hash();
+        }
+    };
+
+/*
+Собирает строку из частей за одно выделение памяти. Append только запоминает части
+(строки - без копирования символов), а Build вычисляет итоговую длину и заполняет один буфер.
+Используется конкатенацией нескольких строк и встроенными функциями join и format
+*/
+    class StringBuilder {
+    public:
+        void Reserve(size_t part_count);
+
+        // Добавляет text. Символы должны оставаться доступными до вызова Build
+        void Append(std::string_view text);
+        // Добавляет строковое представление object, как str(object). Числа, логические значения
+        // и None добавляются без создания промежуточных объектов String
+        void Append(const ObjectHolder& object, Context& context);
+
+        // Возвращает длину собираемой строки
+        [[nodiscard]] size_t Size() const;
+        // Возвращает собранную строку и очищает построитель
+        String Build();
+
+    private:
+        struct Part {
+            // Удерживает строку, на символы которой ссылается text
+            ObjectHolder holder;
+            std::string_view text;
+            // Десятичная запись числа, если text пуст
+            char digits[std::numeric_limits<int64_t>::digits10 + 3] = {};
+            uint8_t digits_size = 0;
+        };
+
+        std::vector<Part> parts_;
+        size_t size_ = 0;
+    };
+
+// Числовое значение. Результаты, не помещающиеся в int64_t, представляются объектом BigNumber
+    using Number = ValueObject<int64_t>;
+// Целое число произвольной точности. Арифметические операции возвращают BigNumber,
+// только если результат не помещается в Number
+    using BigNumber = ValueObject<BigInt>;
 
 // Логическое значение
     class Bool : public ValueObject<bool> {
@@ -123,6 +497,67 @@ namespace runtime {
         void Print(std::ostream& os, Context& context) override;
     };
 
+// Ленивая последовательность целых чисел range(start, stop, step).
+// Хранит только границы и шаг, элементы последовательности вычисляются при обходе
+    class Range : public Object {
+    public:
+        // Если step равен нулю, выбрасывает исключение runtime_error
+        Range(int64_t start, int64_t stop, int64_t step = 1);
+
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] int64_t GetStart() const;
+        [[nodiscard]] int64_t GetStop() const;
+        [[nodiscard]] int64_t GetStep() const;
+
+        // Возвращает true, если value - ещё не пройденный элемент последовательности,
+        // то есть value не достигло stop в направлении шага
+        [[nodiscard]] bool Continues(int64_t value) const;
+
+        // Количество элементов последовательности. Вычисляется без переполнения,
+        // даже если расстояние между start и stop не помещается в int64_t
+        [[nodiscard]] uint64_t Size() const;
+        // Элемент с номером index, меньшим Size(), без обхода предыдущих элементов
+        [[nodiscard]] int64_t At(uint64_t index) const;
+
+    private:
+        int64_t start_;
+        int64_t stop_;
+        int64_t step_;
+    };
+
+// Список - изменяемая последовательность объектов. Элементы хранятся подряд в одном буфере,
+// который растёт с амортизированно постоянной стоимостью добавления
+    class List : public Object {
+    public:
+        List() = default;
+        explicit List(std::vector<ObjectHolder> items);
+
+        // Выводит элементы через запятую в квадратных скобках, например "[1, 2, abc]"
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает элемент с индексом index. Отрицательный индекс отсчитывается от конца списка.
+        // Если индекс выходит за границы списка, выбрасывает исключение runtime_error
+        [[nodiscard]] const ObjectHolder& At(int64_t index) const;
+        // Заменяет элемент с индексом index значением value. Индекс трактуется так же, как в At
+        void Set(int64_t index, ObjectHolder value);
+
+        void Append(ObjectHolder value);
+
+        // Вызывает встроенный метод списка method (append) с argument_count аргументами,
+        // начиная с args. Для неизвестного метода выбрасывает исключение runtime_error
+        ObjectHolder Call(const std::string& method, ObjectHolder* args, size_t argument_count);
+
+        [[nodiscard]] const std::vector<ObjectHolder>& GetItems() const;
+
+    private:
+        [[nodiscard]] size_t Position(int64_t index) const;
+
+        std::vector<ObjectHolder> items_;
+    };
+
 // Метод класса
     struct Method {
         // Имя метода
@@ -146,6 +581,9 @@ namespace runtime {
         // Возвращает указатель на метод name или nullptr, если метод с таким именем отсутствует
         [[nodiscard]] const Method* GetMethod(const std::string& name) const;
 
+        // Вызывает visitor для каждого собственного (не унаследованного) метода класса
+        void ForEachMethod(const std::function<void(Method&)>& visitor);
+
         // Возвращает имя класса
         [[nodiscard]] const std::string& GetName() const;
 
@@ -157,8 +595,16 @@ namespace runtime {
     class ClassInstance : public Object {
         const Class *cls_ptr_;
         Closure closure_;
+        // Количество выполняемых задач, получателем или аргументом которых служит объект
+        std::atomic<uint32_t> task_shares_{0};
     public:
         explicit ClassInstance(const Class& cls);
+        // Копия не наследует отметки задач исходного объекта
+        ClassInstance(const ClassInstance& other);
+        ClassInstance(ClassInstance&& other) noexcept;
+
+        // Возвращает класс, экземпляром которого является объект
+        [[nodiscard]] const Class& GetClass() const;
 
         /*
          * Если у объекта есть метод __str__, выводит в os результат, возвращённый этим методом.
@@ -175,6 +621,18 @@ namespace runtime {
         ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
                           Context& context);
 
+        // Вызывает у объекта уже найденный метод method (например, закэшированный в месте вызова).
+        // Количество actual_args должно совпадать с количеством формальных параметров метода
+        ObjectHolder Call(const Method& method, const std::vector<ObjectHolder>& actual_args,
+                          Context& context);
+
+        // Вызывает уже найденный метод method, перемещая в его кадр argument_count аргументов,
+        // начиная с args. Количество аргументов должно совпадать с количеством формальных параметров
+        ObjectHolder Call(const Method& method, ObjectHolder* args, size_t argument_count, Context& context);
+
+        // То же, но аргументы копируются в кадр метода, а не перемещаются
+        ObjectHolder Call(const Method& method, const ObjectHolder* args, size_t argument_count, Context& context);
+
         // Возвращает true, если объект имеет метод method, принимающий argument_count параметров
         [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
 
@@ -182,10 +640,63 @@ namespace runtime {
         [[nodiscard]] Closure& Fields();
         // Возвращает константную ссылку на Closure, содержащую поля объекта
         [[nodiscard]] const Closure& Fields() const;
+        // Возвращает поля объекта для присваивания. Если объект используется выполняемой задачей,
+        // выбрасывает runtime_error: поля такого объекта доступны только для чтения
+        [[nodiscard]] Closure& MutableFields();
+
+        // Отмечает начало и конец использования объекта задачей (см. tasks.h)
+        void BeginTaskShare();
+        void EndTaskShare();
+    };
+
+/*
+ * Метод класса, найденный один раз для многократного вызова из C++.
+ * Вызов не ищет метод по имени и не создаёт вектор аргументов. Экземпляры подклассов
+ * допускаются, если в них метод с тем же именем и числом параметров найден заново
+ * (например, переопределён).
+ * Конструктор выбрасывает runtime_error, если у класса нет метода name с argument_count параметрами
+ */
+    class PreparedMethod {
+    public:
+        PreparedMethod(const Class& cls, std::string name, size_t argument_count);
+
+        [[nodiscard]] const Class& GetClass() const;
+        [[nodiscard]] const Method& GetMethod() const;
+        [[nodiscard]] size_t GetArgumentCount() const;
+
+        // Вызывает метод у self с argument_count аргументами, начиная с args.
+        // Выбрасывает runtime_error, если количество аргументов не совпадает с подготовленным
+        ObjectHolder Invoke(ClassInstance& self, const ObjectHolder* args, size_t argument_count,
+                            Context& context) const;
+        ObjectHolder Invoke(ClassInstance& self, std::initializer_list<ObjectHolder> args, Context& context) const;
+
+        /*
+         * Вызывает метод у count экземпляров instances[0..count). Аргументы i-го вызова -
+         * GetArgumentCount() значений, начиная с args + i * GetArgumentCount().
+         * Если results не равен nullptr, результат i-го вызова записывается в results[i].
+         * Метод ищется заново только при смене класса между соседними экземплярами
+         */
+        void InvokeBatch(ClassInstance* const* instances, size_t count, const ObjectHolder* args,
+                         ObjectHolder* results, Context& context) const;
+
+    private:
+        // Возвращает метод для экземпляра класса cls
+        [[nodiscard]] const Method& Resolve(const Class& cls) const;
+
+        const Class* cls_;
+        const Method* method_;
+        std::string name_;
     };
 
+// Вызывает встроенный метод method у строки, списка, словаря, intarray или объекта C++ (NativeObject) object,
+// передавая ему argument_count аргументов, начиная с args. Возвращает nullopt для остальных значений
+    std::optional<ObjectHolder> CallBuiltinMethod(const ObjectHolder& object, const std::string& method,
+                                                  ObjectHolder* args, size_t argument_count, Context& context);
+
 /*
- * Возвращает true, если lhs и rhs содержат одинаковые числа, строки или значения типа Bool.
+ * Возвращает true, если lhs и rhs содержат одинаковые числа, строки или значения типа Bool,
+ * списки равной длины с попарно равными элементами либо словари с одинаковыми ключами
+ * и равными значениями при них.
  * Если lhs - объект с методом __eq__, функция возвращает результат вызова lhs.__eq__(rhs),
  * приведённый к типу Bool. Если lhs и rhs имеют значение None, функция возвращает true.
  * В остальных случаях функция выбрасывает исключение runtime_error.
@@ -212,6 +723,55 @@ namespace runtime {
 // Возвращает значение, противоположное Less(lhs, rhs, context)
     bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 
+/*
+ * Арифметические операции над значениями Mython.
+ * Add поддерживает числа, строки и объекты с методом __add__(rhs),
+ * Sub, Mult и Div - только числа. Div выбрасывает runtime_error при делении на ноль.
+ * Для неподдерживаемых типов выбрасывается исключение runtime_error.
+ * При переполнении int64_t результат вычисляется в BigInt; результат, помещающийся в int64_t,
+ * всегда возвращается как Number.
+ *
+ * Параметр context задаёт контекст для выполнения метода __add__
+ */
+    ObjectHolder Add(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+    ObjectHolder Sub(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder Mult(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder Div(const ObjectHolder& lhs, const ObjectHolder& rhs);
+
+// Возвращает value в виде Number, если значение помещается в int64_t, иначе - в виде BigNumber
+    ObjectHolder MakeInteger(BigInt value);
+
+// Возвращает строковое представление object (результат str(object) в Mython).
+// Строка возвращается как есть, без копирования; числа, логические значения и None
+// преобразуются без потоков вывода; для объекта класса с методом __str__ возвращается
+// строковое представление результата __str__. Остальные объекты выводятся методом Print
+    ObjectHolder ToString(const ObjectHolder& object, Context& context);
+
+/*
+ * Быстрая ветка целочисленной арифметики. Записывает результат в result и возвращает true,
+ * если он представим типом int64_t. При переполнении (а для CheckedDiv - и при делении на ноль)
+ * возвращает false: результат следует вычислить соответствующей функцией Add/Sub/Mult/Div
+ */
+    inline bool CheckedAdd(int64_t lhs, int64_t rhs, int64_t& result) {
+        return !__builtin_add_overflow(lhs, rhs, &result);
+    }
+
+    inline bool CheckedSub(int64_t lhs, int64_t rhs, int64_t& result) {
+        return !__builtin_sub_overflow(lhs, rhs, &result);
+    }
+
+    inline bool CheckedMult(int64_t lhs, int64_t rhs, int64_t& result) {
+        return !__builtin_mul_overflow(lhs, rhs, &result);
+    }
+
+    inline bool CheckedDiv(int64_t lhs, int64_t rhs, int64_t& result) {
+        if (rhs == 0 || (rhs == -1 && lhs == std::numeric_limits<int64_t>::min())) {
+            return false;
+        }
+        result = lhs / rhs;
+        return true;
+    }
+
 // Контекст-заглушка, применяется в тестах.
 // В этом контексте весь вывод перенаправляется в строковый поток вывода output
     struct DummyContext : Context {
@@ -219,7 +779,12 @@ namespace runtime {
             return output;
         }
 
+        CallStack& GetCallStack() override {
+            return call_stack;
+        }
+
         std::ostringstream output;
+        CallStack call_stack;
     };
 
 // Простой контекст, в нём вывод происходит в поток output, переданный в конструктор
@@ -233,8 +798,13 @@ namespace runtime {
             return output_;
         }
 
+        CallStack& GetCallStack() override {
+            return call_stack_;
+        }
+
     private:
         std::ostream& output_;
+        CallStack call_stack_;
     };
 
 }  // namespace runtime
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "runtime.h"
 #include "test_runner_p.h"
 
+#include <algorithm>
 #include <functional>
+#include <unordered_set>
 
 using namespace std;
 
@@ -71,6 +73,84 @@ namespace runtime {
             ASSERT_EQUAL(word.GetValue(), "hello!"s);
         }
 
+        void TestStringRope() {
+            DummyContext context;
+
+            ObjectHolder short_string = Add(ObjectHolder::Own(String{"ab"s}), ObjectHolder::Own(String{"cd"s}), context);
+            ASSERT(!short_string.TryAs<String>()->IsRope());
+            ASSERT_EQUAL(short_string.TryAs<String>()->GetValue(), "abcd"s);
+
+            // Глубокая цепочка конкатенаций не должна приводить к рекурсии при сборке и удалении
+            constexpr size_t ITERATIONS = 200'000;
+            ObjectHolder text = ObjectHolder::Own(String{""s});
+            const ObjectHolder piece = ObjectHolder::Own(String{"xy"s});
+            for (size_t i = 0; i < ITERATIONS; ++i) {
+                text = Add(text, piece, context);
+            }
+            const auto &rope = *text.TryAs<String>();
+            ASSERT(rope.IsRope());
+            ASSERT_EQUAL(rope.Size(), 2 * ITERATIONS);
+            ASSERT(IsTrue(text));
+
+            ObjectHolder longer = Add(text, ObjectHolder::Own(String{"z"s}), context);
+            ASSERT(Less(text, longer, context));
+            ASSERT(!rope.IsRope());
+            ASSERT_EQUAL(rope.GetValue().size(), 2 * ITERATIONS);
+            ASSERT_EQUAL(rope.GetValue().substr(0, 4), "xyxy"s);
+
+            ostringstream out;
+            longer->Print(out, context);
+            ASSERT_EQUAL(out.str().size(), 2 * ITERATIONS + 1);
+            ASSERT_EQUAL(out.str().back(), 'z');
+        }
+
+        void TestInternedStrings() {
+            String first = String::Intern("literal"s);
+            String second = String::Intern("literal"s);
+            String other = String::Intern("other"s);
+            String plain{"literal"s};
+
+            ASSERT(first.IsInterned());
+            ASSERT(!plain.IsInterned());
+            ASSERT_EQUAL(&first.GetValue(), &second.GetValue());
+            ASSERT(first == second);
+            ASSERT(first != other);
+            ASSERT(first == plain);
+            ASSERT(plain == second);
+
+            String copy = plain;
+            ASSERT_EQUAL(&copy.GetValue(), &plain.GetValue());
+
+            DummyContext context;
+            ASSERT(Equal(ObjectHolder::Share(first), ObjectHolder::Own(String{second}), context));
+            ASSERT(Less(ObjectHolder::Share(first), ObjectHolder::Share(other), context));
+        }
+
+        void TestStringHash() {
+            String status{string(1000, 's') + "ready"s};
+            String other{string(1000, 's') + "error"s};
+            String same{string(1000, 's') + "ready"s};
+
+            ASSERT_EQUAL(status.Hash(), same.Hash());
+            ASSERT(status.Hash() != other.Hash());
+            ASSERT(status == same);
+            ASSERT(status != other);
+
+            String copy = status;
+            ASSERT_EQUAL(copy.Hash(), status.Hash());
+
+            DummyContext context;
+            ObjectHolder rope = Add(ObjectHolder::Own(String{string(1000, 's')}), ObjectHolder::Own(String{"ready"s}),
+                                    context);
+            ASSERT(rope.TryAs<String>()->IsRope());
+            ASSERT_EQUAL(rope.TryAs<String>()->Hash(), status.Hash());
+
+            unordered_set<String, StringHasher> statuses = {status, other};
+            ASSERT(statuses.count(same));
+            ASSERT(statuses.count(*rope.TryAs<String>()));
+            ASSERT(!statuses.count(String{"ready"s}));
+        }
+
         void TestBool() {
             Bool t(true);
             ASSERT_EQUAL(t.GetValue(), true);
@@ -192,6 +272,7 @@ namespace runtime {
             auto oh = ObjectHolder::Share(logger);
             ASSERT(oh);
             ASSERT(oh.Get() == &logger);
+            ASSERT_EQUAL(oh.UseCount(), 0);
 
             DummyContext context;
             oh->Print(context.output, context);
@@ -529,6 +610,222 @@ namespace runtime {
             ASSERT_THROWS(instance.Call("missing_method"s, {}, ctx), runtime_error);
         }
 
+        void TestPreparedMethod() {
+            DummyContext ctx;
+            vector<Closure> calls;
+            auto add_body = [&calls](Closure& closure, [[maybe_unused]] Context& context) {
+                calls.push_back(closure);
+                const auto *lhs = closure.at("lhs"s).TryAs<Number>();
+                const auto *rhs = closure.at("rhs"s).TryAs<Number>();
+                return ObjectHolder::Own(Number{lhs->GetValue() + rhs->GetValue()});
+            };
+            auto child_body = [](Closure& closure, [[maybe_unused]] Context& context) {
+                return ObjectHolder::Own(Number{-closure.at("a"s).TryAs<Number>()->GetValue()});
+            };
+            vector<Method> base_methods;
+            base_methods.push_back({"add"s, {"lhs"s, "rhs"s}, make_unique<TestMethodBody>(add_body)});
+            Class base{"Base"s, move(base_methods), nullptr};
+            vector<Method> child_methods;
+            child_methods.push_back({"add"s, {"a"s, "b"s}, make_unique<TestMethodBody>(child_body)});
+            Class child{"Child"s, move(child_methods), &base};
+            Class heir{"Heir"s, {}, &base};
+
+            ASSERT_THROWS(PreparedMethod(base, "sub"s, 2), runtime_error);
+            ASSERT_THROWS(PreparedMethod(base, "add"s, 1), runtime_error);
+
+            const PreparedMethod add{base, "add"s, 2};
+            ASSERT_EQUAL(&add.GetClass(), &base);
+            ASSERT_EQUAL(&add.GetMethod(), base.GetMethod("add"s));
+            ASSERT_EQUAL(add.GetArgumentCount(), 2U);
+
+            ClassInstance instance{base};
+            const ObjectHolder one = ObjectHolder::Own(Number{1});
+            const ObjectHolder two = ObjectHolder::Own(Number{2});
+            ASSERT_EQUAL(add.Invoke(instance, {one, two}, ctx).TryAs<Number>()->GetValue(), 3);
+            ASSERT_EQUAL(calls.back().at("self"s).Get(), &instance);
+            // Аргументы копируются в кадр, а не перемещаются
+            ASSERT(one && two);
+            ASSERT_THROWS(add.Invoke(instance, {one}, ctx), runtime_error);
+            ASSERT_EQUAL(ctx.GetCallStack().Depth(), 0U);
+
+            ClassInstance child_instance{child};
+            ClassInstance heir_instance{heir};
+            ClassInstance *instances[] = {&instance, &heir_instance, &child_instance, &instance};
+            vector<ObjectHolder> args;
+            for (int i = 0; i < 4; ++i) {
+                args.push_back(ObjectHolder::Own(Number{i}));
+                args.push_back(ObjectHolder::Own(Number{10}));
+            }
+            vector<ObjectHolder> results(4);
+            calls.clear();
+            add.InvokeBatch(instances, 4, args.data(), results.data(), ctx);
+            vector<int64_t> values;
+            for (const ObjectHolder &result : results) {
+                values.push_back(result.TryAs<Number>()->GetValue());
+            }
+            ASSERT_EQUAL(values, (vector<int64_t>{10, 11, -2, 13}));
+            ASSERT_EQUAL(calls.size(), 3U);
+            ASSERT_EQUAL(calls[1].at("self"s).Get(), &heir_instance);
+
+            add.InvokeBatch(instances, 2, args.data(), nullptr, ctx);
+            ASSERT_EQUAL(calls.size(), 5U);
+
+            Class other{"Other"s, {}, nullptr};
+            ClassInstance other_instance{other};
+            ASSERT_THROWS(add.Invoke(other_instance, {one, two}, ctx), runtime_error);
+        }
+
+        void TestCallStack() {
+            DummyContext ctx;
+            CallStack &stack = ctx.GetCallStack();
+            stack.SetMaxDepth(50);
+
+            vector<Method> methods;
+            ClassInstance *self = nullptr;
+            size_t deepest = 0;
+            vector<const Closure*> frames;
+            auto body = [&](Closure& closure, Context& context) {
+                frames.push_back(&closure);
+                deepest = max(deepest, context.GetCallStack().Depth());
+                const int n = static_cast<int>(closure.at("n"s).TryAs<Number>()->GetValue());
+                ASSERT_EQUAL(closure.size(), 2U);
+                if (n > 0) {
+                    self->Call("down"s, {ObjectHolder::Own(Number{n - 1})}, context);
+                }
+                return ObjectHolder::None();
+            };
+            methods.push_back({"down"s, {"n"s}, make_unique<TestMethodBody>(body)});
+            Class cls{"Recursive"s, move(methods), nullptr};
+            ClassInstance instance{cls};
+            self = &instance;
+
+            instance.Call("down"s, {ObjectHolder::Own(Number{49})}, ctx);
+            ASSERT_EQUAL(deepest, 50U);
+            ASSERT_EQUAL(stack.Depth(), 0U);
+
+            // Кадры переиспользуются повторным вызовом той же глубины
+            const vector<const Closure*> first_frames = frames;
+            frames.clear();
+            instance.Call("down"s, {ObjectHolder::Own(Number{49})}, ctx);
+            ASSERT(frames == first_frames);
+
+            ASSERT_THROWS(instance.Call("down"s, {ObjectHolder::Own(Number{50})}, ctx), runtime_error);
+            ASSERT_EQUAL(stack.Depth(), 0U);
+
+            // Переполнение стека C++ превращается в исключение, а не в аварийное завершение
+            stack.SetMaxDepth(CallStack::DEFAULT_MAX_DEPTH);
+            stack.SetNativeStackBudget(64 << 10);
+            ASSERT_THROWS(instance.Call("down"s, {ObjectHolder::Own(Number{1'000'000})}, ctx), runtime_error);
+            ASSERT_EQUAL(stack.Depth(), 0U);
+        }
+
+        void TestList() {
+            List list;
+            ASSERT(!IsTrue(ObjectHolder::Share(list)));
+            for (int i = 0; i < 100; ++i) {
+                list.Append(ObjectHolder::Own(Number{i}));
+            }
+            ASSERT_EQUAL(list.Size(), 100U);
+            ASSERT_EQUAL(list.At(0).TryAs<Number>()->GetValue(), 0);
+            ASSERT_EQUAL(list.At(-1).TryAs<Number>()->GetValue(), 99);
+            ASSERT_THROWS((void)list.At(100), runtime_error);
+            ASSERT_THROWS((void)list.At(-101), runtime_error);
+
+            list.Set(-2, ObjectHolder::Own(String{"x"s}));
+            ASSERT_EQUAL(list.At(98).TryAs<String>()->GetValue(), "x"s);
+
+            ObjectHolder arg = ObjectHolder::Own(Bool{true});
+            ASSERT(!list.Call("append"s, &arg, 1));
+            ASSERT_EQUAL(list.Size(), 101U);
+            ASSERT_THROWS(list.Call("pop"s, nullptr, 0), runtime_error);
+
+            DummyContext context;
+            List small{{ObjectHolder::Own(Number{1}), ObjectHolder::None(), ObjectHolder::Own(String{"a"s})}};
+            small.Print(context.output, context);
+            ASSERT_EQUAL(context.output.str(), "[1, None, a]"s);
+            ASSERT(IsTrue(ObjectHolder::Share(small)));
+
+            List same{{ObjectHolder::Own(Number{1}), ObjectHolder::None(), ObjectHolder::Own(String{"a"s})}};
+            ASSERT(Equal(ObjectHolder::Share(small), ObjectHolder::Share(same), context));
+            same.Append(ObjectHolder::None());
+            ASSERT(!Equal(ObjectHolder::Share(small), ObjectHolder::Share(same), context));
+        }
+
+        void TestStringSlices() {
+            const String line{"GET /index.html 200 512"s};
+            const String path = line.Substr(4, 11);
+            ASSERT(path.IsSlice());
+            ASSERT_EQUAL(path.Size(), 11U);
+            ASSERT_EQUAL(path.GetView(), "/index.html"sv);
+            ASSERT(path == String{"/index.html"s});
+            ASSERT_EQUAL(path.Hash(), String{"/index.html"s}.Hash());
+            ASSERT(path < String{"/z"s});
+
+            // Срез среза ссылается на ту же исходную строку
+            const String name = path.Substr(1, 5);
+            ASSERT(name.IsSlice());
+            ASSERT_EQUAL(name.GetView(), "index"sv);
+            ASSERT_EQUAL(line.Substr(20, 100).GetView(), "512"sv);
+            ASSERT_EQUAL(line.Substr(100, 1).Size(), 0U);
+            ASSERT(!line.Substr(0, line.Size()).IsSlice());
+
+            ASSERT_EQUAL(line.Find("200"sv), 16U);
+            ASSERT_EQUAL(line.Find(" "sv, 4), 15U);
+            ASSERT_EQUAL(path.Find("GET"sv), string::npos);
+
+            // Короткий срез длинной строки копируется, чтобы не удерживать её в памяти
+            const String huge{string(String::SLICE_PIN_MIN_SIZE, 'x')};
+            ASSERT(!huge.Substr(10, 10).IsSlice());
+            ASSERT(huge.Substr(10, String::SLICE_PIN_MIN_SIZE / 2).IsSlice());
+
+            // Срез верёвки ссылается на собранную строку; при конкатенации срез получает свои символы
+            const String rope = String::Concat(String{string(40, 'a')}, String{string(40, 'b')});
+            const String middle = rope.Substr(38, 4);
+            ASSERT_EQUAL(middle.GetView(), "aabb"sv);
+            ASSERT_EQUAL(String::Concat(middle, String{string(70, 'c')}).GetValue(), "aabb"s + string(70, 'c'));
+            ASSERT_EQUAL(middle.GetValue(), "aabb"s);
+            ASSERT(!middle.IsSlice());
+        }
+
+        void TestStringBuilder() {
+            DummyContext context;
+            StringBuilder builder;
+            builder.Append("n="sv);
+            builder.Append(ObjectHolder::Own(Number{-42}), context);
+            builder.Append(", "sv);
+            builder.Append(ObjectHolder::Own(Bool{true}), context);
+            builder.Append(ObjectHolder::None(), context);
+            builder.Append(ObjectHolder::Own(String::Concat(String{string(40, 'a')}, String{string(40, 'b')})),
+                           context);
+            builder.Append(ObjectHolder::Own(BigNumber{BigInt::FromString("123456789012345678901234567890"s)}),
+                           context);
+            ASSERT_EQUAL(builder.Size(), 15U + 80U + 30U);
+
+            const String result = builder.Build();
+            ASSERT(!result.IsRope());
+            ASSERT_EQUAL(result.GetValue(), "n=-42, TrueNone"s + string(40, 'a') + string(40, 'b')
+                                            + "123456789012345678901234567890"s);
+            ASSERT_EQUAL(builder.Size(), 0U);
+            ASSERT_EQUAL(builder.Build().GetValue(), ""s);
+        }
+
+        void TestClosureNodesReused() {
+            Closure closure;
+            closure["x"s] = ObjectHolder::Own(Number{1});
+            const auto *node = &*closure.find("x"s);
+            closure.clear();
+
+            // Освобождённый узел возвращается в пул потока и достаётся следующей вставке
+            Closure other;
+            other["y"s] = ObjectHolder::Own(Number{2});
+            ASSERT(static_cast<const void*>(&*other.find("y"s)) == static_cast<const void*>(node));
+            ASSERT_EQUAL(other.at("y"s).TryAs<Number>()->GetValue(), 2);
+
+            Closure copy = other;
+            ASSERT_EQUAL(copy.size(), 1U);
+            ASSERT(copy.at("y"s).Get() == other.at("y"s).Get());
+        }
+
     }  // namespace
 
     void RunObjectsTests(TestRunner& tr) {
@@ -542,6 +839,20 @@ namespace runtime {
         RUN_TEST(tr, runtime::TestClassInstance);
     }
 
+    void RunStringTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestStringRope);
+        RUN_TEST(tr, runtime::TestInternedStrings);
+        RUN_TEST(tr, runtime::TestStringHash);
+        RUN_TEST(tr, runtime::TestStringBuilder);
+        RUN_TEST(tr, runtime::TestStringSlices);
+    }
+
+    void RunCallTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestClosureNodesReused);
+        RUN_TEST(tr, runtime::TestPreparedMethod);
+        RUN_TEST(tr, runtime::TestCallStack);
+    }
+
     void RunObjectHolderTests(TestRunner& tr) {
         RUN_TEST(tr, runtime::TestNonowning);
         RUN_TEST(tr, runtime::TestOwning);
@@ -549,4 +860,8 @@ namespace runtime {
         RUN_TEST(tr, runtime::TestNullptr);
     }
 
+    void RunListTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestList);
+    }
+
 }  // namespace runtime
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "statement.h"
 
+#include "isolate.h"
+#include "tasks.h"
+
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -14,6 +18,42 @@ namespace ast {
     namespace {
         const string ADD_METHOD = "__add__"s;
         const string INIT_METHOD = "__init__"s;
+        const string ITER_METHOD = "__iter__"s;
+        const string NEXT_METHOD = "__next__"s;
+
+        // Быстрая ветка арифметики для специализированного узла: если оба операнда - числа,
+        // возвращает результат checked, а при переполнении - результат fallback.
+        // Если операнды не числа, возвращает пустой ObjectHolder (проверка типов не прошла)
+        template <typename Checked, typename Fallback>
+        ObjectHolder NumbersFastPath(const ObjectHolder& lhs, const ObjectHolder& rhs, Checked checked,
+                                     Fallback fallback) {
+            const auto *lhs_number = lhs.TryAs<runtime::Number>();
+            const auto *rhs_number = rhs.TryAs<runtime::Number>();
+            if (lhs_number && rhs_number) {
+                int64_t result = 0;
+                if (checked(lhs_number->GetValue(), rhs_number->GetValue(), result)) {
+                    return ObjectHolder::Own(runtime::Number{result});
+                }
+                return fallback(lhs, rhs);
+            }
+            return ObjectHolder::None();
+        }
+
+        runtime::List& AsList(const ObjectHolder& object) {
+            auto *list = object.TryAs<runtime::List>();
+            if (!list) {
+                throw runtime_error("object is not subscriptable");
+            }
+            return *list;
+        }
+
+        int64_t AsIndex(const ObjectHolder& index) {
+            const auto *number = index.TryAs<runtime::Number>();
+            if (!number) {
+                throw runtime_error("list indices must be integers");
+            }
+            return number->GetValue();
+        }
     }  // namespace
 
     ObjectHolder Assignment::Execute(Closure& closure, Context& context) {
@@ -27,6 +67,14 @@ namespace ast {
     {
     }
 
+    void Assignment::ForEachChild(const ChildVisitor& visitor) {
+        visitor(var_value_);
+    }
+
+    const std::string& Assignment::GetVarName() const {
+        return var_name_;
+    }
+
     VariableValue::VariableValue(const std::string& var_name)
             : dotted_ids_({var_name})
     {
@@ -49,6 +97,10 @@ namespace ast {
         return *ptr;
     }
 
+    const std::vector<std::string>& VariableValue::GetDottedIds() const {
+        return dotted_ids_;
+    }
+
     unique_ptr<Print> Print::Variable(const std::string& name) {
         return make_unique<Print>(make_unique<VariableValue>(name));
     }
@@ -82,6 +134,12 @@ namespace ast {
         return runtime::ObjectHolder::None();
     }
 
+    void Print::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
     MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
                            std::vector<std::unique_ptr<Statement>> args)
             : object_(std::move(object))
@@ -90,80 +148,706 @@ namespace ast {
     }
 
     ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
-        std::vector<runtime::ObjectHolder> args;
-        for (const auto &i : args_) {
-            args.push_back(i->Execute(closure, context));
+        ArgumentBuffer args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            args[i] = args_[i]->Execute(closure, context);
+        }
+        ObjectHolder object = object_->Execute(closure, context);
+        auto *instance = object.TryAs<runtime::ClassInstance>();
+        if (!instance) {
+            if (auto *native = object.TryAs<runtime::NativeObject>()) {
+                return CallNative(*native, args.Data(), args.Size(), context);
+            }
+            if (auto result = runtime::CallBuiltinMethod(object, method_, args.Data(), args.Size(), context)) {
+                return std::move(*result);
+            }
+            throw runtime_error("method "s + method_ + " called on a non-object value"s);
         }
-        return object_->Execute(closure, context).TryAs<runtime::ClassInstance>()->Call(method_, args, context);
+        const runtime::Class *cls = &instance->GetClass();
+        const runtime::Method *method = cache_.Find(cls);
+        if (!method) {
+            method = cls->GetMethod(method_);
+            if (!method || method->formal_params.size() != args.Size()) {
+                cache_.Disable();
+                throw runtime_error("hasn't got this method");
+            }
+            cache_.Remember(cls, method);
+        }
+        return instance->Call(*method, args.Data(), args.Size(), context);
+    }
+
+    ObjectHolder MethodCall::CallNative(runtime::NativeObject& object, ObjectHolder* args, size_t count,
+                                        Context& context) {
+        const runtime::NativeClass *cls = &object.GetNativeClass();
+        const runtime::NativeFunction *method = native_cache_.Find(cls);
+        if (!method) {
+            method = cls->GetMethod(method_);
+            if (!method) {
+                native_cache_.Disable();
+                throw runtime_error(cls->GetName() + " hasn't got method "s + method_);
+            }
+            native_cache_.Remember(cls, method);
+        }
+        return method->Call(&object, args, count, context);
+    }
+
+    void MethodCall::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+        visitor(object_);
+    }
+
+    const std::string& MethodCall::GetMethodName() const {
+        return method_;
+    }
+
+    NativeCall::NativeCall(const runtime::NativeFunction& function, std::vector<std::unique_ptr<Statement>> args)
+            : function_(function)
+            , args_(std::move(args)) {
+    }
+
+    ObjectHolder NativeCall::Execute(Closure& closure, Context& context) {
+        ArgumentBuffer args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            args[i] = args_[i]->Execute(closure, context);
+        }
+        return function_.Call(nullptr, args.Data(), args.Size(), context);
+    }
+
+    void NativeCall::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    std::unique_ptr<Statement> UnaryOperation::ReleaseArgument() {
+        return std::move(argument_);
+    }
+
+    void UnaryOperation::ForEachChild(const ChildVisitor& visitor) {
+        visitor(argument_);
+    }
+
+    void BinaryOperation::ForEachChild(const ChildVisitor& visitor) {
+        visitor(lhs_);
+        visitor(rhs_);
     }
 
     ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
-        ostringstream buf;
-        ObjectHolder object = argument_->Execute(closure, context);
-        if (object) {
-            object->Print(buf, context);
+        return runtime::ToString(argument_->Execute(closure, context), context);
+    }
+
+    Concat::Concat(std::vector<std::unique_ptr<Statement>> operands)
+            : operands_(std::move(operands))
+            , stringified_(operands_.size()) {
+        for (size_t i = 0; i < operands_.size(); ++i) {
+            if (auto *stringify = dynamic_cast<Stringify*>(operands_[i].get())) {
+                operands_[i] = stringify->ReleaseArgument();
+                stringified_[i] = true;
+            }
+        }
+    }
+
+    ObjectHolder Concat::Execute(Closure& closure, Context& context) {
+        ObjectHolder result = operands_.front()->Execute(closure, context);
+        size_t i = 1;
+        if (result.TryAs<runtime::String>() || stringified_.front()) {
+            const auto *head = result.TryAs<runtime::String>();
+            const bool keep_head = head && head->Size() >= runtime::String::ROPE_MIN_SIZE;
+            runtime::StringBuilder builder;
+            builder.Reserve(operands_.size());
+            if (!keep_head) {
+                builder.Append(result, context);
+            }
+            ObjectHolder operand;
+            for (; i < operands_.size(); ++i) {
+                operand = operands_[i]->Execute(closure, context);
+                if (!stringified_[i] && !operand.TryAs<runtime::String>()) {
+                    break;
+                }
+                builder.Append(operand, context);
+            }
+            if (keep_head) {
+                result = ObjectHolder::Own(runtime::String::Concat(*head, builder.Build()));
+            }
+            else {
+                result = ObjectHolder::Own(builder.Build());
+            }
+            if (i < operands_.size()) {
+                result = runtime::Add(result, operand, context);
+                ++i;
+            }
+        }
+        for (; i < operands_.size(); ++i) {
+            ObjectHolder operand = operands_[i]->Execute(closure, context);
+            result = runtime::Add(result, stringified_[i] ? runtime::ToString(operand, context) : operand, context);
+        }
+        return result;
+    }
+
+    void Concat::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &operand : operands_) {
+            visitor(operand);
+        }
+    }
+
+    Join::Join(std::vector<std::unique_ptr<Statement>> args)
+            : args_(std::move(args)) {
+    }
+
+    ObjectHolder Join::Execute(Closure& closure, Context& context) {
+        ObjectHolder separator_holder = args_.front()->Execute(closure, context);
+        const auto *separator = separator_holder.TryAs<runtime::String>();
+        if (!separator) {
+            throw runtime_error("join separator must be a string");
+        }
+        const string_view sep = separator->GetView();
+
+        runtime::StringBuilder builder;
+        if (args_.size() == 2) {
+            ObjectHolder item = args_.back()->Execute(closure, context);
+            if (const auto *list = item.TryAs<runtime::List>()) {
+                builder.Reserve(list->Size() * 2);
+                for (size_t i = 0; i < list->Size(); ++i) {
+                    if (i > 0) {
+                        builder.Append(sep);
+                    }
+                    builder.Append(list->GetItems()[i], context);
+                }
+                return ObjectHolder::Own(builder.Build());
+            }
+            builder.Append(item, context);
+            return ObjectHolder::Own(builder.Build());
+        }
+
+        builder.Reserve(args_.size() * 2);
+        for (size_t i = 1; i < args_.size(); ++i) {
+            if (i > 1) {
+                builder.Append(sep);
+            }
+            builder.Append(args_[i]->Execute(closure, context), context);
+        }
+        return ObjectHolder::Own(builder.Build());
+    }
+
+    void Join::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    Format::Format(std::vector<std::unique_ptr<Statement>> args)
+            : args_(std::move(args)) {
+    }
+
+    ObjectHolder Format::Execute(Closure& closure, Context& context) {
+        ObjectHolder format_holder = args_.front()->Execute(closure, context);
+        const auto *format_string = format_holder.TryAs<runtime::String>();
+        if (!format_string) {
+            throw runtime_error("format string must be a string");
+        }
+        const string_view format = format_string->GetView();
+
+        runtime::StringBuilder builder;
+        builder.Reserve(args_.size() * 2 + 1);
+        size_t next_arg = 1;
+        size_t literal_start = 0;
+        for (size_t pos = 0; pos < format.size(); ++pos) {
+            const char c = format[pos];
+            if (c != '{' && c != '}') {
+                continue;
+            }
+            builder.Append(format.substr(literal_start, pos - literal_start));
+            if (pos + 1 < format.size() && format[pos + 1] == c) {
+                // {{ или }}: в результат попадает один символ
+                builder.Append(format.substr(pos, 1));
+            }
+            else if (c == '{' && pos + 1 < format.size() && format[pos + 1] == '}') {
+                if (next_arg == args_.size()) {
+                    throw runtime_error("not enough arguments for format string");
+                }
+                builder.Append(args_[next_arg++]->Execute(closure, context), context);
+            }
+            else {
+                throw runtime_error("single '"s + c + "' in format string"s);
+            }
+            literal_start = ++pos + 1;
+        }
+        if (next_arg != args_.size()) {
+            throw runtime_error("too many arguments for format string");
+        }
+        builder.Append(format.substr(literal_start));
+        return ObjectHolder::Own(builder.Build());
+    }
+
+    void Format::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    NewRange::NewRange(std::vector<std::unique_ptr<Statement>> args)
+            : args_(std::move(args)) {
+    }
+
+    ObjectHolder NewRange::Execute(Closure& closure, Context& context) {
+        int64_t values[3] = {0, 0, 1};
+        for (size_t i = 0; i < args_.size(); ++i) {
+            ObjectHolder arg = args_[i]->Execute(closure, context);
+            const auto *number = arg.TryAs<runtime::Number>();
+            if (!number) {
+                throw runtime_error("range arguments must be integers");
+            }
+            values[i] = number->GetValue();
+        }
+        if (args_.size() == 1) {
+            return ObjectHolder::Own(runtime::Range{0, values[0]});
+        }
+        return ObjectHolder::Own(runtime::Range{values[0], values[1], values[2]});
+    }
+
+    void NewRange::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    Spawn::Spawn(const runtime::Class& cls, std::vector<std::unique_ptr<Statement>> args)
+            : class_(cls)
+            , args_(std::move(args)) {
+    }
+
+    ObjectHolder Spawn::Execute(Closure& closure, Context& context) {
+        runtime::Isolate *isolate = context.GetIsolate();
+        if (!isolate) {
+            throw runtime_error("spawn() is only available when the program runs in an isolate pool");
+        }
+        ArgumentBuffer args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            args[i] = args_[i]->Execute(closure, context);
+        }
+        return isolate->Spawn(class_, args.Data(), args.Size(), context);
+    }
+
+    void Spawn::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    Send::Send(std::unique_ptr<Statement> target, std::unique_ptr<Statement> message)
+            : target_(std::move(target))
+            , message_(std::move(message)) {
+    }
+
+    ObjectHolder Send::Execute(Closure& closure, Context& context) {
+        runtime::Isolate *isolate = context.GetIsolate();
+        if (!isolate) {
+            throw runtime_error("send() is only available when the program runs in an isolate pool");
+        }
+        ObjectHolder target = target_->Execute(closure, context);
+        isolate->Send(target, message_->Execute(closure, context), context);
+        return ObjectHolder::None();
+    }
+
+    void Send::ForEachChild(const ChildVisitor& visitor) {
+        visitor(target_);
+        visitor(message_);
+    }
+
+    ObjectHolder Receive::Execute(Closure& /*closure*/, Context& context) {
+        runtime::Isolate *isolate = context.GetIsolate();
+        if (!isolate) {
+            throw runtime_error("recv() is only available when the program runs in an isolate pool");
+        }
+        return isolate->Receive();
+    }
+
+    SpawnTask::SpawnTask(std::unique_ptr<Statement> object, std::string method,
+                         std::vector<std::unique_ptr<Statement>> args)
+            : object_(std::move(object))
+            , method_(std::move(method))
+            , args_(std::move(args)) {
+    }
+
+    ObjectHolder SpawnTask::Execute(Closure& closure, Context& context) {
+        runtime::TaskPool *pool = context.GetTaskPool();
+        if (!pool) {
+            throw runtime_error("spawn is only available when the program runs in a task pool");
+        }
+        ObjectHolder object = object_->Execute(closure, context);
+        const auto *instance = object.TryAs<runtime::ClassInstance>();
+        if (!instance) {
+            throw runtime_error("spawn expects a method call of a class instance");
+        }
+        const runtime::Method *method = instance->GetClass().GetMethod(method_);
+        if (!method || method->formal_params.size() != args_.size()) {
+            throw runtime_error("Class "s + instance->GetClass().GetName() + " hasn't got method "s + method_
+                                + " with "s + to_string(args_.size()) + " arguments"s);
+        }
+        vector<ObjectHolder> args;
+        args.reserve(args_.size());
+        for (auto &arg : args_) {
+            args.push_back(arg->Execute(closure, context));
+        }
+        return pool->Spawn(std::move(object), *method, std::move(args), context);
+    }
+
+    void SpawnTask::ForEachChild(const ChildVisitor& visitor) {
+        visitor(object_);
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    ObjectHolder JoinTask::Execute(Closure& closure, Context& context) {
+        runtime::TaskPool *pool = context.GetTaskPool();
+        if (!pool) {
+            throw runtime_error("join(future) is only available when the program runs in a task pool");
+        }
+        return pool->Join(argument_->Execute(closure, context), context);
+    }
+
+    ParallelOperation::ParallelOperation(Kind kind, std::vector<std::unique_ptr<Statement>> args)
+            : kind_(kind)
+            , args_(std::move(args)) {
+    }
+
+    ObjectHolder ParallelOperation::Execute(Closure& closure, Context& context) {
+        vector<ObjectHolder> args;
+        args.reserve(args_.size());
+        for (auto &arg : args_) {
+            args.push_back(arg->Execute(closure, context));
+        }
+        const auto *method = args[1].TryAs<runtime::String>();
+        if (!method) {
+            throw runtime_error("parallel operations expect a method name string as the second argument");
+        }
+        const size_t grain_index = kind_ == Kind::kReduce ? 4 : 3;
+        size_t grain = 0;
+        if (args.size() > grain_index) {
+            const auto *number = args[grain_index].TryAs<runtime::Number>();
+            if (!number || number->GetValue() < 1) {
+                throw runtime_error("grain of a parallel operation must be a positive number");
+            }
+            grain = static_cast<size_t>(number->GetValue());
+        }
+        const string name{method->GetValue()};
+        switch (kind_) {
+            case Kind::kMap:
+                return runtime::ParallelMap(args[0], name, args[2], grain, context);
+            case Kind::kFilter:
+                return runtime::ParallelFilter(args[0], name, args[2], grain, context);
+            case Kind::kReduce:
+                return runtime::ParallelReduce(args[0], name, args[2], args[3], grain, context);
+        }
+        return {};
+    }
+
+    void ParallelOperation::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
+    ObjectHolder NewIntArray::Execute(Closure& closure, Context& context) {
+        ObjectHolder argument = argument_->Execute(closure, context);
+        if (const auto *number = argument.TryAs<runtime::Number>()) {
+            if (number->GetValue() < 0) {
+                throw runtime_error("intarray size must not be negative");
+            }
+            return ObjectHolder::Own(runtime::IntArray{vector<int64_t>(static_cast<size_t>(number->GetValue()))});
+        }
+        if (const auto *array = argument.TryAs<runtime::IntArray>()) {
+            return ObjectHolder::Own(runtime::IntArray{array->GetValues()});
+        }
+
+        vector<int64_t> values;
+        if (const auto *range = argument.TryAs<runtime::Range>()) {
+            for (int64_t value = range->GetStart(); range->Continues(value);) {
+                values.push_back(value);
+                if (!runtime::CheckedAdd(value, range->GetStep(), value)) {
+                    break;
+                }
+            }
+        }
+        else if (const auto *list = argument.TryAs<runtime::List>()) {
+            values.reserve(list->Size());
+            for (const ObjectHolder &item : list->GetItems()) {
+                const auto *number = item.TryAs<runtime::Number>();
+                if (!number) {
+                    throw runtime_error("intarray items must be integers");
+                }
+                values.push_back(number->GetValue());
+            }
         }
         else {
-            buf << "None";
+            throw runtime_error("intarray() argument must be a size, list, range or intarray");
         }
-        return ObjectHolder::Own(runtime::String{buf.str()});
+        return ObjectHolder::Own(runtime::IntArray{std::move(values)});
     }
 
-    ObjectHolder Add::Execute(Closure& closure, Context& context) {
-        ObjectHolder object1 = lhs_->Execute(closure, context);
-        ObjectHolder object2 = rhs_->Execute(closure, context);
-        if (object1.TryAs<runtime::Number>() && object2.TryAs<runtime::Number>()) {
-            return ObjectHolder::Own(runtime::Number{object1.TryAs<runtime::Number>()->GetValue() + object2.TryAs<runtime::Number>()->GetValue()});
+    NewList::NewList(std::vector<std::unique_ptr<Statement>> items)
+            : items_(std::move(items)) {
+    }
+
+    ObjectHolder NewList::Execute(Closure& closure, Context& context) {
+        std::vector<ObjectHolder> items;
+        items.reserve(items_.size());
+        for (const auto &item : items_) {
+            items.push_back(item->Execute(closure, context));
         }
-        else if (object1.TryAs<runtime::String>() && object2.TryAs<runtime::String>()) {
-            return ObjectHolder::Own(runtime::String{object1.TryAs<runtime::String>()->GetValue() + object2.TryAs<runtime::String>()->GetValue()});
+        return ObjectHolder::Own(runtime::List{std::move(items)});
+    }
+
+    void NewList::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &item : items_) {
+            visitor(item);
         }
-        else if (object1.TryAs<runtime::ClassInstance>()
-                 && object1.TryAs<runtime::ClassInstance>()->HasMethod(ADD_METHOD, 1)) {
-            return object1.TryAs<runtime::ClassInstance>()->Call(ADD_METHOD, {object2}, context);
+    }
+
+    NewDict::NewDict(std::vector<std::unique_ptr<Statement>> keys, std::vector<std::unique_ptr<Statement>> values)
+            : keys_(std::move(keys))
+            , values_(std::move(values)) {
+    }
+
+    ObjectHolder NewDict::Execute(Closure& closure, Context& context) {
+        runtime::Dict dict;
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            ObjectHolder key = keys_[i]->Execute(closure, context);
+            dict.Set(std::move(key), values_[i]->Execute(closure, context), context);
+        }
+        return ObjectHolder::Own(std::move(dict));
+    }
+
+    void NewDict::ForEachChild(const ChildVisitor& visitor) {
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            visitor(keys_[i]);
+            visitor(values_[i]);
+        }
+    }
+
+    ItemValue::ItemValue(std::unique_ptr<Statement> object, std::unique_ptr<Statement> index)
+            : object_(std::move(object))
+            , index_(std::move(index)) {
+    }
+
+    ObjectHolder ItemValue::Execute(Closure& closure, Context& context) {
+        ObjectHolder object = object_->Execute(closure, context);
+        ObjectHolder index = index_->Execute(closure, context);
+        if (const auto *dict = object.TryAs<runtime::Dict>()) {
+            if (const ObjectHolder *value = dict->Find(index, context)) {
+                return *value;
+            }
+            throw runtime_error("key not found in dict");
+        }
+        if (const auto *array = object.TryAs<runtime::IntArray>()) {
+            return ObjectHolder::Own(runtime::Number{array->At(AsIndex(index))});
+        }
+        if (const auto *str = object.TryAs<runtime::String>()) {
+            const auto size = static_cast<int64_t>(str->Size());
+            int64_t position = AsIndex(index);
+            position = position < 0 ? position + size : position;
+            if (position < 0 || position >= size) {
+                throw runtime_error("string index out of range");
+            }
+            return ObjectHolder::Own(str->Substr(static_cast<size_t>(position), 1));
+        }
+        return AsList(object).At(AsIndex(index));
+    }
+
+    void ItemValue::ForEachChild(const ChildVisitor& visitor) {
+        visitor(object_);
+        visitor(index_);
+    }
+
+    Slice::Slice(std::unique_ptr<Statement> object, std::unique_ptr<Statement> start,
+                 std::unique_ptr<Statement> stop)
+            : object_(std::move(object))
+            , start_(std::move(start))
+            , stop_(std::move(stop)) {
+    }
+
+    ObjectHolder Slice::Execute(Closure& closure, Context& context) {
+        ObjectHolder object = object_->Execute(closure, context);
+        const auto *str = object.TryAs<runtime::String>();
+        if (!str) {
+            throw runtime_error("only strings can be sliced");
+        }
+        const auto size = static_cast<int64_t>(str->Size());
+        auto bound = [&](const unique_ptr<Statement>& statement, int64_t missing) {
+            if (!statement) {
+                return missing;
+            }
+            ObjectHolder value = statement->Execute(closure, context);
+            const auto *number = value.TryAs<runtime::Number>();
+            if (!number) {
+                throw runtime_error("slice indices must be integers");
+            }
+            const int64_t position = number->GetValue() < 0 ? number->GetValue() + size : number->GetValue();
+            return clamp<int64_t>(position, 0, size);
+        };
+        const int64_t start = bound(start_, 0);
+        const int64_t stop = max(bound(stop_, size), start);
+        return ObjectHolder::Own(str->Substr(static_cast<size_t>(start), static_cast<size_t>(stop - start)));
+    }
+
+    void Slice::ForEachChild(const ChildVisitor& visitor) {
+        visitor(object_);
+        if (start_) {
+            visitor(start_);
+        }
+        if (stop_) {
+            visitor(stop_);
+        }
+    }
+
+    ItemAssignment::ItemAssignment(std::unique_ptr<Statement> object, std::unique_ptr<Statement> index,
+                                   std::unique_ptr<Statement> rv)
+            : object_(std::move(object))
+            , index_(std::move(index))
+            , rv_(std::move(rv)) {
+    }
+
+    ObjectHolder ItemAssignment::Execute(Closure& closure, Context& context) {
+        ObjectHolder object = object_->Execute(closure, context);
+        ObjectHolder index = index_->Execute(closure, context);
+        ObjectHolder value = rv_->Execute(closure, context);
+        if (auto *dict = object.TryAs<runtime::Dict>()) {
+            dict->Set(std::move(index), value, context);
+        }
+        else if (auto *array = object.TryAs<runtime::IntArray>()) {
+            const auto *number = value.TryAs<runtime::Number>();
+            if (!number) {
+                throw runtime_error("intarray items must be integers");
+            }
+            array->Set(AsIndex(index), number->GetValue());
         }
         else {
-            throw runtime_error("non-summable types");
+            AsList(object).Set(AsIndex(index), value);
         }
+        return value;
     }
 
-    ObjectHolder Sub::Execute(Closure& closure, Context& context) {
+    void ItemAssignment::ForEachChild(const ChildVisitor& visitor) {
+        visitor(object_);
+        visitor(index_);
+        visitor(rv_);
+    }
+
+    ObjectHolder Len::Execute(Closure& closure, Context& context) {
+        ObjectHolder argument = argument_->Execute(closure, context);
+        if (const auto *list = argument.TryAs<runtime::List>()) {
+            return ObjectHolder::Own(runtime::Number{static_cast<int64_t>(list->Size())});
+        }
+        if (const auto *dict = argument.TryAs<runtime::Dict>()) {
+            return ObjectHolder::Own(runtime::Number{static_cast<int64_t>(dict->Size())});
+        }
+        if (const auto *array = argument.TryAs<runtime::IntArray>()) {
+            return ObjectHolder::Own(runtime::Number{static_cast<int64_t>(array->Size())});
+        }
+        if (const auto *str = argument.TryAs<runtime::String>()) {
+            return ObjectHolder::Own(runtime::Number{static_cast<int64_t>(str->Size())});
+        }
+        throw runtime_error("object has no len()");
+    }
+
+    Specialization BinaryOperation::Observe(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
+            return Specialization::kNumbers;
+        }
+        if (lhs.TryAs<runtime::String>() && rhs.TryAs<runtime::String>()) {
+            return Specialization::kStrings;
+        }
+        if (lhs.TryAs<runtime::ClassInstance>()) {
+            return Specialization::kInstance;
+        }
+        return Specialization::kGeneric;
+    }
+
+    ObjectHolder Add::Execute(Closure& closure, Context& context) {
         ObjectHolder object1 = lhs_->Execute(closure, context);
         ObjectHolder object2 = rhs_->Execute(closure, context);
-        if (object1.TryAs<runtime::Number>() && object2.TryAs<runtime::Number>()) {
-            return ObjectHolder::Own(runtime::Number{object1.TryAs<runtime::Number>()->GetValue() - object2.TryAs<runtime::Number>()->GetValue()});
+        switch (state_) {
+            case Specialization::kNumbers:
+                if (ObjectHolder result = NumbersFastPath(object1, object2, runtime::CheckedAdd,
+                                                          [&context](const ObjectHolder& lhs, const ObjectHolder& rhs) {
+                                                              return runtime::Add(lhs, rhs, context);
+                                                          })) {
+                    return result;
+                }
+                break;
+            case Specialization::kStrings: {
+                const auto *lhs = object1.TryAs<runtime::String>();
+                const auto *rhs = object2.TryAs<runtime::String>();
+                if (lhs && rhs) {
+                    return ObjectHolder::Own(runtime::String::Concat(*lhs, *rhs));
+                }
+                break;
+            }
+            case Specialization::kInstance:
+                if (auto *lhs = object1.TryAs<runtime::ClassInstance>()) {
+                    return lhs->Call(ADD_METHOD, {object2}, context);
+                }
+                break;
+            case Specialization::kUninitialized:
+                state_ = Observe(object1, object2);
+                return runtime::Add(object1, object2, context);
+            case Specialization::kGeneric:
+                return runtime::Add(object1, object2, context);
         }
-        else {
-            throw runtime_error("incorrect types for subtraction");
+        state_ = Specialization::kGeneric;
+        return runtime::Add(object1, object2, context);
+    }
+
+    ObjectHolder Sub::Execute(Closure& closure, Context& context) {
+        ObjectHolder object1 = lhs_->Execute(closure, context);
+        ObjectHolder object2 = rhs_->Execute(closure, context);
+        if (state_ != Specialization::kGeneric) {
+            if (ObjectHolder result = NumbersFastPath(object1, object2, runtime::CheckedSub, runtime::Sub)) {
+                state_ = Specialization::kNumbers;
+                return result;
+            }
+            state_ = Specialization::kGeneric;
         }
+        return runtime::Sub(object1, object2);
     }
 
     ObjectHolder Mult::Execute(Closure& closure, Context& context) {
         ObjectHolder object1 = lhs_->Execute(closure, context);
         ObjectHolder object2 = rhs_->Execute(closure, context);
-        if (object1.TryAs<runtime::Number>() && object2.TryAs<runtime::Number>()) {
-            return ObjectHolder::Own(runtime::Number{object1.TryAs<runtime::Number>()->GetValue() * object2.TryAs<runtime::Number>()->GetValue()});
-        }
-        else {
-            throw runtime_error("incorrect types for multiplying");
+        if (state_ != Specialization::kGeneric) {
+            if (ObjectHolder result = NumbersFastPath(object1, object2, runtime::CheckedMult, runtime::Mult)) {
+                state_ = Specialization::kNumbers;
+                return result;
+            }
+            state_ = Specialization::kGeneric;
         }
+        return runtime::Mult(object1, object2);
     }
 
     ObjectHolder Div::Execute(Closure& closure, Context& context) {
         ObjectHolder object1 = lhs_->Execute(closure, context);
         ObjectHolder object2 = rhs_->Execute(closure, context);
-        if (object1.TryAs<runtime::Number>() && object2.TryAs<runtime::Number>() && object2.TryAs<runtime::Number>()->GetValue() != 0) {
-            return ObjectHolder::Own(runtime::Number{object1.TryAs<runtime::Number>()->GetValue() / object2.TryAs<runtime::Number>()->GetValue()});
-        }
-        else {
-            throw runtime_error("incorrect types for subtraction");
+        if (state_ != Specialization::kGeneric) {
+            if (ObjectHolder result = NumbersFastPath(object1, object2, runtime::CheckedDiv, runtime::Div)) {
+                state_ = Specialization::kNumbers;
+                return result;
+            }
+            state_ = Specialization::kGeneric;
         }
+        return runtime::Div(object1, object2);
     }
 
     ObjectHolder Compound::Execute(Closure& closure, Context& context) {
         try {
+            const runtime::CallStack &stack = context.GetCallStack();
             for (auto &i : instructions_) {
                 i->Execute(closure, context);
+                if (stack.IsReturning()) {
+                    break;
+                }
             }
             return ObjectHolder::None();
         }
@@ -172,8 +856,20 @@ namespace ast {
         }
     }
 
+    void Compound::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &instruction : instructions_) {
+            visitor(instruction);
+        }
+    }
+
+    void Return::ForEachChild(const ChildVisitor& visitor) {
+        visitor(statement_);
+    }
+
     ObjectHolder Return::Execute(Closure& closure, Context& context) {
-        throw ReturnExeption{statement_->Execute(closure, context)};
+        ObjectHolder result = statement_->Execute(closure, context);
+        context.GetCallStack().SetReturnValue(std::move(result));
+        return ObjectHolder::None();
     }
 
     ClassDefinition::ClassDefinition(ObjectHolder cls)
@@ -186,6 +882,12 @@ namespace ast {
         return closure[cls_name];
     }
 
+    void ClassDefinition::ForEachChild(const ChildVisitor& visitor) {
+        cls_.TryAs<runtime::Class>()->ForEachMethod([&visitor](runtime::Method& method) {
+            visitor(method.body);
+        });
+    }
+
     FieldAssignment::FieldAssignment(VariableValue object, std::string field_name,
                                      std::unique_ptr<Statement> rv)
             : object_(std::move(object))
@@ -195,10 +897,22 @@ namespace ast {
 
     ObjectHolder FieldAssignment::Execute(Closure& closure, Context& context) {
         ObjectHolder object = object_.Execute(closure, context);
-        object.TryAs<runtime::ClassInstance>()->Fields()[field_name_] = rv_->Execute(closure, context);
+        object.TryAs<runtime::ClassInstance>()->MutableFields()[field_name_] = rv_->Execute(closure, context);
         return object.TryAs<runtime::ClassInstance>()->Fields()[field_name_];
     }
 
+    void FieldAssignment::ForEachChild(const ChildVisitor& visitor) {
+        visitor(rv_);
+    }
+
+    const VariableValue& FieldAssignment::GetObject() const {
+        return object_;
+    }
+
+    const std::string& FieldAssignment::GetFieldName() const {
+        return field_name_;
+    }
+
     IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
                    std::unique_ptr<Statement> else_body)
             : condition_(std::move(condition))
@@ -207,50 +921,286 @@ namespace ast {
     }
 
     ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
-        try {
-            if (condition_->Execute(closure, context).TryAs<runtime::Bool>()->GetValue()) {
-                if_body_->Execute(closure, context);
-            } else {
-                if (else_body_.get() != nullptr) {
-                    else_body_->Execute(closure, context);
-                }
+        if (condition_->EvaluateCondition(closure, context)) {
+            if_body_->Execute(closure, context);
+        } else {
+            if (else_body_.get() != nullptr) {
+                else_body_->Execute(closure, context);
             }
-            return ObjectHolder::None();
         }
-        catch (...) {
-            throw;
+        return ObjectHolder::None();
+    }
+
+    void IfElse::ForEachChild(const ChildVisitor& visitor) {
+        visitor(condition_);
+        visitor(if_body_);
+        if (else_body_) {
+            visitor(else_body_);
         }
     }
 
-    ObjectHolder Or::Execute(Closure& closure, Context& context) {
-        if (lhs_->Execute(closure, context).TryAs<runtime::Bool>()->GetValue() || rhs_->Execute(closure, context).TryAs<runtime::Bool>()->GetValue()) {
-            return ObjectHolder::Own(runtime::Bool{true});
+    While::While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body)
+            : condition_(std::move(condition))
+            , body_(std::move(body)) {
+    }
+
+    ObjectHolder While::Execute(Closure& closure, Context& context) {
+        const runtime::CallStack &stack = context.GetCallStack();
+        while (condition_->EvaluateCondition(closure, context)) {
+            body_->Execute(closure, context);
+            if (stack.IsReturning()) {
+                break;
+            }
+        }
+        return ObjectHolder::None();
+    }
+
+    void While::ForEachChild(const ChildVisitor& visitor) {
+        visitor(condition_);
+        visitor(body_);
+    }
+
+    For::For(std::string var_name, std::unique_ptr<Statement> iterable, std::unique_ptr<Statement> body)
+            : var_name_(std::move(var_name))
+            , iterable_(std::move(iterable))
+            , body_(std::move(body)) {
+    }
+
+    ObjectHolder For::Execute(Closure& closure, Context& context) {
+        // container удерживает объект, пока идёт обход: __iter__ может вернуть self без владения
+        ObjectHolder container = iterable_->Execute(closure, context);
+        ObjectHolder iterable = container;
+        if (auto *instance = container.TryAs<runtime::ClassInstance>()) {
+            if (!instance->HasMethod(ITER_METHOD, 0)) {
+                throw runtime_error("object is not iterable");
+            }
+            iterable = instance->Call(ITER_METHOD, {}, context);
+        }
+
+        if (const auto *range = iterable.TryAs<runtime::Range>()) {
+            IterateRange(*range, closure, context);
+        }
+        else if (const auto *list = iterable.TryAs<runtime::List>()) {
+            IterateList(*list, closure, context);
+        }
+        else if (const auto *dict = iterable.TryAs<runtime::Dict>()) {
+            IterateDict(*dict, closure, context);
+        }
+        else if (const auto *array = iterable.TryAs<runtime::IntArray>()) {
+            IterateIntArray(*array, closure, context);
+        }
+        else if (auto *iterator = iterable.TryAs<runtime::ClassInstance>()) {
+            IterateObject(*iterator, closure, context);
         }
         else {
-            return ObjectHolder::Own(runtime::Bool{false});
+            throw runtime_error("object is not iterable");
         }
+        return ObjectHolder::None();
     }
 
-    ObjectHolder And::Execute(Closure& closure, Context& context) {
-        if (lhs_->Execute(closure, context).TryAs<runtime::Bool>()->GetValue() && rhs_->Execute(closure, context).TryAs<runtime::Bool>()->GetValue()) {
-            return ObjectHolder::Own(runtime::Bool{true});
+    void For::IterateRange(const runtime::Range& range, Closure& closure, Context& context) {
+        const runtime::CallStack &stack = context.GetCallStack();
+        // Число, созданное циклом. Пока на него ссылаются только counter и переменная цикла,
+        // следующее значение записывается в тот же объект
+        ObjectHolder counter;
+        for (int64_t value = range.GetStart(); range.Continues(value);) {
+            ObjectHolder &var = closure[var_name_];
+            if (var.Get() == counter.Get() && counter.UseCount() == 2) {
+                counter.TryAs<runtime::Number>()->SetValue(value);
+            }
+            else {
+                counter = ObjectHolder::Own(runtime::Number{value});
+                var = counter;
+            }
+            body_->Execute(closure, context);
+            if (stack.IsReturning() || !runtime::CheckedAdd(value, range.GetStep(), value)) {
+                break;
+            }
         }
-        else {
-            return ObjectHolder::Own(runtime::Bool{false});
+    }
+
+    void For::IterateObject(runtime::ClassInstance& iterator, Closure& closure, Context& context) {
+        const runtime::Method *next = iterator.GetClass().GetMethod(NEXT_METHOD);
+        if (!next || !next->formal_params.empty()) {
+            throw runtime_error("iterator has no method __next__()");
+        }
+        const runtime::CallStack &stack = context.GetCallStack();
+        for (ObjectHolder value = iterator.Call(*next, {}, context); value;
+             value = iterator.Call(*next, {}, context)) {
+            closure[var_name_] = std::move(value);
+            body_->Execute(closure, context);
+            if (stack.IsReturning()) {
+                break;
+            }
+        }
+    }
+
+    void For::IterateList(const runtime::List& list, Closure& closure, Context& context) {
+        const runtime::CallStack &stack = context.GetCallStack();
+        for (size_t i = 0; i < list.Size(); ++i) {
+            closure[var_name_] = list.GetItems()[i];
+            body_->Execute(closure, context);
+            if (stack.IsReturning()) {
+                break;
+            }
         }
     }
 
+    void For::IterateDict(const runtime::Dict& dict, Closure& closure, Context& context) {
+        const runtime::CallStack &stack = context.GetCallStack();
+        for (size_t i = 0; i < dict.Size(); ++i) {
+            closure[var_name_] = dict.GetEntries()[i].key;
+            body_->Execute(closure, context);
+            if (stack.IsReturning()) {
+                break;
+            }
+        }
+    }
+
+    void For::IterateIntArray(const runtime::IntArray& array, Closure& closure, Context& context) {
+        // Как и в IterateRange, число переиспользуется, пока на него нет других ссылок
+        const runtime::CallStack &stack = context.GetCallStack();
+        ObjectHolder counter;
+        for (size_t i = 0; i < array.Size(); ++i) {
+            const int64_t value = array.GetValues()[i];
+            ObjectHolder &var = closure[var_name_];
+            if (var.Get() == counter.Get() && counter.UseCount() == 2) {
+                counter.TryAs<runtime::Number>()->SetValue(value);
+            }
+            else {
+                counter = ObjectHolder::Own(runtime::Number{value});
+                var = counter;
+            }
+            body_->Execute(closure, context);
+            if (stack.IsReturning()) {
+                break;
+            }
+        }
+    }
+
+    void For::ForEachChild(const ChildVisitor& visitor) {
+        visitor(iterable_);
+        visitor(body_);
+    }
+
+    ObjectHolder Or::Execute(Closure& closure, Context& context) {
+        return ObjectHolder::Own(runtime::Bool{EvaluateCondition(closure, context)});
+    }
+
+    bool Or::EvaluateCondition(Closure& closure, Context& context) {
+        return lhs_->EvaluateCondition(closure, context) || rhs_->EvaluateCondition(closure, context);
+    }
+
+    ObjectHolder And::Execute(Closure& closure, Context& context) {
+        return ObjectHolder::Own(runtime::Bool{EvaluateCondition(closure, context)});
+    }
+
+    bool And::EvaluateCondition(Closure& closure, Context& context) {
+        return lhs_->EvaluateCondition(closure, context) && rhs_->EvaluateCondition(closure, context);
+    }
+
     ObjectHolder Not::Execute(Closure& closure, Context& context) {
-        return ObjectHolder::Own(runtime::Bool{!argument_->Execute(closure, context).TryAs<runtime::Bool>()->GetValue()});
+        return ObjectHolder::Own(runtime::Bool{EvaluateCondition(closure, context)});
+    }
+
+    bool Not::EvaluateCondition(Closure& closure, Context& context) {
+        return !argument_->EvaluateCondition(closure, context);
     }
 
     Comparison::Comparison(Comparator cmp, unique_ptr<Statement> lhs, unique_ptr<Statement> rhs)
             : BinaryOperation(std::move(lhs), std::move(rhs))
             , cmp_(std::move(cmp)) {
+        using ComparatorFn = bool (*)(const ObjectHolder&, const ObjectHolder&, Context&);
+        if (const auto *fn = cmp_.target<ComparatorFn>()) {
+            if (*fn == &runtime::Equal) {
+                kind_ = Kind::kEqual;
+            }
+            else if (*fn == &runtime::NotEqual) {
+                kind_ = Kind::kNotEqual;
+            }
+            else if (*fn == &runtime::Less) {
+                kind_ = Kind::kLess;
+            }
+            else if (*fn == &runtime::Greater) {
+                kind_ = Kind::kGreater;
+            }
+            else if (*fn == &runtime::LessOrEqual) {
+                kind_ = Kind::kLessOrEqual;
+            }
+            else if (*fn == &runtime::GreaterOrEqual) {
+                kind_ = Kind::kGreaterOrEqual;
+            }
+        }
+        if (kind_ == Kind::kCustom) {
+            state_ = Specialization::kGeneric;
+        }
+    }
+
+    template <typename T>
+    bool Comparison::Compare(const T& lhs, const T& rhs) const {
+        switch (kind_) {
+            case Kind::kEqual:
+                return lhs == rhs;
+            case Kind::kNotEqual:
+                return lhs != rhs;
+            case Kind::kLess:
+                return lhs < rhs;
+            case Kind::kGreater:
+                return rhs < lhs;
+            case Kind::kLessOrEqual:
+                return !(rhs < lhs);
+            case Kind::kGreaterOrEqual:
+                return !(lhs < rhs);
+            case Kind::kCustom:
+                break;
+        }
+        throw runtime_error("unknown comparison");
+    }
+
+    Comparison::Kind Comparison::GetKind() const {
+        return kind_;
+    }
+
+    const Comparison::Comparator& Comparison::GetComparator() const {
+        return cmp_;
     }
 
     ObjectHolder Comparison::Execute(Closure& closure, Context& context) {
-        return ObjectHolder::Own(runtime::Bool{cmp_(lhs_->Execute(closure, context), rhs_->Execute(closure, context), context)});
+        return ObjectHolder::Own(runtime::Bool{EvaluateCondition(closure, context)});
+    }
+
+    bool Comparison::EvaluateCondition(Closure& closure, Context& context) {
+        ObjectHolder object1 = lhs_->Execute(closure, context);
+        ObjectHolder object2 = rhs_->Execute(closure, context);
+        switch (state_) {
+            case Specialization::kNumbers: {
+                const auto *lhs = object1.TryAs<runtime::Number>();
+                const auto *rhs = object2.TryAs<runtime::Number>();
+                if (lhs && rhs) {
+                    return Compare(lhs->GetValue(), rhs->GetValue());
+                }
+                state_ = Specialization::kGeneric;
+                break;
+            }
+            case Specialization::kStrings: {
+                const auto *lhs = object1.TryAs<runtime::String>();
+                const auto *rhs = object2.TryAs<runtime::String>();
+                if (lhs && rhs) {
+                    return Compare(*lhs, *rhs);
+                }
+                state_ = Specialization::kGeneric;
+                break;
+            }
+            case Specialization::kUninitialized: {
+                const Specialization observed = Observe(object1, object2);
+                state_ = observed == Specialization::kInstance ? Specialization::kGeneric : observed;
+                break;
+            }
+            case Specialization::kInstance:
+            case Specialization::kGeneric:
+                break;
+        }
+        return cmp_(object1, object2, context);
     }
 
     NewInstance::NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args)
@@ -275,18 +1225,38 @@ namespace ast {
         return object;
     }
 
+    void NewInstance::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+    }
+
     MethodBody::MethodBody(std::unique_ptr<Statement>&& body)
             : body_(std::move(body))
     {
     }
 
+    void MethodBody::ForEachChild(const ChildVisitor& visitor) {
+        visitor(body_);
+    }
+
     ObjectHolder MethodBody::Execute(Closure& closure, Context& context) {
-        try {
-            body_->Execute(closure, context);
-            return runtime::ObjectHolder::None();
-        }
-        catch (const ReturnExeption &except) {
-            return except.returned_value;
+        runtime::CallStack &stack = context.GetCallStack();
+        Statement *body = body_.get();
+        for (;;) {
+            body->Execute(closure, context);
+            if (!stack.IsReturning()) {
+                return runtime::ObjectHolder::None();
+            }
+            const runtime::Method *method = stack.TakeTailCall();
+            if (!method) {
+                return stack.TakeReturnValue();
+            }
+            auto *next = dynamic_cast<MethodBody*>(method->body.get());
+            if (!next) {
+                return method->body->Execute(closure, context);
+            }
+            body = next->body_.get();
         }
     }
 
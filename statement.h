@@ -1,32 +1,106 @@
 #pragma once
 
+#include "dict.h"
+#include "intarray.h"
+#include "module.h"
 #include "runtime.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 
 namespace ast {
 
     using Statement = runtime::Executable;
 
+// Обработчик дочерних инструкций для проходов по дереву программы (см. Executable::ForEachChild)
+    using ChildVisitor = std::function<void(std::unique_ptr<Statement>&)>;
+
+/*
+Состояние самоспециализации (quickening) узла по типам операндов.
+Первое вычисление выполняется общей веткой и запоминает наблюдаемые типы,
+дальше узел сразу идёт в быструю ветку для этих типов (например, число + число),
+проверяя лишь, что типы не изменились. Если проверка не прошла, узел навсегда
+переходит в состояние kGeneric и выполняет общую цепочку проверок типов.
+*/
+    enum class Specialization : uint8_t {
+        kUninitialized,
+        kNumbers,    // оба операнда - числа
+        kStrings,    // оба операнда - строки
+        kInstance,   // левый операнд - объект пользовательского класса (или мономорфный вызов метода)
+        kGeneric,    // типы в месте вызова менялись, специализация отключена
+    };
+
+/*
+Хранилище состояния специализации узла. Одно дерево может выполняться одновременно
+в нескольких потоках (см. mython::Program), поэтому состояние атомарно, но без блокировок.
+Специализация - лишь подсказка: быстрые ветки сами проверяют типы операндов, так что
+гонка переходов безопасна. Запись выполняется, только если значение меняется, - иначе
+каждое вычисление узла делало бы строку кэша грязной во всех потоках сразу.
+Запись публикует (release), а чтение получает (acquire) данные, записанные до неё,
+например закэшированный метод (см. InlineCache).
+Так же специализируются арифметические инструкции и сравнения байткода (см. bytecode::Chunk)
+*/
+    class SpecializationState {
+    public:
+        operator Specialization() const {  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+            return value_.load(std::memory_order_acquire);
+        }
+
+        SpecializationState& operator=(Specialization state) {
+            if (value_.load(std::memory_order_relaxed) != state) {
+                value_.store(state, std::memory_order_release);
+            }
+            return *this;
+        }
+
+        // Переводит состояние из kUninitialized в kGeneric и возвращает true, если это сделал
+        // именно этот вызов. Так ровно один поток получает право заполнить кэш узла
+        // и затем опубликовать его записью нового состояния
+        bool Claim() {
+            Specialization expected = Specialization::kUninitialized;
+            return value_.compare_exchange_strong(expected, Specialization::kGeneric, std::memory_order_acq_rel);
+        }
+
+    private:
+        std::atomic<Specialization> value_{Specialization::kUninitialized};
+    };
+
 // Выражение, возвращающее значение типа T,
 // используется как основа для создания констант
     template <typename T>
     class ValueStatement : public Statement {
     public:
         explicit ValueStatement(T v)
-                : value_(std::move(v)) {
+                : owner_(runtime::ObjectHolder::Own(std::move(v)))
+                , value_(owner_) {
         }
 
+        // Возвращает владеющую ссылку на значение константы: результат может пережить
+        // сам узел (например, str(x) возвращает строку x без копирования)
         runtime::ObjectHolder Execute(runtime::Closure& /*closure*/,
                                       runtime::Context& /*context*/) override {
-            return runtime::ObjectHolder::Share(value_);
+            return value_;
+        }
+
+        [[nodiscard]] const T& GetValue() const {
+            return static_cast<const T&>(*owner_);
+        }
+
+        // Переключает узел на невладеющие ссылки (ObjectHolder::Share): выполнение больше не изменяет
+        // счётчик ссылок константы, и потоки, выполняющие одно дерево, не конкурируют за него.
+        // После этого результаты Execute не должны переживать узел
+        void Freeze() {
+            value_ = runtime::ObjectHolder::Share(*owner_);
         }
 
     private:
-        T value_;
+        runtime::ObjectHolder owner_;
+        runtime::ObjectHolder value_;
     };
 
     using NumericConst = ValueStatement<runtime::Number>;
+    using BigNumericConst = ValueStatement<runtime::BigNumber>;
     using StringConst = ValueStatement<runtime::String>;
     using BoolConst = ValueStatement<runtime::Bool>;
 
@@ -42,6 +116,9 @@ x = circle.center.x
         explicit VariableValue(std::vector<std::string> dotted_ids);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Возвращает цепочку имён id1.id2.id3
+        [[nodiscard]] const std::vector<std::string>& GetDottedIds() const;
     };
 
 // Присваивает переменной, имя которой задано в параметре var, значение выражения rv
@@ -52,6 +129,9 @@ x = circle.center.x
         Assignment(std::string var, std::unique_ptr<Statement> rv);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::string& GetVarName() const;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Присваивает полю object.field_name значение выражения rv
@@ -63,6 +143,10 @@ x = circle.center.x
         FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const VariableValue& GetObject() const;
+        [[nodiscard]] const std::string& GetFieldName() const;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Значение None
@@ -89,6 +173,74 @@ x = circle.center.x
         // Во время выполнения команды print вывод должен осуществляться в поток, возвращаемый из
         // context.GetOutputStream()
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Значения аргументов вызова метода. До INLINE_ARGS аргументов хранятся
+// в самом буфере, без обращения к куче
+    class ArgumentBuffer {
+    public:
+        static constexpr size_t INLINE_ARGS = 6;
+
+        explicit ArgumentBuffer(size_t size)
+                : size_(size) {
+            if (size_ > INLINE_ARGS) {
+                heap_.resize(size_);
+            }
+        }
+
+        runtime::ObjectHolder& operator[](size_t index) {
+            return Data()[index];
+        }
+
+        runtime::ObjectHolder* Data() {
+            return size_ > INLINE_ARGS ? heap_.data() : inline_;
+        }
+
+        [[nodiscard]] size_t Size() const {
+            return size_;
+        }
+
+    private:
+        size_t size_;
+        runtime::ObjectHolder inline_[INLINE_ARGS];
+        std::vector<runtime::ObjectHolder> heap_;
+    };
+
+// Мономорфный inline-кэш места вызова: класс получателя при последнем вызове и найденный в нём метод.
+// Если в месте вызова встречаются разные классы, кэш отключается (Specialization::kGeneric).
+// Кэш заполняется один раз и после публикации в state_ не изменяется
+    template <typename ClassType, typename MethodType>
+    class InlineCache {
+    public:
+        // Возвращает закэшированный метод класса cls либо nullptr, если кэш пуст или класс другой
+        const MethodType* Find(const ClassType* cls) {
+            if (state_ == Specialization::kInstance) {
+                if (cls == class_) {
+                    return method_;
+                }
+                state_ = Specialization::kGeneric;
+            }
+            return nullptr;
+        }
+
+        // Запоминает метод, найденный обычным поиском, если кэш ещё не заполнен
+        void Remember(const ClassType* cls, const MethodType* method) {
+            if (state_.Claim()) {
+                class_ = cls;
+                method_ = method;
+                state_ = Specialization::kInstance;
+            }
+        }
+
+        void Disable() {
+            state_ = Specialization::kGeneric;
+        }
+
+    private:
+        SpecializationState state_;
+        const ClassType* class_ = nullptr;
+        const MethodType* method_ = nullptr;
     };
 
 // Вызывает метод object.method со списком параметров args
@@ -96,11 +248,31 @@ x = circle.center.x
         std::unique_ptr<Statement> object_;
         std::string method_;
         std::vector<std::unique_ptr<Statement>> args_;
+        InlineCache<runtime::Class, runtime::Method> cache_;
+        // Такой же кэш для объектов C++ (runtime::NativeObject)
+        InlineCache<runtime::NativeClass, runtime::NativeFunction> native_cache_;
+
+        runtime::ObjectHolder CallNative(runtime::NativeObject& object, runtime::ObjectHolder* args, size_t count,
+                                         runtime::Context& context);
     public:
         MethodCall(std::unique_ptr<Statement> object, std::string method,
                    std::vector<std::unique_ptr<Statement>> args);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+
+        [[nodiscard]] const std::string& GetMethodName() const;
+    };
+
+// Вызов функции C++, зарегистрированной в runtime::Module: name(args)
+    class NativeCall : public Statement {
+        const runtime::NativeFunction& function_;
+        std::vector<std::unique_ptr<Statement>> args_;
+    public:
+        NativeCall(const runtime::NativeFunction& function, std::vector<std::unique_ptr<Statement>> args);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 /*
@@ -124,6 +296,7 @@ p.set_name("Ivan")
         NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
         // Возвращает объект, содержащий значение типа ClassInstance
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Базовый класс для унарных операций
@@ -135,6 +308,11 @@ p.set_name("Ivan")
             : argument_(std::move(argument))
         {
         }
+
+        // Забирает аргумент у операции, после чего её нельзя выполнять
+        std::unique_ptr<Statement> ReleaseArgument();
+
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Операция str, возвращающая строковое значение своего аргумента
@@ -144,17 +322,231 @@ p.set_name("Ivan")
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
     };
 
+// Цепочка сложений operand1 + operand2 + ... + operandN, в которой есть хотя бы одна
+// строковая константа или вызов str, join или format. Создаётся парсером вместо вложенных узлов Add
+    class Concat : public Statement {
+        std::vector<std::unique_ptr<Statement>> operands_;
+        // Операнды вида str(x) хранятся как x: их строковое представление дописывается
+        // в буфер без создания промежуточной строки
+        std::vector<bool> stringified_;
+    public:
+        explicit Concat(std::vector<std::unique_ptr<Statement>> operands);
+
+        // Вычисляет операнды слева направо. Пока они являются строками, результат собирается
+        // в одном буфере без промежуточных строк. Длинный первый операнд (например, накапливаемая
+        // в цикле строка) не копируется: к нему присоединяется собранный остаток, как в String::Concat.
+        // Начиная с первого операнда, который не является строкой, сложение выполняется
+        // по одному операнду, как если бы цепочка состояла из узлов Add
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция join(sep, item1, item2, ...): строковые представления элементов, разделённые sep.
+// Если передан единственный элемент и это список, соединяются элементы списка
+    class Join : public Statement {
+        std::vector<std::unique_ptr<Statement>> args_;
+    public:
+        // Первый аргумент - разделитель; должен быть хотя бы один аргумент
+        explicit Join(std::vector<std::unique_ptr<Statement>> args);
+
+        // Если разделитель не является строкой, выбрасывает исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция format(fmt, arg1, arg2, ...): fmt, в котором каждая пара {} заменена
+// строковым представлением очередного аргумента. {{ и }} обозначают символы { и }
+    class Format : public Statement {
+        std::vector<std::unique_ptr<Statement>> args_;
+    public:
+        // Первый аргумент - строка формата; должен быть хотя бы один аргумент
+        explicit Format(std::vector<std::unique_ptr<Statement>> args);
+
+        // Если fmt не является строкой или количество {} не совпадает с количеством аргументов,
+        // выбрасывает исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция range(stop), range(start, stop) или range(start, stop, step).
+// Возвращает объект runtime::Range; аргументы должны быть числами
+    class NewRange : public Statement {
+        std::vector<std::unique_ptr<Statement>> args_;
+    public:
+        // Количество аргументов должно быть от 1 до 3
+        explicit NewRange(std::vector<std::unique_ptr<Statement>> args);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция spawn(ClassName, args...): создаёт изолят с объектом класса ClassName,
+// конструктору которого передаются копии args, и возвращает описатель изолята (см. isolate.h)
+    class Spawn : public Statement {
+        const runtime::Class& class_;
+        std::vector<std::unique_ptr<Statement>> args_;
+    public:
+        Spawn(const runtime::Class& cls, std::vector<std::unique_ptr<Statement>> args);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция send(target, message): отправляет изоляту target копию message. Возвращает None
+    class Send : public Statement {
+        std::unique_ptr<Statement> target_;
+        std::unique_ptr<Statement> message_;
+    public:
+        Send(std::unique_ptr<Statement> target, std::unique_ptr<Statement> message);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция recv(): ждёт и возвращает следующее сообщение главному изоляту
+    class Receive : public Statement {
+    public:
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+// Выражение spawn object.method(args...): запускает вызов метода как задачу пула задач
+// и возвращает её будущий результат runtime::Future (см. tasks.h)
+    class SpawnTask : public Statement {
+        std::unique_ptr<Statement> object_;
+        std::string method_;
+        std::vector<std::unique_ptr<Statement>> args_;
+    public:
+        SpawnTask(std::unique_ptr<Statement> object, std::string method, std::vector<std::unique_ptr<Statement>> args);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция join(future): дожидается задачи и возвращает её результат
+    class JoinTask : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+// Встроенные функции pmap(object, "method", items[, grain]), pfilter(object, "method", items[, grain])
+// и preduce(object, "method", items, initial[, grain]): параллельные операции над коллекцией
+// (см. runtime::ParallelMap в tasks.h)
+    class ParallelOperation : public Statement {
+    public:
+        enum class Kind : uint8_t { kMap, kFilter, kReduce };
+
+        ParallelOperation(Kind kind, std::vector<std::unique_ptr<Statement>> args);
+
+        // Если имя метода не строка или grain не положительное число, выбрасывает runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+
+    private:
+        Kind kind_;
+        std::vector<std::unique_ptr<Statement>> args_;
+    };
+
+// Встроенная функция intarray(argument). Возвращает новый объект runtime::IntArray:
+// для числа n - массив из n нулей, для списка, range или intarray - массив из их элементов,
+// которые должны быть числами int64_t
+    class NewIntArray : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+// Литерал списка [item1, item2, ...]. Возвращает новый объект runtime::List
+    class NewList : public Statement {
+        std::vector<std::unique_ptr<Statement>> items_;
+    public:
+        explicit NewList(std::vector<std::unique_ptr<Statement>> items);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Литерал словаря {key1: value1, key2: value2, ...}. Возвращает новый объект runtime::Dict
+    class NewDict : public Statement {
+        std::vector<std::unique_ptr<Statement>> keys_;
+        std::vector<std::unique_ptr<Statement>> values_;
+    public:
+        // Количество ключей и значений должно совпадать
+        NewDict(std::vector<std::unique_ptr<Statement>> keys, std::vector<std::unique_ptr<Statement>> values);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Элемент списка или intarray, символ строки либо значение словаря object[index]
+    class ItemValue : public Statement {
+        std::unique_ptr<Statement> object_;
+        std::unique_ptr<Statement> index_;
+    public:
+        ItemValue(std::unique_ptr<Statement> object, std::unique_ptr<Statement> index);
+
+        // Если object - не список, не intarray, не строка и не словарь, индекс - не число
+        // или ключа нет в словаре, выбрасывает исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Срез строки object[start:stop]. Любая из границ может отсутствовать.
+// Как и в Python, отрицательная граница отсчитывается от конца строки,
+// а выходящая за пределы строки - ограничивается ими
+    class Slice : public Statement {
+        std::unique_ptr<Statement> object_;
+        // Пустой указатель обозначает отсутствующую границу
+        std::unique_ptr<Statement> start_;
+        std::unique_ptr<Statement> stop_;
+    public:
+        Slice(std::unique_ptr<Statement> object, std::unique_ptr<Statement> start, std::unique_ptr<Statement> stop);
+
+        // Возвращает срез, который ссылается на символы исходной строки (см. runtime::String::Substr).
+        // Если object - не строка или границы - не числа, выбрасывает исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Присваивает элементу списка или intarray либо ключу словаря object[index] значение выражения rv
+    class ItemAssignment : public Statement {
+        std::unique_ptr<Statement> object_;
+        std::unique_ptr<Statement> index_;
+        std::unique_ptr<Statement> rv_;
+    public:
+        ItemAssignment(std::unique_ptr<Statement> object, std::unique_ptr<Statement> index,
+                       std::unique_ptr<Statement> rv);
+
+        // Возвращает присвоенное значение
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Встроенная функция len(argument): количество элементов списка, intarray или словаря либо символов строки
+    class Len : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
 // Родительский класс Бинарная операция с аргументами lhs и rhs
     class BinaryOperation : public Statement {
     protected:
         std::unique_ptr<Statement> lhs_;
         std::unique_ptr<Statement> rhs_;
+        SpecializationState state_;
     public:
+        // Определяет специализацию по типам операндов, вычисленных при первом выполнении узла
+        // (или инструкции байткода, см. bytecode::Chunk)
+        static Specialization Observe(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs);
+
         BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
             : lhs_(std::move(lhs))
             , rhs_(std::move(rhs))
         {
         }
+
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Возвращает результат операции + над аргументами lhs и rhs
@@ -211,6 +603,7 @@ p.set_name("Ivan")
         // Значение аргумента rhs вычисляется, только если значение lhs
         // после приведения к Bool равно False
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
     };
 
 // Возвращает результат вычисления логической операции and над lhs и rhs
@@ -220,6 +613,7 @@ p.set_name("Ivan")
         // Значение аргумента rhs вычисляется, только если значение lhs
         // после приведения к Bool равно True
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
     };
 
 // Возвращает результат вычисления логической операции not над единственным аргументом операции
@@ -227,6 +621,7 @@ p.set_name("Ivan")
     public:
         using UnaryOperation::UnaryOperation;
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
     };
 
 // Составная инструкция (например: тело метода, содержимое ветки if, либо else)
@@ -244,15 +639,10 @@ p.set_name("Ivan")
             instructions_.push_back(std::move(stmt));
         }
 
-        // Последовательно выполняет добавленные инструкции. Возвращает None
+        // Последовательно выполняет добавленные инструкции. Возвращает None.
+        // После инструкции return (см. runtime::CallStack::IsReturning) остальные инструкции не выполняются
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-    struct ReturnExeption : std::runtime_error {
-        ReturnExeption(runtime::ObjectHolder object)
-            : std::runtime_error("Returned")
-            , returned_value(std::move(object))
-        {}
-        runtime::ObjectHolder returned_value;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 // Тело метода. Как правило, содержит составную инструкцию
     class MethodBody : public Statement {
@@ -261,9 +651,11 @@ p.set_name("Ivan")
         explicit MethodBody(std::unique_ptr<Statement>&& body);
 
         // Вычисляет инструкцию, переданную в качестве body.
-        // Если внутри body была выполнена инструкция return, возвращает результат return
-        // В противном случае возвращает None
+        // Если внутри body была выполнена инструкция return, забирает из стека вызовов и возвращает
+        // результат return. В противном случае возвращает None.
+        // Хвостовые вызовы (runtime::CallStack::SetTailCall) выполняются в цикле в том же closure
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Выполняет инструкцию return с выражением statement
@@ -276,7 +668,9 @@ p.set_name("Ivan")
 
         // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
         // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
+        // Результат запоминается в стеке вызовов (runtime::CallStack::SetReturnValue), исключение не выбрасывается
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Объявляет класс
@@ -289,6 +683,9 @@ p.set_name("Ivan")
         // Создаёт внутри closure новый объект, совпадающий с именем класса и значением, переданным в
         // конструктор
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Обходит тела методов объявляемого класса
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Инструкция if <condition> <if_body> else <else_body>
@@ -302,6 +699,49 @@ p.set_name("Ivan")
                std::unique_ptr<Statement> else_body);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Инструкция while <condition>: <body>
+    class While : public Statement {
+        std::unique_ptr<Statement> condition_;
+        std::unique_ptr<Statement> body_;
+    public:
+        While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body);
+
+        // Выполняет body, пока значение condition приводится к True. Тело выполняется
+        // в текущей области видимости: очередная итерация не создаёт объектов и кадров стека.
+        // Возвращает None
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Инструкция for <var> in <iterable>: <body>
+    class For : public Statement {
+        std::string var_name_;
+        std::unique_ptr<Statement> iterable_;
+        std::unique_ptr<Statement> body_;
+
+        void IterateRange(const runtime::Range& range, runtime::Closure& closure, runtime::Context& context);
+        void IterateObject(runtime::ClassInstance& iterator, runtime::Closure& closure, runtime::Context& context);
+        void IterateList(const runtime::List& list, runtime::Closure& closure, runtime::Context& context);
+        void IterateDict(const runtime::Dict& dict, runtime::Closure& closure, runtime::Context& context);
+        void IterateIntArray(const runtime::IntArray& array, runtime::Closure& closure, runtime::Context& context);
+    public:
+        For(std::string var_name, std::unique_ptr<Statement> iterable, std::unique_ptr<Statement> body);
+
+        // Выполняет body для каждого элемента iterable, присваивая элемент переменной var
+        // в текущей области видимости. Возвращает None.
+        // Для runtime::Range элементы вычисляются по ходу цикла; число в переменной var
+        // обновляется на месте, если на него нет других ссылок.
+        // Список обходится по индексам, поэтому элементы, добавленные в теле цикла, тоже будут пройдены.
+        // Для словаря так же обходятся ключи в порядке вставки.
+        // Элементы intarray упаковываются в число по одному, как и значения range.
+        // Для объекта класса вызывается метод __iter__(), а у полученного итератора - метод
+        // __next__() до тех пор, пока он не вернёт None.
+        // Для остальных значений выбрасывается исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
     };
 
 // Операция сравнения
@@ -310,8 +750,15 @@ p.set_name("Ivan")
         // Comparator задаёт функцию, выполняющую сравнение значений аргументов
         using Comparator = std::function<bool(const runtime::ObjectHolder&,
                                               const runtime::ObjectHolder&, runtime::Context&)>;
+        // Вид сравнения, распознанный по comparator; для известных функций сравнения из runtime
+        // специализированные ветки сравнивают числа и строки напрямую, минуя comparator
+        enum class Kind : uint8_t { kEqual, kNotEqual, kLess, kGreater, kLessOrEqual, kGreaterOrEqual, kCustom };
     private:
         Comparator cmp_;
+        Kind kind_ = Kind::kCustom;
+
+        template <typename T>
+        [[nodiscard]] bool Compare(const T& lhs, const T& rhs) const;
     public:
 
         Comparison(Comparator cmp, std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
@@ -319,6 +766,12 @@ p.set_name("Ivan")
         // Вычисляет значение выражений lhs и rhs и возвращает результат работы comparator,
         // приведённый к типу runtime::Bool
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Вычисляет результат сравнения, не создавая объект runtime::Bool
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) final;
+
+        [[nodiscard]] Kind GetKind() const;
+        [[nodiscard]] const Comparator& GetComparator() const;
     };
 
 }  // namespace ast
\ No newline at end of file
@@ -215,6 +215,51 @@ namespace ast {
             ASSERT(context.output.str().empty());
         }
 
+        void TestStringifyConversions() {
+            runtime::DummyContext context;
+            Closure closure = {{"s"s, ObjectHolder::Own(runtime::String{"text"s})},
+                               {"min"s, ObjectHolder::Own(runtime::Number{std::numeric_limits<int64_t>::min()})}};
+
+            auto same = Stringify(make_unique<VariableValue>("s"s)).Execute(closure, context);
+            ASSERT_EQUAL(same.Get(), closure.at("s"s).Get());
+
+            ASSERT_OBJECT_VALUE_EQUAL(Stringify(make_unique<VariableValue>("min"s)).Execute(closure, context),
+                                      "-9223372036854775808"s);
+            ASSERT_OBJECT_VALUE_EQUAL(Stringify(make_unique<BoolConst>(true)).Execute(closure, context), "True"s);
+            ASSERT_OBJECT_VALUE_EQUAL(Stringify(make_unique<BoolConst>(false)).Execute(closure, context), "False"s);
+
+            vector<runtime::Method> methods;
+            methods.push_back({"__str__"s, {}, make_unique<None>()});
+            runtime::Class cls("NoneString"s, std::move(methods), nullptr);
+            auto result = Stringify(make_unique<NewInstance>(cls)).Execute(closure, context);
+            ASSERT(result.TryAs<runtime::String>());
+            ASSERT_OBJECT_VALUE_EQUAL(result, "None"s);
+
+            ASSERT(context.output.str().empty());
+        }
+
+        void TestJoinFormatKeepSlices() {
+            runtime::DummyContext context;
+            const runtime::String line{"a, b; {} = {}"s};
+            Closure closure = {{"sep"s, ObjectHolder::Own(line.Substr(1, 2))},
+                               {"fmt"s, ObjectHolder::Own(line.Substr(6, 7))}};
+            ASSERT(closure.at("sep"s).TryAs<runtime::String>()->IsSlice());
+
+            // Разделитель и строка формата читаются без копирования символов среза
+            vector<unique_ptr<Statement>> join_args;
+            join_args.push_back(make_unique<VariableValue>("sep"s));
+            join_args.push_back(make_unique<NumericConst>(1));
+            join_args.push_back(make_unique<NumericConst>(2));
+            ASSERT_OBJECT_VALUE_EQUAL(Join(std::move(join_args)).Execute(closure, context), "1, 2"s);
+            vector<unique_ptr<Statement>> format_args;
+            format_args.push_back(make_unique<VariableValue>("fmt"s));
+            format_args.push_back(make_unique<StringConst>("x"s));
+            format_args.push_back(make_unique<NumericConst>(3));
+            ASSERT_OBJECT_VALUE_EQUAL(Format(std::move(format_args)).Execute(closure, context), "x = 3"s);
+            ASSERT(closure.at("sep"s).TryAs<runtime::String>()->IsSlice());
+            ASSERT(closure.at("fmt"s).TryAs<runtime::String>()->IsSlice());
+        }
+
         void TestNumbersAddition() {
             runtime::DummyContext context;
 
@@ -453,6 +498,138 @@ namespace ast {
             test_not(false);
         }
 
+        void TestConditionsOfAnyType() {
+            Closure closure;
+            runtime::DummyContext context;
+
+            And and_statement{make_unique<NumericConst>(1), make_unique<StringConst>("x"s)};
+            ASSERT(and_statement.EvaluateCondition(closure, context));
+            ASSERT_OBJECT_VALUE_EQUAL(and_statement.Execute(closure, context), "True"s);
+
+            Or or_statement{make_unique<NumericConst>(0), make_unique<StringConst>(""s)};
+            ASSERT(!or_statement.EvaluateCondition(closure, context));
+
+            Not not_statement{make_unique<None>()};
+            ASSERT(not_statement.EvaluateCondition(closure, context));
+
+            IfElse if_else{make_unique<StringConst>("non-empty"s), make_unique<Print>(make_unique<StringConst>("if"s)),
+                           make_unique<Print>(make_unique<StringConst>("else"s))};
+            if_else.Execute(closure, context);
+            IfElse if_zero{make_unique<NumericConst>(0), make_unique<Print>(make_unique<StringConst>("if"s)),
+                           make_unique<Print>(make_unique<StringConst>("else"s))};
+            if_zero.Execute(closure, context);
+            ASSERT_EQUAL(context.output.str(), "if\nelse\n"s);
+        }
+
+        void TestWhile() {
+            runtime::DummyContext context;
+            Closure closure = {{"x"s, ObjectHolder::Own(runtime::Number(3))}};
+
+            auto body = make_unique<Compound>();
+            body->AddStatement(make_unique<Print>(make_unique<VariableValue>("x"s)));
+            body->AddStatement(make_unique<Assignment>(
+                    "x"s, make_unique<Sub>(make_unique<VariableValue>("x"s), make_unique<NumericConst>(1))));
+            While loop(make_unique<VariableValue>("x"s), std::move(body));
+
+            ASSERT(!loop.Execute(closure, context));
+            ASSERT_EQUAL(context.output.str(), "3\n2\n1\n"s);
+            ASSERT_OBJECT_VALUE_EQUAL(closure.at("x"s), 0);
+        }
+
+        void TestForRange() {
+            runtime::DummyContext context;
+            Closure closure;
+
+            // Тело сохраняет ссылку на переменную цикла на второй итерации
+            vector<unique_ptr<Statement>> args;
+            args.push_back(make_unique<NumericConst>(1));
+            args.push_back(make_unique<NumericConst>(4));
+            auto body = make_unique<IfElse>(
+                    make_unique<Comparison>(runtime::Equal, make_unique<VariableValue>("i"s), make_unique<NumericConst>(2)),
+                    make_unique<Assignment>("kept"s, make_unique<VariableValue>("i"s)), nullptr);
+            For loop("i"s, make_unique<NewRange>(std::move(args)), std::move(body));
+            loop.Execute(closure, context);
+
+            ASSERT_OBJECT_VALUE_EQUAL(closure.at("i"s), 3);
+            ASSERT_OBJECT_VALUE_EQUAL(closure.at("kept"s), 2);
+
+            // Без сторонних ссылок все итерации используют один и тот же объект Number
+            vector<unique_ptr<Statement>> counter_args;
+            counter_args.push_back(make_unique<NumericConst>(5));
+            auto observed = make_shared<set<runtime::Object*>>();
+            struct Observe : Statement {
+                shared_ptr<set<runtime::Object*>> seen;
+                ObjectHolder Execute(Closure& closure, runtime::Context&) override {
+                    seen->insert(closure.at("j"s).Get());
+                    return ObjectHolder::None();
+                }
+            };
+            auto observe = make_unique<Observe>();
+            observe->seen = observed;
+            For counter_loop("j"s, make_unique<NewRange>(std::move(counter_args)), std::move(observe));
+            counter_loop.Execute(closure, context);
+            ASSERT_EQUAL(observed->size(), 1U);
+            ASSERT_OBJECT_VALUE_EQUAL(closure.at("j"s), 4);
+
+            For not_iterable("k"s, make_unique<NumericConst>(1), make_unique<None>());
+            ASSERT_THROWS(not_iterable.Execute(closure, context), std::runtime_error);
+            vector<unique_ptr<Statement>> zero_step;
+            zero_step.push_back(make_unique<NumericConst>(0));
+            zero_step.push_back(make_unique<NumericConst>(1));
+            zero_step.push_back(make_unique<NumericConst>(0));
+            ASSERT_THROWS(NewRange(std::move(zero_step)).Execute(closure, context), std::runtime_error);
+        }
+
+        void TestSpecializedNodesFallBack() {
+            runtime::DummyContext context;
+
+            Add sum(make_unique<VariableValue>("x"s), make_unique<VariableValue>("y"s));
+            Comparison less(runtime::Less, make_unique<VariableValue>("x"s), make_unique<VariableValue>("y"s));
+            Closure closure = {{"x"s, ObjectHolder::Own(runtime::Number(2))},
+                               {"y"s, ObjectHolder::Own(runtime::Number(3))}};
+
+            for (int i = 0; i < 3; ++i) {
+                ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), 5);
+                ASSERT_OBJECT_VALUE_EQUAL(less.Execute(closure, context), "True"s);
+            }
+
+            closure["x"s] = ObjectHolder::Own(runtime::String("b"s));
+            closure["y"s] = ObjectHolder::Own(runtime::String("a"s));
+            ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), "ba"s);
+            ASSERT_OBJECT_VALUE_EQUAL(less.Execute(closure, context), "False"s);
+
+            closure["y"s] = ObjectHolder::Own(runtime::Number(1));
+            ASSERT_THROWS(sum.Execute(closure, context), std::runtime_error);
+            ASSERT_THROWS(less.Execute(closure, context), std::runtime_error);
+
+            ASSERT(context.output.str().empty());
+        }
+
+        void TestPolymorphicMethodCall() {
+            runtime::DummyContext context;
+
+            vector<runtime::Method> base_methods;
+            base_methods.push_back({"Name"s, {}, make_unique<StringConst>("base"s)});
+            runtime::Class base("Base"s, std::move(base_methods), nullptr);
+
+            vector<runtime::Method> child_methods;
+            child_methods.push_back({"Name"s, {}, make_unique<StringConst>("child"s)});
+            runtime::Class child("Child"s, std::move(child_methods), &base);
+
+            MethodCall call(make_unique<VariableValue>("x"s), "Name"s, {});
+            Closure closure = {{"x"s, ObjectHolder::Own(runtime::ClassInstance{base})}};
+            ASSERT_OBJECT_VALUE_EQUAL(call.Execute(closure, context), "base"s);
+            ASSERT_OBJECT_VALUE_EQUAL(call.Execute(closure, context), "base"s);
+
+            closure["x"s] = ObjectHolder::Own(runtime::ClassInstance{child});
+            ASSERT_OBJECT_VALUE_EQUAL(call.Execute(closure, context), "child"s);
+
+            closure["x"s] = ObjectHolder::Own(runtime::Number(1));
+            ASSERT_THROWS(call.Execute(closure, context), std::runtime_error);
+
+            ASSERT(context.output.str().empty());
+        }
+
     }  // namespace
 
     void RunUnitTests(TestRunner& tr) {
@@ -478,4 +655,20 @@ namespace ast {
         RUN_TEST(tr, ast::TestNot);
     }
 
+    void RunSpecializationTests(TestRunner& tr) {
+        RUN_TEST(tr, ast::TestSpecializedNodesFallBack);
+        RUN_TEST(tr, ast::TestPolymorphicMethodCall);
+    }
+
+    void RunStringifyTests(TestRunner& tr) {
+        RUN_TEST(tr, ast::TestStringifyConversions);
+        RUN_TEST(tr, ast::TestJoinFormatKeepSlices);
+    }
+
+    void RunControlFlowTests(TestRunner& tr) {
+        RUN_TEST(tr, ast::TestWhile);
+        RUN_TEST(tr, ast::TestForRange);
+        RUN_TEST(tr, ast::TestConditionsOfAnyType);
+    }
+
 }  // namespace ast
\ No newline at end of file
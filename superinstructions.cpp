@@ -0,0 +1,208 @@
+#include "superinstructions.h"
+
+#include <ostream>
+
+using namespace std;
+
+namespace ast {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    namespace {
+
+        // Возвращает значение переменной name, проверив, что это объект пользовательского класса
+        const ObjectHolder& FindObject(Closure& closure, const string& name) {
+            auto it = closure.find(name);
+            if (it == closure.end()) {
+                throw runtime_error("this variable doesn't exist");
+            }
+            if (!it->second.TryAs<runtime::ClassInstance>()) {
+                throw runtime_error("variable "s + name + " is not an object"s);
+            }
+            return it->second;
+        }
+
+        vector<unique_ptr<Statement>*> Children(Statement& node) {
+            vector<unique_ptr<Statement>*> result;
+            node.ForEachChild([&result](unique_ptr<Statement>& child) {
+                result.push_back(&child);
+            });
+            return result;
+        }
+
+        // Заменяет node суперинструкцией, если node подходит под один из шаблонов
+        void TryFuse(unique_ptr<Statement>& node, FusionReport& report) {
+            if (auto *var = dynamic_cast<VariableValue*>(node.get())) {
+                const auto &ids = var->GetDottedIds();
+                if (ids.size() == 2) {
+                    node = make_unique<FieldValue>(ids[0], ids[1]);
+                    ++report.field_reads;
+                }
+            }
+            else if (auto *assignment = dynamic_cast<FieldAssignment*>(node.get())) {
+                const auto &ids = assignment->GetObject().GetDottedIds();
+                if (ids.size() == 1) {
+                    auto children = Children(*assignment);
+                    node = make_unique<VariableFieldAssignment>(ids[0], assignment->GetFieldName(),
+                                                                std::move(*children[0]));
+                    ++report.field_assignments;
+                }
+            }
+            else if (auto *assignment = dynamic_cast<Assignment*>(node.get())) {
+                auto children = Children(*assignment);
+                auto *add = dynamic_cast<Add*>(children[0]->get());
+                if (!add) {
+                    return;
+                }
+                auto operands = Children(*add);
+                auto *var = dynamic_cast<VariableValue*>(operands[0]->get());
+                auto *increment = dynamic_cast<NumericConst*>(operands[1]->get());
+                if (var && increment && var->GetDottedIds().size() == 1
+                    && var->GetDottedIds().front() == assignment->GetVarName()) {
+                    node = make_unique<IncrementVariable>(assignment->GetVarName(), increment->GetValue());
+                    ++report.increments;
+                }
+            }
+            else if (auto *if_else = dynamic_cast<IfElse*>(node.get())) {
+                auto children = Children(*if_else);
+                if (!dynamic_cast<Comparison*>(children[0]->get())) {
+                    return;
+                }
+                unique_ptr<Comparison> condition(static_cast<Comparison*>(children[0]->release()));
+                node = make_unique<IfComparison>(std::move(condition), std::move(*children[1]),
+                                                 children.size() > 2 ? std::move(*children[2]) : nullptr);
+                ++report.compare_branches;
+            }
+            else if (auto *ret = dynamic_cast<Return*>(node.get())) {
+                auto children = Children(*ret);
+                auto *var = dynamic_cast<VariableValue*>(children[0]->get());
+                if (var && var->GetDottedIds().size() == 2) {
+                    const auto &ids = var->GetDottedIds();
+                    node = make_unique<ReturnField>(FieldValue{ids[0], ids[1]});
+                    ++report.field_returns;
+                }
+            }
+        }
+
+        void Fuse(unique_ptr<Statement>& node, FusionReport& report) {
+            TryFuse(node, report);
+            node->ForEachChild([&report](unique_ptr<Statement>& child) {
+                Fuse(child, report);
+            });
+        }
+
+    }  // namespace
+
+    FieldValue::FieldValue(std::string object_name, std::string field_name)
+            : object_name_(std::move(object_name))
+            , field_name_(std::move(field_name)) {
+    }
+
+    ObjectHolder FieldValue::Execute(Closure& closure, Context& /*context*/) {
+        return static_cast<runtime::ClassInstance&>(*FindObject(closure, object_name_)).Fields().at(field_name_);
+    }
+
+    const std::string& FieldValue::GetObjectName() const {
+        return object_name_;
+    }
+
+    const std::string& FieldValue::GetFieldName() const {
+        return field_name_;
+    }
+
+    VariableFieldAssignment::VariableFieldAssignment(std::string object_name, std::string field_name,
+                                                     std::unique_ptr<Statement> rv)
+            : object_name_(std::move(object_name))
+            , field_name_(std::move(field_name))
+            , rv_(std::move(rv)) {
+    }
+
+    ObjectHolder VariableFieldAssignment::Execute(Closure& closure, Context& context) {
+        // Копия удерживает объект, если вычисление rv переприсвоит переменную object_name_
+        ObjectHolder object = FindObject(closure, object_name_);
+        ObjectHolder value = rv_->Execute(closure, context);
+        return static_cast<runtime::ClassInstance&>(*object).MutableFields()[field_name_] = std::move(value);
+    }
+
+    void VariableFieldAssignment::ForEachChild(const ChildVisitor& visitor) {
+        visitor(rv_);
+    }
+
+    IncrementVariable::IncrementVariable(std::string var_name, runtime::Number increment)
+            : var_name_(std::move(var_name))
+            , increment_(std::move(increment)) {
+    }
+
+    ObjectHolder IncrementVariable::Execute(Closure& closure, Context& context) {
+        auto it = closure.find(var_name_);
+        if (it == closure.end()) {
+            throw runtime_error("this variable doesn't exist");
+        }
+        const auto *number = it->second.TryAs<runtime::Number>();
+        int64_t result = 0;
+        if (number && runtime::CheckedAdd(number->GetValue(), increment_.GetValue(), result)) {
+            it->second = ObjectHolder::Own(runtime::Number{result});
+        }
+        else {
+            it->second = runtime::Add(it->second, ObjectHolder::Share(increment_), context);
+        }
+        return it->second;
+    }
+
+    IfComparison::IfComparison(std::unique_ptr<Comparison> condition, std::unique_ptr<Statement> if_body,
+                               std::unique_ptr<Statement> else_body)
+            : condition_(std::move(condition))
+            , if_body_(std::move(if_body))
+            , else_body_(std::move(else_body)) {
+    }
+
+    ObjectHolder IfComparison::Execute(Closure& closure, Context& context) {
+        if (condition_->EvaluateCondition(closure, context)) {
+            if_body_->Execute(closure, context);
+        }
+        else if (else_body_) {
+            else_body_->Execute(closure, context);
+        }
+        return ObjectHolder::None();
+    }
+
+    void IfComparison::ForEachChild(const ChildVisitor& visitor) {
+        condition_->ForEachChild(visitor);
+        visitor(if_body_);
+        if (else_body_) {
+            visitor(else_body_);
+        }
+    }
+
+    ReturnField::ReturnField(FieldValue field)
+            : field_(std::move(field)) {
+    }
+
+    ObjectHolder ReturnField::Execute(Closure& closure, Context& context) {
+        ObjectHolder result = field_.Execute(closure, context);
+        context.GetCallStack().SetReturnValue(std::move(result));
+        return ObjectHolder::None();
+    }
+
+    size_t FusionReport::Total() const {
+        return field_reads + field_assignments + increments + compare_branches + field_returns;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const FusionReport& report) {
+        return os << "fused sites: "sv << report.Total()
+                  << " (object.field: "sv << report.field_reads
+                  << ", object.field = expr: "sv << report.field_assignments
+                  << ", x = x + const: "sv << report.increments
+                  << ", if a < b: "sv << report.compare_branches
+                  << ", return object.field: "sv << report.field_returns << ')';
+    }
+
+    FusionReport FuseSuperinstructions(std::unique_ptr<Statement>& program) {
+        FusionReport report;
+        Fuse(program, report);
+        return report;
+    }
+
+}  // namespace ast
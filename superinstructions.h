@@ -0,0 +1,87 @@
+#pragma once
+
+#include "statement.h"
+
+#include <iosfwd>
+
+// Суперинструкции - слитые узлы для самых частых сочетаний узлов дерева.
+// Каждая выполняет за один вызов Execute то, что иначе потребовало бы нескольких
+// виртуальных вызовов и повторных поисков в Closure.
+namespace ast {
+
+// Значение поля object.field, где object - переменная (например, self.x)
+    class FieldValue : public Statement {
+        std::string object_name_;
+        std::string field_name_;
+    public:
+        FieldValue(std::string object_name, std::string field_name);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::string& GetObjectName() const;
+        [[nodiscard]] const std::string& GetFieldName() const;
+    };
+
+// Присваивание object.field = rv, где object - переменная (например, self.x = rv)
+    class VariableFieldAssignment : public Statement {
+        std::string object_name_;
+        std::string field_name_;
+        std::unique_ptr<Statement> rv_;
+    public:
+        VariableFieldAssignment(std::string object_name, std::string field_name, std::unique_ptr<Statement> rv);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Инструкция x = x + <числовая константа>
+    class IncrementVariable : public Statement {
+        std::string var_name_;
+        runtime::Number increment_;
+    public:
+        IncrementVariable(std::string var_name, runtime::Number increment);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+// Инструкция if lhs <op> rhs: <if_body> else: <else_body>.
+// Результат сравнения не упаковывается в runtime::Bool
+    class IfComparison : public Statement {
+        std::unique_ptr<Comparison> condition_;
+        std::unique_ptr<Statement> if_body_;
+        std::unique_ptr<Statement> else_body_;
+    public:
+        // Параметр else_body может быть равен nullptr
+        IfComparison(std::unique_ptr<Comparison> condition, std::unique_ptr<Statement> if_body,
+                     std::unique_ptr<Statement> else_body);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Инструкция return object.field
+    class ReturnField : public Statement {
+        FieldValue field_;
+    public:
+        explicit ReturnField(FieldValue field);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+// Количество мест в программе, заменённых суперинструкциями
+    struct FusionReport {
+        size_t field_reads = 0;        // object.field
+        size_t field_assignments = 0;  // object.field = expr
+        size_t increments = 0;         // x = x + <const>
+        size_t compare_branches = 0;   // if a < b:
+        size_t field_returns = 0;      // return object.field
+
+        [[nodiscard]] size_t Total() const;
+    };
+
+    std::ostream& operator<<(std::ostream& os, const FusionReport& report);
+
+// Проходит по дереву программы и заменяет подходящие сочетания узлов суперинструкциями
+    FusionReport FuseSuperinstructions(std::unique_ptr<Statement>& program);
+
+}  // namespace ast
@@ -0,0 +1,92 @@
+#include "lexer.h"
+#include "parse.h"
+#include "superinstructions.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace ast {
+
+    namespace {
+
+        unique_ptr<Statement> ParseProgramFromString(const string& program) {
+            istringstream is(program);
+            parse::Lexer lexer(is);
+            return ParseProgram(lexer);
+        }
+
+        const string COUNTER_PROGRAM = R"(
+class Counter:
+  def __init__(limit):
+    self.value = 0
+    self.limit = limit
+
+  def get():
+    return self.value
+
+  def run(n):
+    i = n
+    i = i + 1
+    if self.value < self.limit:
+      self.value = self.value + i
+      self.run(n)
+    else:
+      print 'done', self.value
+
+c = Counter(10)
+c.run(2)
+print c.get(), c.limit
+)"s;
+
+        void TestFusionReport() {
+            auto tree = ParseProgramFromString(COUNTER_PROGRAM);
+            FusionReport report = FuseSuperinstructions(tree);
+            ASSERT_EQUAL(report.field_assignments, 3U);
+            ASSERT_EQUAL(report.field_returns, 1U);
+            ASSERT_EQUAL(report.increments, 1U);
+            ASSERT_EQUAL(report.compare_branches, 1U);
+            ASSERT_EQUAL(report.field_reads, 5U);
+            ASSERT_EQUAL(report.Total(), 11U);
+        }
+
+        void TestFusedProgramMatchesTree() {
+            for (bool fuse : {false, true}) {
+                auto tree = ParseProgramFromString(COUNTER_PROGRAM);
+                if (fuse) {
+                    FuseSuperinstructions(tree);
+                }
+                runtime::DummyContext context;
+                runtime::Closure closure;
+                tree->Execute(closure, context);
+                ASSERT_EQUAL(context.output.str(), "done 12\n12 10\n"s);
+            }
+        }
+
+        void TestIncrementFallsBackToAdd() {
+            runtime::DummyContext context;
+
+            vector<runtime::Method> methods;
+            methods.push_back({"__add__"s, {"rhs"s}, make_unique<StringConst>("added"s)});
+            runtime::Class cls("Addable"s, std::move(methods), nullptr);
+
+            IncrementVariable increment("x"s, runtime::Number{1});
+            runtime::Closure closure = {{"x"s, runtime::ObjectHolder::Own(runtime::ClassInstance{cls})}};
+            auto result = increment.Execute(closure, context);
+            ASSERT(result.TryAs<runtime::String>());
+            ASSERT_EQUAL(result.TryAs<runtime::String>()->GetValue(), "added"s);
+
+            ASSERT_THROWS(increment.Execute(closure, context), std::runtime_error);
+
+            runtime::Closure empty;
+            ASSERT_THROWS(increment.Execute(empty, context), std::runtime_error);
+        }
+
+    }  // namespace
+
+    void RunSuperinstructionTests(TestRunner& tr) {
+        RUN_TEST(tr, ast::TestFusionReport);
+        RUN_TEST(tr, ast::TestFusedProgramMatchesTree);
+        RUN_TEST(tr, ast::TestIncrementFallsBackToAdd);
+    }
+
+}  // namespace ast
@@ -0,0 +1,111 @@
+#include "tail_calls.h"
+
+using namespace std;
+
+namespace ast {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    namespace {
+
+        vector<unique_ptr<Statement>*> Children(Statement& node) {
+            vector<unique_ptr<Statement>*> result;
+            node.ForEachChild([&result](unique_ptr<Statement>& child) {
+                result.push_back(&child);
+            });
+            return result;
+        }
+
+        // Заменяет node на TailCall, если node - инструкция return object.method(args)
+        bool TryReplace(unique_ptr<Statement>& node) {
+            auto *ret = dynamic_cast<Return*>(node.get());
+            if (!ret) {
+                return false;
+            }
+            auto *call = dynamic_cast<MethodCall*>(Children(*ret)[0]->get());
+            if (!call) {
+                return false;
+            }
+            // Потомки MethodCall: сначала аргументы, последним - объект
+            auto children = Children(*call);
+            vector<unique_ptr<Statement>> args;
+            for (size_t i = 0; i + 1 < children.size(); ++i) {
+                args.push_back(std::move(*children[i]));
+            }
+            node = make_unique<TailCall>(std::move(*children.back()), call->GetMethodName(), std::move(args));
+            return true;
+        }
+
+        // in_method - находится ли node внутри тела метода. Инструкция return вне метода
+        // не является хвостовым вызовом, и её некому перехватить
+        size_t Eliminate(unique_ptr<Statement>& node, bool in_method) {
+            size_t replaced = 0;
+            if (in_method && TryReplace(node)) {
+                ++replaced;
+            }
+            const bool in_child_method = in_method || dynamic_cast<ClassDefinition*>(node.get()) != nullptr;
+            node->ForEachChild([&replaced, in_child_method](unique_ptr<Statement>& child) {
+                replaced += Eliminate(child, in_child_method);
+            });
+            return replaced;
+        }
+
+    }  // namespace
+
+    TailCall::TailCall(std::unique_ptr<Statement> object, std::string method,
+                       std::vector<std::unique_ptr<Statement>> args)
+            : object_(std::move(object))
+            , method_(std::move(method))
+            , args_(std::move(args)) {
+    }
+
+    ObjectHolder TailCall::Execute(Closure& closure, Context& context) {
+        ArgumentBuffer args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            args[i] = args_[i]->Execute(closure, context);
+        }
+        ObjectHolder object = object_->Execute(closure, context);
+        auto *instance = object.TryAs<runtime::ClassInstance>();
+        if (!instance) {
+            if (auto result = runtime::CallBuiltinMethod(object, method_, args.Data(), args.Size(), context)) {
+                context.GetCallStack().SetReturnValue(std::move(*result));
+                return ObjectHolder::None();
+            }
+            throw runtime_error("method "s + method_ + " called on a non-object value"s);
+        }
+        const runtime::Class *cls = &instance->GetClass();
+        const runtime::Method *method = cache_.Find(cls);
+        if (!method) {
+            method = cls->GetMethod(method_);
+            if (!method || method->formal_params.size() != args.Size()) {
+                cache_.Disable();
+                throw runtime_error("hasn't got this method");
+            }
+            cache_.Remember(cls, method);
+        }
+
+        // Кадр вызываемого метода строится так же, как в ClassInstance::Call,
+        // но на месте кадра текущего вызова
+        closure.clear();
+        closure["self"s] = std::move(object);
+        for (size_t i = 0; i < args.Size(); ++i) {
+            closure[method->formal_params[i]] = std::move(args[i]);
+        }
+        context.GetCallStack().SetTailCall(*method);
+        return ObjectHolder::None();
+    }
+
+    void TailCall::ForEachChild(const ChildVisitor& visitor) {
+        for (auto &arg : args_) {
+            visitor(arg);
+        }
+        visitor(object_);
+    }
+
+    size_t EliminateTailCalls(std::unique_ptr<Statement>& program) {
+        return Eliminate(program, false);
+    }
+
+}  // namespace ast
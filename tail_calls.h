@@ -0,0 +1,32 @@
+#pragma once
+
+#include "statement.h"
+
+// Устранение хвостовых вызовов. Инструкция return object.method(args) внутри метода
+// не вызывает method рекурсивно, а переиспользует кадр (closure) текущего вызова:
+// глубокая хвостовая рекурсия выполняется на постоянной глубине стека C++ и в постоянной памяти
+namespace ast {
+
+// Инструкция return object.method(args) в теле метода.
+// Вычисляет object и аргументы, заменяет содержимое closure на self и параметры вызываемого
+// метода и запоминает метод в стеке вызовов (runtime::CallStack::SetTailCall):
+// MethodBody текущего метода выполняет его тело в цикле, не выбрасывая исключений
+    class TailCall : public Statement {
+        std::unique_ptr<Statement> object_;
+        std::string method_;
+        std::vector<std::unique_ptr<Statement>> args_;
+        // Тот же inline-кэш, что и у MethodCall: return self.method(...) вызывает один и тот же метод
+        InlineCache<runtime::Class, runtime::Method> cache_;
+    public:
+        TailCall(std::unique_ptr<Statement> object, std::string method,
+                 std::vector<std::unique_ptr<Statement>> args);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void ForEachChild(const ChildVisitor& visitor) override;
+    };
+
+// Заменяет инструкции return object.method(args) в телах методов на TailCall.
+// Возвращает количество заменённых инструкций
+    size_t EliminateTailCalls(std::unique_ptr<Statement>& program);
+
+}  // namespace ast
@@ -0,0 +1,162 @@
+#include "lexer.h"
+#include "parse.h"
+#include "tail_calls.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace ast {
+
+    namespace {
+
+        unique_ptr<Statement> ParseProgramFromString(const string& program) {
+            istringstream is(program);
+            parse::Lexer lexer(is);
+            return ParseProgram(lexer);
+        }
+
+        string RunProgram(const string& program, bool eliminate) {
+            auto tree = ParseProgramFromString(program);
+            if (eliminate) {
+                EliminateTailCalls(tree);
+            }
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            tree->Execute(closure, context);
+            return context.output.str();
+        }
+
+        const string PARITY_PROGRAM = R"(
+class Parity:
+  def sum(n, acc):
+    if n == 0:
+      return acc
+    return self.sum(n - 1, acc + n)
+
+  def is_even(n):
+    if n == 0:
+      return True
+    return self.is_odd(n - 1)
+
+  def is_odd(n):
+    if n == 0:
+      return False
+    return self.is_even(n - 1)
+
+p = Parity()
+)"s;
+
+        void TestTailCallsReplaced() {
+            auto tree = ParseProgramFromString(PARITY_PROGRAM + "print p.sum(3, 0)\n"s);
+            // return acc и return вне методов не заменяются
+            ASSERT_EQUAL(EliminateTailCalls(tree), 3U);
+        }
+
+        void TestDeepTailRecursion() {
+            // Без переиспользования кадра такая глубина рекурсии переполнила бы стек
+            const string program = PARITY_PROGRAM + "print p.sum(200000, 0), p.is_even(100001)\n"s;
+            ASSERT_EQUAL(RunProgram(program, true), "20000100000 False\n"s);
+        }
+
+        void TestTailCallsMatchPlainCalls() {
+            const string program = PARITY_PROGRAM + R"(
+class Base:
+  def step(n):
+    return 'base ' + str(n)
+
+  def run(n):
+    return self.step(n)
+
+class Derived(Base):
+  def step(n):
+    if n > 0:
+      return self.run(n - 1)
+    return 'derived'
+
+class Holder:
+  def __init__(other):
+    self.other = other
+
+  def delegate():
+    return self.other.sum(4, 0)
+
+b = Base()
+d = Derived()
+h = Holder(p)
+print b.run(1), d.run(3), h.delegate(), p.is_even(10)
+)"s;
+            const string expected = "base 1 derived 10 True\n"s;
+            ASSERT_EQUAL(RunProgram(program, false), expected);
+            ASSERT_EQUAL(RunProgram(program, true), expected);
+        }
+
+        void TestTailCallStartsFreshFrame() {
+            const string program = R"(
+class Frames:
+  def first():
+    local = 1
+    return self.second()
+
+  def second():
+    return local
+
+f = Frames()
+print f.first()
+)"s;
+            ASSERT_THROWS(RunProgram(program, true), std::runtime_error);
+        }
+
+        void TestTailCallToNativeBody() {
+            runtime::DummyContext context;
+
+            vector<runtime::Method> methods;
+            methods.push_back({"name"s, {}, make_unique<StringConst>("native"s)});
+            methods.push_back({"get"s, {}, make_unique<MethodBody>(
+                    make_unique<TailCall>(make_unique<VariableValue>("self"s), "name"s,
+                                          vector<unique_ptr<Statement>>{}))});
+            runtime::Class cls("Native"s, std::move(methods), nullptr);
+            runtime::ClassInstance instance(cls);
+
+            auto result = instance.Call("get"s, {}, context);
+            ASSERT(result.TryAs<runtime::String>());
+            ASSERT_EQUAL(result.TryAs<runtime::String>()->GetValue(), "native"s);
+        }
+
+        void TestPolymorphicTailCallSite() {
+            // Одно место хвостового вызова видит разные классы получателя: кэш метода
+            // сначала запоминает класс A, затем отключается и не подставляет чужой метод
+            const string program = R"(
+class A:
+  def name(n):
+    return 'a' + str(n)
+
+class B:
+  def name(n):
+    return 'b' + str(n)
+
+class Caller:
+  def call(target, n):
+    return target.name(n)
+
+c = Caller()
+a = A()
+b = B()
+print c.call(a, 1), c.call(a, 2), c.call(b, 3), c.call(a, 4)
+)"s;
+            const string expected = "a1 a2 b3 a4\n"s;
+            ASSERT_EQUAL(RunProgram(program, false), expected);
+            ASSERT_EQUAL(RunProgram(program, true), expected);
+        }
+
+    }  // namespace
+
+    void RunTailCallTests(TestRunner& tr) {
+        RUN_TEST(tr, ast::TestTailCallsReplaced);
+        RUN_TEST(tr, ast::TestDeepTailRecursion);
+        RUN_TEST(tr, ast::TestTailCallsMatchPlainCalls);
+        RUN_TEST(tr, ast::TestTailCallStartsFreshFrame);
+        RUN_TEST(tr, ast::TestTailCallToNativeBody);
+        RUN_TEST(tr, ast::TestPolymorphicTailCallSite);
+    }
+
+}  // namespace ast
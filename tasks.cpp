@@ -0,0 +1,671 @@
+#include "tasks.h"
+
+#include "intarray.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
+using namespace std;
+
+namespace runtime {
+
+// Контекст выполнения задачи: собственный буфер вывода и стек вызовов выполняющего потока
+    class Task::ExecutionContext : public Context {
+    public:
+        ExecutionContext(TaskPool& pool, CallStack& stack)
+                : pool_(pool)
+                , stack_(stack) {
+        }
+
+        std::ostream& GetOutputStream() override {
+            return output_;
+        }
+
+        CallStack& GetCallStack() override {
+            return stack_;
+        }
+
+        TaskPool* GetTaskPool() override {
+            return &pool_;
+        }
+
+        std::string TakeOutput() {
+            return std::move(output_).str();
+        }
+
+    private:
+        TaskPool& pool_;
+        CallStack& stack_;
+        std::ostringstream output_;
+    };
+
+    namespace {
+
+        // Возвращает объекты классов roots и все объекты классов, доступные из них через поля
+        // (self.b, self.b.c и т.д.), - каждый по одному разу, циклические ссылки допускаются.
+        // Элементы списков и словарей не просматриваются
+        vector<ClassInstance*> ReachableInstances(vector<ClassInstance*> roots) {
+            vector<ClassInstance*> reachable;
+            unordered_set<const ClassInstance*> visited;
+            while (!roots.empty()) {
+                ClassInstance *instance = roots.back();
+                roots.pop_back();
+                if (!visited.insert(instance).second) {
+                    continue;
+                }
+                reachable.push_back(instance);
+                for (const auto &[name, field] : instance->Fields()) {
+                    if (auto *field_instance = field.TryAs<ClassInstance>()) {
+                        roots.push_back(field_instance);
+                    }
+                }
+            }
+            return reachable;
+        }
+
+        // Получатель и аргументы задачи, которые являются объектами классов
+        vector<ClassInstance*> TaskRoots(const ObjectHolder& receiver, const vector<ObjectHolder>& args) {
+            vector<ClassInstance*> roots{receiver.TryAs<ClassInstance>()};
+            for (const ObjectHolder &arg : args) {
+                if (auto *instance = arg.TryAs<ClassInstance>()) {
+                    roots.push_back(instance);
+                }
+            }
+            return roots;
+        }
+
+    }  // namespace
+
+    Task::Task(ObjectHolder receiver, const Method& method, std::vector<ObjectHolder> args)
+            : receiver_(std::move(receiver))
+            , method_(&method)
+            , args_(std::move(args))
+            , shared_instances_(ReachableInstances(TaskRoots(receiver_, args_))) {
+        for (ClassInstance *instance : shared_instances_) {
+            instance->BeginTaskShare();
+        }
+    }
+
+    Task::Task(Job job)
+            : job_(std::move(job)) {
+    }
+
+    bool Task::IsDone() const {
+        return done_.load(std::memory_order_acquire);
+    }
+
+    void Task::Run(TaskPool& pool, CallStack& stack) {
+        ExecutionContext context{pool, stack};
+        try {
+            if (job_) {
+                job_(context);
+            }
+            else {
+                result_ = receiver_.TryAs<ClassInstance>()->Call(*method_, static_cast<const ObjectHolder*>(args_.data()),
+                                                                 args_.size(), context);
+            }
+        }
+        catch (...) {
+            error_ = std::current_exception();
+        }
+        for (ClassInstance *instance : shared_instances_) {
+            instance->EndTaskShare();
+        }
+        output_ = context.TakeOutput();
+        // После этого задачу может уничтожить дождавшийся её поток
+        done_.store(true, std::memory_order_release);
+    }
+
+    Future::Future(std::shared_ptr<Task> task)
+            : task_(std::move(task)) {
+    }
+
+    void Future::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << "<future>"sv;
+    }
+
+    Task& Future::GetTask() const {
+        return *task_;
+    }
+
+// Контекст кода потока владельца пула: вывод, стек вызовов и изолят берутся из контекста владельца
+    class TaskPool::MainContext : public Context {
+    public:
+        MainContext(TaskPool& pool, Context& context)
+                : pool_(pool)
+                , context_(context) {
+        }
+
+        std::ostream& GetOutputStream() override {
+            return context_.GetOutputStream();
+        }
+
+        CallStack& GetCallStack() override {
+            return context_.GetCallStack();
+        }
+
+        Isolate* GetIsolate() override {
+            return context_.GetIsolate();
+        }
+
+        TaskPool* GetTaskPool() override {
+            return &pool_;
+        }
+
+    private:
+        TaskPool& pool_;
+        Context& context_;
+    };
+
+    struct TaskPool::Worker {
+        TaskPool& pool;
+        size_t index;
+        // Стек вызовов, в котором поток выполняет задачи: у потока владельца - стек контекста владельца
+        CallStack* stack;
+        CallStack own_stack;
+        WorkStealingDeque<Task> deque;
+
+        Worker(TaskPool& owner, size_t worker_index)
+                : pool(owner)
+                , index(worker_index)
+                , stack(&own_stack) {
+        }
+    };
+
+    thread_local TaskPool::Worker* TaskPool::current_worker_ = nullptr;
+
+    TaskPool::TaskPool(Context& context, size_t thread_count)
+            : context_(context)
+            , main_context_(std::make_unique<MainContext>(*this, context)) {
+        thread_count = std::max<size_t>(thread_count, 1);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers_.push_back(std::make_unique<Worker>(*this, i));
+        }
+        workers_.front()->stack = &context_.GetCallStack();
+        owner_previous_worker_ = std::exchange(current_worker_, workers_.front().get());
+    }
+
+    TaskPool::~TaskPool() {
+        // Задачи, которых не дождались, выполняются до остановки потоков
+        Worker &owner = *workers_.front();
+        while (outstanding_.load(std::memory_order_acquire) != 0) {
+            const uint64_t observed = epoch_.load();
+            if (outstanding_.load(std::memory_order_acquire) == 0) {
+                break;
+            }
+            if (Task *task = FindTask(owner)) {
+                Execute(*task, owner);
+                continue;
+            }
+            Sleep(observed);
+        }
+        (void)context_.GetCallStack().TakePendingTasks(0);
+
+        stopping_.store(true);
+        Notify();
+        for (thread &worker : threads_) {
+            worker.join();
+        }
+        current_worker_ = owner_previous_worker_;
+    }
+
+    Context& TaskPool::GetMainContext() {
+        return *main_context_;
+    }
+
+    void TaskPool::Wait() {
+        JoinPending(0, *main_context_);
+    }
+
+    size_t TaskPool::GetThreadCount() const {
+        return workers_.size();
+    }
+
+    bool TaskPool::HasStartedThreads() const {
+        return !threads_.empty();
+    }
+
+    ObjectHolder TaskPool::Spawn(ObjectHolder receiver, const Method& method, std::vector<ObjectHolder> args,
+                                 Context& context) {
+        Worker *worker = CurrentWorker();
+        if (!worker) {
+            throw runtime_error("spawn is only available in threads of the task pool");
+        }
+        if (!receiver.TryAs<ClassInstance>()) {
+            throw runtime_error("spawn expects a method call of a class instance");
+        }
+        auto task = std::make_shared<Task>(std::move(receiver), method, std::move(args));
+        ObjectHolder future = ObjectHolder::Own(Future{task});
+        context.GetCallStack().AddPendingTask(future);
+        Submit(*task, *worker);
+        return future;
+    }
+
+    ObjectHolder TaskPool::Join(const ObjectHolder& future, Context& context) {
+        const auto *handle = future.TryAs<Future>();
+        if (!handle) {
+            throw runtime_error("join expects a future returned by spawn");
+        }
+        return Finish(handle->GetTask(), context);
+    }
+
+    void TaskPool::ParallelFor(size_t count, size_t grain,
+                               const std::function<void(size_t, size_t, Context&)>& body, Context& context) {
+        grain = std::max<size_t>(grain, 1);
+        if (count <= grain) {
+            body(0, count, context);
+            return;
+        }
+        Worker *worker = CurrentWorker();
+        if (!worker) {
+            throw runtime_error("parallel operations are only available in threads of the task pool");
+        }
+        vector<std::unique_ptr<Task>> chunks;
+        chunks.reserve((count + grain - 1) / grain);
+        for (size_t begin = 0; begin < count; begin += grain) {
+            const size_t end = std::min(count, begin + grain);
+            chunks.push_back(std::make_unique<Task>([&body, begin, end](Context& chunk_context) {
+                body(begin, end, chunk_context);
+            }));
+        }
+        // Поток берёт из своей очереди последнюю добавленную задачу, поэтому части кладутся
+        // с конца: владелец выполняет их по порядку, а перехватывающие потоки забирают последние
+        for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+            Submit(**it, *worker);
+        }
+        std::exception_ptr error;
+        for (const auto &chunk : chunks) {
+            if (error) {
+                WaitFor(*chunk);
+                continue;
+            }
+            try {
+                (void)Finish(*chunk, context);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void TaskPool::Submit(Task& task, Worker& worker) {
+        std::call_once(threads_started_, [this] {
+            StartThreads();
+        });
+        outstanding_.fetch_add(1, std::memory_order_relaxed);
+        worker.deque.Push(&task);
+        Notify();
+    }
+
+    void TaskPool::StartThreads() {
+        threads_.reserve(workers_.size() - 1);
+        for (size_t i = 1; i < workers_.size(); ++i) {
+            threads_.emplace_back([this, i] {
+                WorkerLoop(*workers_[i]);
+            });
+        }
+    }
+
+    void TaskPool::WaitFor(Task& task) {
+        if (task.IsDone()) {
+            return;
+        }
+        Worker *worker = CurrentWorker();
+        if (!worker) {
+            throw runtime_error("join is only available in threads of the task pool");
+        }
+        while (!task.IsDone()) {
+            const uint64_t observed = epoch_.load();
+            if (task.IsDone()) {
+                break;
+            }
+            if (Task *other = FindTask(*worker)) {
+                Execute(*other, *worker);
+                continue;
+            }
+            Sleep(observed);
+        }
+    }
+
+    ObjectHolder TaskPool::Finish(Task& task, Context& context) {
+        WaitFor(task);
+        if (!task.output_taken_.exchange(true, std::memory_order_acq_rel)) {
+            context.GetOutputStream() << task.output_;
+        }
+        if (task.error_) {
+            std::rethrow_exception(task.error_);
+        }
+        return task.result_;
+    }
+
+    void TaskPool::JoinPending(size_t depth, Context& context) {
+        const vector<ObjectHolder> futures = context.GetCallStack().TakePendingTasks(depth);
+        std::exception_ptr error;
+        for (const ObjectHolder &future : futures) {
+            try {
+                (void)Join(future, context);
+            }
+            catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    TaskPool::Worker* TaskPool::CurrentWorker() {
+        return current_worker_ && &current_worker_->pool == this ? current_worker_ : nullptr;
+    }
+
+    Task* TaskPool::FindTask(Worker& worker) {
+        if (Task *task = worker.deque.Pop()) {
+            return task;
+        }
+        const size_t count = workers_.size();
+        for (size_t i = 1; i < count; ++i) {
+            if (Task *task = workers_[(worker.index + i) % count]->deque.Steal()) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void TaskPool::Execute(Task& task, Worker& worker) {
+        task.Run(*this, *worker.stack);
+        outstanding_.fetch_sub(1, std::memory_order_acq_rel);
+        Notify();
+    }
+
+    void TaskPool::Sleep(uint64_t observed_epoch) {
+        // Увеличение sleepers_ до проверки epoch_ гарантирует, что Notify, изменивший epoch_
+        // после проверки, увидит спящий поток и разбудит его
+        sleepers_.fetch_add(1);
+        {
+            std::unique_lock lock(mutex_);
+            wakeup_.wait(lock, [this, observed_epoch] {
+                return epoch_.load() != observed_epoch || stopping_.load();
+            });
+        }
+        sleepers_.fetch_sub(1);
+    }
+
+    void TaskPool::Notify() {
+        epoch_.fetch_add(1);
+        if (sleepers_.load() != 0) {
+            std::lock_guard guard(mutex_);
+            wakeup_.notify_all();
+        }
+    }
+
+    void TaskPool::WorkerLoop(Worker& worker) {
+        current_worker_ = &worker;
+        while (!stopping_.load()) {
+            const uint64_t observed = epoch_.load();
+            if (Task *task = FindTask(worker)) {
+                Execute(*task, worker);
+                continue;
+            }
+            Sleep(observed);
+        }
+    }
+
+    namespace {
+
+        // Коллекция - аргумент параллельной операции. Числа intarray и range создаются
+        // по номеру элемента в той части, которая их обрабатывает: range не разворачивается целиком
+        class ParallelItems {
+        public:
+            explicit ParallelItems(const ObjectHolder& items)
+                    : list_(items.TryAs<List>())
+                    , array_(items.TryAs<IntArray>())
+                    , range_(items.TryAs<Range>()) {
+                if (!list_ && !array_ && !range_) {
+                    throw runtime_error("parallel operations expect a list, an intarray or a range of items");
+                }
+            }
+
+            [[nodiscard]] size_t Size() const {
+                if (list_) {
+                    return list_->Size();
+                }
+                if (array_) {
+                    return array_->Size();
+                }
+                return static_cast<size_t>(range_->Size());
+            }
+
+            [[nodiscard]] const List* GetList() const {
+                return list_;
+            }
+
+            // Вызывает action(index, item) для элементов [begin, end) по порядку
+            template <typename Action>
+            void ForEach(size_t begin, size_t end, Action action) const {
+                if (list_) {
+                    const auto &items = list_->GetItems();
+                    for (size_t i = begin; i < end; ++i) {
+                        action(i, items[i]);
+                    }
+                }
+                else if (array_) {
+                    const auto &values = array_->GetValues();
+                    for (size_t i = begin; i < end; ++i) {
+                        action(i, ObjectHolder::Own(Number{values[i]}));
+                    }
+                }
+                else if (begin < end) {
+                    int64_t value = range_->At(begin);
+                    for (size_t i = begin;;) {
+                        action(i, ObjectHolder::Own(Number{value}));
+                        if (++i == end || !CheckedAdd(value, range_->GetStep(), value)) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+        private:
+            const List* list_;
+            const IntArray* array_;
+            const Range* range_;
+        };
+
+        // Объект и метод, вызываемый параллельной операцией для элементов коллекции
+        struct ParallelCall {
+            ClassInstance& instance;
+            const Method& method;
+        };
+
+        ParallelCall FindParallelMethod(const ObjectHolder& object, const string& name, size_t argument_count) {
+            auto *instance = object.TryAs<ClassInstance>();
+            if (!instance) {
+                throw runtime_error("parallel operations expect a class instance as the first argument");
+            }
+            const Method *method = instance->GetClass().GetMethod(name);
+            if (!method || method->formal_params.size() != argument_count) {
+                throw runtime_error("Class "s + instance->GetClass().GetName() + " hasn't got method "s + name
+                                    + " with "s + to_string(argument_count) + " arguments"s);
+            }
+            return {*instance, *method};
+        }
+
+        // Пока операция выполняется, объект, элементы - объекты классов и все объекты,
+        // доступные из них через поля, доступны только для чтения
+        class SharedItems {
+        public:
+            SharedItems(ClassInstance& instance, const ParallelItems& items) {
+                vector<ClassInstance*> roots{&instance};
+                if (const List *list = items.GetList()) {
+                    for (const ObjectHolder &item : list->GetItems()) {
+                        if (auto *item_instance = item.TryAs<ClassInstance>()) {
+                            roots.push_back(item_instance);
+                        }
+                    }
+                }
+                instances_ = ReachableInstances(std::move(roots));
+                for (ClassInstance *shared : instances_) {
+                    shared->BeginTaskShare();
+                }
+            }
+
+            SharedItems(const SharedItems&) = delete;
+            SharedItems& operator=(const SharedItems&) = delete;
+
+            ~SharedItems() {
+                for (ClassInstance *shared : instances_) {
+                    shared->EndTaskShare();
+                }
+            }
+
+        private:
+            vector<ClassInstance*> instances_;
+        };
+
+        // Размер части: вне пула и в пуле из одного потока коллекция обрабатывается одной частью
+        size_t EffectiveGrain(size_t count, size_t grain, Context& context) {
+            const TaskPool *pool = context.GetTaskPool();
+            if (!pool || pool->GetThreadCount() == 1) {
+                return std::max<size_t>(count, 1);
+            }
+            if (grain != 0) {
+                return grain;
+            }
+            const size_t chunks = pool->GetThreadCount() * PARALLEL_CHUNKS_PER_THREAD;
+            return std::max(PARALLEL_MIN_GRAIN, (count + chunks - 1) / chunks);
+        }
+
+        void ForEachChunk(size_t count, size_t grain, const std::function<void(size_t, size_t, Context&)>& body,
+                          Context& context) {
+            if (TaskPool *pool = context.GetTaskPool()) {
+                pool->ParallelFor(count, grain, body, context);
+            }
+            else {
+                body(0, count, context);
+            }
+        }
+
+        // Значения одного вида: числа (Number или BigNumber), объекты одного класса
+        // либо объекты одного типа C++
+        bool IsSameKind(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            const auto is_number = [](const ObjectHolder& value) {
+                return value.TryAs<Number>() || value.TryAs<BigNumber>();
+            };
+            if (is_number(lhs) || is_number(rhs)) {
+                return is_number(lhs) && is_number(rhs);
+            }
+            if (!lhs || !rhs) {
+                return !lhs && !rhs;
+            }
+            const auto *lhs_instance = lhs.TryAs<ClassInstance>();
+            const auto *rhs_instance = rhs.TryAs<ClassInstance>();
+            if (lhs_instance || rhs_instance) {
+                return lhs_instance && rhs_instance && &lhs_instance->GetClass() == &rhs_instance->GetClass();
+            }
+            return typeid(*lhs) == typeid(*rhs);
+        }
+
+        // Сворачивает элементы [begin, end), начиная с acc
+        ObjectHolder Fold(const ParallelCall& call, const ParallelItems& items, size_t begin, size_t end,
+                          ObjectHolder acc, Context& context) {
+            items.ForEach(begin, end, [&](size_t /*index*/, ObjectHolder item) {
+                ObjectHolder args[2] = {std::move(acc), std::move(item)};
+                acc = call.instance.Call(call.method, args, 2, context);
+            });
+            return acc;
+        }
+
+    }  // namespace
+
+    ObjectHolder ParallelMap(const ObjectHolder& object, const std::string& method, const ObjectHolder& items,
+                             size_t grain, Context& context) {
+        const ParallelCall call = FindParallelMethod(object, method, 1);
+        const ParallelItems values{items};
+        const SharedItems shared{call.instance, values};
+        const size_t count = values.Size();
+        vector<ObjectHolder> results(count);
+        ForEachChunk(count, EffectiveGrain(count, grain, context),
+                     [&](size_t begin, size_t end, Context& chunk_context) {
+                         values.ForEach(begin, end, [&](size_t index, ObjectHolder item) {
+                             results[index] = call.instance.Call(call.method, &item, 1, chunk_context);
+                         });
+                     }, context);
+        return ObjectHolder::Own(List{std::move(results)});
+    }
+
+    ObjectHolder ParallelFilter(const ObjectHolder& object, const std::string& method, const ObjectHolder& items,
+                                size_t grain, Context& context) {
+        const ParallelCall call = FindParallelMethod(object, method, 1);
+        const ParallelItems values{items};
+        const SharedItems shared{call.instance, values};
+        const size_t count = values.Size();
+        // char, а не bool: части записывают соседние флаги из разных потоков
+        vector<char> keep(count);
+        ForEachChunk(count, EffectiveGrain(count, grain, context),
+                     [&](size_t begin, size_t end, Context& chunk_context) {
+                         values.ForEach(begin, end, [&](size_t index, ObjectHolder item) {
+                             keep[index] = IsTrue(call.instance.Call(call.method, &item, 1, chunk_context));
+                         });
+                     }, context);
+        vector<ObjectHolder> result;
+        values.ForEach(0, count, [&](size_t index, ObjectHolder item) {
+            if (keep[index]) {
+                result.push_back(std::move(item));
+            }
+        });
+        return ObjectHolder::Own(List{std::move(result)});
+    }
+
+    ObjectHolder ParallelReduce(const ObjectHolder& object, const std::string& method, const ObjectHolder& items,
+                                const ObjectHolder& initial, size_t grain, Context& context) {
+        const ParallelCall call = FindParallelMethod(object, method, 2);
+        const ParallelItems values{items};
+        const SharedItems shared{call.instance, values};
+        const size_t count = values.Size();
+        grain = EffectiveGrain(count, grain, context);
+        if (count <= grain) {
+            return Fold(call, values, 0, count, initial, context);
+        }
+        // Части, кроме первой, сворачиваются с первого своего элемента, а их результаты - с результатом
+        // первой части. Это равно свёртке с initial, только если элементы того же вида, что и initial
+        const List *list = values.GetList();
+        const bool same_kind = list
+                               ? std::all_of(list->GetItems().begin(), list->GetItems().end(),
+                                             [&initial](const ObjectHolder& item) {
+                                                 return IsSameKind(item, initial);
+                                             })
+                               : IsSameKind(ObjectHolder::Own(Number{0}), initial);
+        if (!same_kind) {
+            throw runtime_error("preduce over several chunks needs items of the same type as the initial "
+                                "value; pass a grain not less than the number of items to fold sequentially");
+        }
+        vector<ObjectHolder> partial((count + grain - 1) / grain);
+        ForEachChunk(count, grain, [&](size_t begin, size_t end, Context& chunk_context) {
+            ObjectHolder acc;
+            size_t first = begin;
+            if (begin == 0) {
+                acc = initial;
+            }
+            else {
+                values.ForEach(begin, begin + 1, [&acc](size_t /*index*/, ObjectHolder item) {
+                    acc = std::move(item);
+                });
+                ++first;
+            }
+            partial[begin / grain] = Fold(call, values, first, end, std::move(acc), chunk_context);
+        }, context);
+        ObjectHolder acc = std::move(partial.front());
+        for (size_t i = 1; i < partial.size(); ++i) {
+            ObjectHolder args[2] = {std::move(acc), std::move(partial[i])};
+            acc = call.instance.Call(call.method, args, 2, context);
+        }
+        return acc;
+    }
+
+}  // namespace runtime
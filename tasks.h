@@ -0,0 +1,348 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+Задачи - параллельное выполнение вызовов методов в модели fork-join.
+
+Выражение spawn obj.method(args...) запускает вызов метода как задачу и сразу возвращает
+её будущий результат (Future). Встроенная функция join(future) дожидается завершения задачи
+и возвращает значение, которое вернул метод, либо перевыбрасывает исключение задачи.
+
+Задачи выполняются пулом потоков TaskPool с перехватом работы (work stealing): у каждого потока
+своя двусторонняя очередь WorkStealingDeque. Запущенная задача кладётся в очередь запустившего
+её потока, который берёт задачи из своей очереди в порядке LIFO, а потоки без работы забирают
+самые старые задачи из чужих очередей. Поток, ожидающий join, не блокируется, а выполняет
+другие задачи.
+
+Правила потокобезопасности:
+ - ObjectHolder можно копировать и уничтожать в разных потоках: счётчик ссылок атомарный;
+ - задача выполняет метод в собственном кадре стека вызовов своего потока (Closure кадра
+   принадлежит только ей). Аргументы вычисляются и копируются в задачу при запуске;
+ - задачи, запущенные при выполнении метода, дожидаются перед выходом из этого метода,
+   в том числе при выходе по исключению, а запущенные вне методов - в TaskPool::Wait.
+   Поэтому объекты, на которые задача ссылается без владения (например, self), живут дольше неё;
+ - числа, строки и другие значения можно одновременно читать из нескольких задач;
+ - пока задача выполняется, поля её получателя, переданных ей аргументами объектов классов
+   и всех объектов, доступных из них через поля (self.b, self.b.c), доступны только для чтения:
+   присваивание им выбрасывает runtime_error. Списки и словари, доступные нескольким задачам,
+   и объекты, доступные только через их элементы, нельзя изменять, пока задачи выполняются;
+   это не проверяется;
+ - вывод задачи накапливается в её буфере и переносится в вывод кода, дождавшегося задачи,
+   при первом ожидании. Поэтому порядок вывода не зависит от того, какие потоки выполняли задачи;
+ - изоляты (spawn(Class, ...), send и recv) внутри задач недоступны
+*/
+namespace runtime {
+
+/*
+Двусторонняя очередь Чейза-Лева (Chase, Lev. Dynamic Circular Work-Stealing Deque, 2005)
+в варианте для слабых моделей памяти (Lê et al., 2013).
+
+Владелец очереди добавляет и извлекает элементы с нижнего конца (Push, Pop) без блокировок,
+а остальные потоки забирают элементы с верхнего конца (Steal). Кольцевой буфер растёт вдвое
+при заполнении; прежние буферы освобождаются только вместе с очередью, потому что
+перехватывающий поток может читать из буфера, который владелец уже заменил
+*/
+    template <typename T>
+    class WorkStealingDeque {
+    public:
+        explicit WorkStealingDeque(size_t initial_capacity = 64) {
+            size_t capacity = 1;
+            while (capacity < initial_capacity) {
+                capacity *= 2;
+            }
+            buffers_.push_back(std::make_unique<Buffer>(capacity));
+            buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Добавляет item в нижний конец очереди. Вызывается только владельцем
+        void Push(T* item) {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const int64_t top = top_.load(std::memory_order_acquire);
+            Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+            if (bottom - top >= static_cast<int64_t>(buffer->Capacity())) {
+                buffer = Grow(*buffer, top, bottom);
+            }
+            buffer->Put(bottom, item);
+            bottom_.store(bottom + 1, std::memory_order_release);
+        }
+
+        // Извлекает последний добавленный элемент или возвращает nullptr, если очередь пуста.
+        // Вызывается только владельцем
+        T* Pop() {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_seq_cst);
+            int64_t top = top_.load(std::memory_order_seq_cst);
+            if (top > bottom) {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            T *item = buffer->Get(bottom);
+            if (top == bottom) {
+                // Последний элемент может одновременно забирать перехватывающий поток
+                if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Забирает самый старый элемент или возвращает nullptr, если очередь пуста
+        // или элемент одновременно забрал другой поток. Вызывается любым потоком
+        T* Steal() {
+            int64_t top = top_.load(std::memory_order_seq_cst);
+            const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+            if (top >= bottom) {
+                return nullptr;
+            }
+            T *item = buffer_.load(std::memory_order_acquire)->Get(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            return item;
+        }
+
+        // Возвращает приблизительное число элементов очереди
+        [[nodiscard]] size_t Size() const {
+            const int64_t size = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+            return size > 0 ? static_cast<size_t>(size) : 0;
+        }
+
+    private:
+        class Buffer {
+        public:
+            explicit Buffer(size_t capacity)
+                    : mask_(capacity - 1)
+                    , items_(std::make_unique<std::atomic<T*>[]>(capacity)) {
+            }
+
+            [[nodiscard]] size_t Capacity() const {
+                return mask_ + 1;
+            }
+
+            [[nodiscard]] T* Get(int64_t index) const {
+                return items_[static_cast<size_t>(index) & mask_].load(std::memory_order_relaxed);
+            }
+
+            void Put(int64_t index, T* item) {
+                items_[static_cast<size_t>(index) & mask_].store(item, std::memory_order_relaxed);
+            }
+
+        private:
+            size_t mask_;
+            std::unique_ptr<std::atomic<T*>[]> items_;
+        };
+
+        Buffer* Grow(const Buffer& buffer, int64_t top, int64_t bottom) {
+            auto grown = std::make_unique<Buffer>(buffer.Capacity() * 2);
+            for (int64_t i = top; i < bottom; ++i) {
+                grown->Put(i, buffer.Get(i));
+            }
+            buffers_.push_back(std::move(grown));
+            buffer_.store(buffers_.back().get(), std::memory_order_release);
+            return buffers_.back().get();
+        }
+
+        std::atomic<int64_t> top_{0};
+        std::atomic<int64_t> bottom_{0};
+        std::atomic<Buffer*> buffer_{nullptr};
+        // Все выделенные буферы, последний из них - текущий. Изменяется только владельцем
+        std::vector<std::unique_ptr<Buffer>> buffers_;
+    };
+
+// Задача пула TaskPool: вызов метода method у receiver с аргументами args либо функция C++ job.
+// Создаётся только пулом
+    class Task {
+    public:
+        using Job = std::function<void(Context&)>;
+
+        Task(ObjectHolder receiver, const Method& method, std::vector<ObjectHolder> args);
+        explicit Task(Job job);
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        // Возвращает true, если метод задачи завершился (возвратом значения или исключением)
+        [[nodiscard]] bool IsDone() const;
+
+    private:
+        friend class TaskPool;
+        class ExecutionContext;
+
+        // Выполняет задачу в стеке вызовов stack и отмечает её завершённой
+        void Run(TaskPool& pool, CallStack& stack);
+
+        ObjectHolder receiver_;
+        const Method* method_ = nullptr;
+        std::vector<ObjectHolder> args_;
+        // Объекты классов, доступные задаче через получателя и аргументы; пока задача
+        // выполняется, они доступны только для чтения
+        std::vector<ClassInstance*> shared_instances_;
+        Job job_;
+
+        // Записываются выполняющим задачу потоком до установки done_
+        ObjectHolder result_;
+        std::exception_ptr error_;
+        std::string output_;
+
+        std::atomic<bool> done_{false};
+        // Устанавливается, когда вывод задачи перенесён в вывод дождавшегося её кода
+        std::atomic<bool> output_taken_{false};
+    };
+
+// Будущий результат задачи, возвращаемый spawn obj.method(...). Выводится как "<future>"
+    class Future : public Object {
+    public:
+        explicit Future(std::shared_ptr<Task> task);
+
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] Task& GetTask() const;
+
+    private:
+        std::shared_ptr<Task> task_;
+    };
+
+/*
+Пул потоков с перехватом работы, выполняющий задачи.
+Поток владельца пула - один из потоков пула: его код выполняется в контексте GetMainContext(),
+который передаёт вывод, стек вызовов и изолят контексту context, а задачи он выполняет,
+ожидая их в join и Wait. Остальные thread_count - 1 потоков создаются пулом при запуске
+первой задачи, поэтому программа без задач не создаёт потоков.
+Деструктор дожидается всех задач и останавливает потоки
+*/
+    class TaskPool {
+    public:
+        explicit TaskPool(Context& context, size_t thread_count = std::thread::hardware_concurrency());
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        // Контекст, в котором код потока владельца может запускать задачи и ждать их
+        [[nodiscard]] Context& GetMainContext();
+
+        // Дожидается задач, запущенных в контексте GetMainContext() вне методов, и переносит их вывод.
+        // Если задача выбросила исключение, перевыбрасывает первое из них
+        void Wait();
+
+        [[nodiscard]] size_t GetThreadCount() const;
+        // Возвращает true, если потоки пула уже созданы. Вызывается потоком владельца
+        [[nodiscard]] bool HasStartedThreads() const;
+
+        // Запускает задачу, вызывающую method у receiver с аргументами args, и возвращает её Future.
+        // Задача запоминается в стеке вызовов context, чтобы её дождались при выходе из кадра.
+        // Вызывается только потоками пула
+        ObjectHolder Spawn(ObjectHolder receiver, const Method& method, std::vector<ObjectHolder> args,
+                           Context& context);
+
+        // Дожидается задачи future, выполняя тем временем другие задачи, и возвращает её результат.
+        // При первом ожидании переносит вывод задачи в вывод context.
+        // Если задача выбросила исключение, перевыбрасывает его
+        ObjectHolder Join(const ObjectHolder& future, Context& context);
+
+        // Дожидается задач, запущенных в стеке вызовов context на глубине depth или глубже.
+        // Если задачи выбросили исключения, перевыбрасывает первое из них
+        void JoinPending(size_t depth, Context& context);
+
+        // Делит отрезок [0, count) на части по grain элементов и вызывает body(begin, end, context)
+        // для каждой части задачами пула; часть не длиннее count выполняется сразу в context.
+        // Дожидается всех частей и переносит их вывод в context в порядке частей. Если части
+        // выбросили исключения, перевыбрасывает исключение первой из них, а вывод следующих
+        // за ней частей отбрасывает - как при последовательном выполнении
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t, Context&)>& body,
+                         Context& context);
+
+    private:
+        class MainContext;
+        struct Worker;
+
+        // Возвращает обработчика текущего потока или nullptr, если поток не принадлежит пулу
+        Worker* CurrentWorker();
+        // Кладёт задачу в очередь потока worker. Первая задача создаёт потоки пула
+        void Submit(Task& task, Worker& worker);
+        void StartThreads();
+        // Дожидается завершения задачи, выполняя тем временем другие задачи
+        void WaitFor(Task& task);
+        // Дожидается задачи, переносит её вывод в context и возвращает её результат
+        ObjectHolder Finish(Task& task, Context& context);
+        // Извлекает задачу из своей очереди или перехватывает из чужой
+        Task* FindTask(Worker& worker);
+        void Execute(Task& task, Worker& worker);
+        // Ждёт, пока счётчик событий отличается от observed_epoch (запущена или завершена задача)
+        void Sleep(uint64_t observed_epoch);
+        void Notify();
+        void WorkerLoop(Worker& worker);
+
+        // Обработчик задач текущего потока, если поток принадлежит какому-либо пулу
+        static thread_local Worker* current_worker_;
+
+        Context& context_;
+        std::unique_ptr<MainContext> main_context_;
+        // Обработчик, который был у потока владельца до создания пула
+        Worker* owner_previous_worker_ = nullptr;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+        std::once_flag threads_started_;
+
+        // Количество запущенных, но не завершённых задач
+        std::atomic<size_t> outstanding_{0};
+        // Счётчик событий: увеличивается при запуске и завершении задачи
+        std::atomic<uint64_t> epoch_{0};
+        std::atomic<size_t> sleepers_{0};
+        std::atomic<bool> stopping_{false};
+        std::mutex mutex_;
+        std::condition_variable wakeup_;
+    };
+
+/*
+Параллельные операции над коллекциями - встроенные функции
+    pmap(object, "method", items[, grain]) - список результатов object.method(item);
+    pfilter(object, "method", items[, grain]) - список элементов, для которых object.method(item) истинно;
+    preduce(object, "method", items, initial[, grain]) - свёртка acc = object.method(acc, item),
+        начиная с initial.
+
+items - список, intarray или range. Элементы делятся на части по grain подряд идущих элементов,
+которые обрабатываются задачами пула контекста (см. TaskPool::ParallelFor); числа range и intarray
+создаются частью, которая их обрабатывает. Если grain равен 0, размер части выбирается по числу
+потоков пула, но не меньше PARALLEL_MIN_GRAIN. Коллекции не длиннее одной части, а также
+коллекции вне пула задач или в пуле из одного потока обрабатываются последовательно.
+
+Результат не зависит от разбиения и планирования: элементы результатов идут в порядке items,
+вывод частей - в порядке частей. Последовательно preduce сворачивает элементы по порядку,
+начиная с initial. При нескольких частях первая часть сворачивается с initial, остальные -
+со своего первого элемента, а результаты частей сворачиваются по порядку. Это совпадает
+с последовательной свёрткой, если method ассоциативен; элементы при этом должны быть того же
+вида, что и initial (числа, объекты одного класса или одного типа), иначе выбрасывается runtime_error.
+Пока операция выполняется, поля object и элементов-объектов классов доступны только для чтения.
+Если object не имеет метода method с нужным числом параметров или items не коллекция,
+выбрасывается runtime_error
+*/
+    constexpr size_t PARALLEL_MIN_GRAIN = 16;
+    // На сколько частей в среднем на поток делится коллекция при выборе размера части
+    constexpr size_t PARALLEL_CHUNKS_PER_THREAD = 4;
+
+    ObjectHolder ParallelMap(const ObjectHolder& object, const std::string& method, const ObjectHolder& items,
+                             size_t grain, Context& context);
+    ObjectHolder ParallelFilter(const ObjectHolder& object, const std::string& method, const ObjectHolder& items,
+                                size_t grain, Context& context);
+    ObjectHolder ParallelReduce(const ObjectHolder& object, const std::string& method, const ObjectHolder& items,
+                                const ObjectHolder& initial, size_t grain, Context& context);
+
+}  // namespace runtime
@@ -0,0 +1,378 @@
+#include "program.h"
+#include "tasks.h"
+#include "test_runner_p.h"
+
+#include <limits>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        string Run(const string& text, size_t threads = 4) {
+            istringstream input(text);
+            const mython::Program program{input};
+            ostringstream output;
+            SimpleContext context{output};
+            {
+                TaskPool pool{context, threads};
+                Closure closure;
+                program.Execute(closure, pool.GetMainContext());
+                pool.Wait();
+            }
+            return output.str();
+        }
+
+        void TestWorkStealingDeque() {
+            vector<int> items(200);
+            WorkStealingDeque<int> deque{4};
+            ASSERT(deque.Pop() == nullptr);
+            ASSERT(deque.Steal() == nullptr);
+            // Очередь растёт сверх начальной ёмкости
+            for (int &item : items) {
+                deque.Push(&item);
+            }
+            ASSERT_EQUAL(deque.Size(), items.size());
+            ASSERT_EQUAL(deque.Pop(), &items.back());
+            ASSERT_EQUAL(deque.Steal(), &items.front());
+            ASSERT_EQUAL(deque.Steal(), &items[1]);
+            ASSERT_EQUAL(deque.Size(), items.size() - 3);
+
+            // Каждый элемент достаётся ровно одному потоку
+            constexpr int ITEMS = 20000;
+            constexpr int THIEVES = 3;
+            vector<int> values(ITEMS);
+            vector<atomic<int>> taken(ITEMS);
+            WorkStealingDeque<int> shared;
+            atomic<bool> done{false};
+            auto take = [&](int *item) {
+                taken[item - values.data()].fetch_add(1);
+            };
+            vector<thread> thieves;
+            for (int i = 0; i < THIEVES; ++i) {
+                thieves.emplace_back([&] {
+                    while (!done.load()) {
+                        if (int *item = shared.Steal()) {
+                            take(item);
+                        }
+                    }
+                });
+            }
+            for (int i = 0; i < ITEMS; ++i) {
+                shared.Push(&values[i]);
+                if (i % 3 == 0) {
+                    if (int *item = shared.Pop()) {
+                        take(item);
+                    }
+                }
+            }
+            while (int *item = shared.Pop()) {
+                take(item);
+            }
+            done.store(true);
+            for (thread &thief : thieves) {
+                thief.join();
+            }
+            for (const atomic<int> &count : taken) {
+                ASSERT_EQUAL(count.load(), 1);
+            }
+        }
+
+        void TestForkJoin() {
+            const string program = R"(
+class Fib:
+  def compute(n):
+    if n < 2:
+      return n
+    left = spawn self.compute(n - 1)
+    right = self.compute(n - 2)
+    return join(left) + right
+
+class Summer:
+  def __init__(values):
+    self.values = values
+
+  def sum(lo, hi):
+    if hi - lo <= 8:
+      total = 0
+      for i in range(lo, hi):
+        total = total + self.values[i]
+      return total
+    mid = (lo + hi) / 2
+    left = spawn self.sum(lo, mid)
+    right = spawn self.sum(mid, hi)
+    return join(left) + join(right)
+
+fib = Fib()
+f = spawn fib.compute(16)
+summer = Summer(intarray(range(1000)))
+print join(f), summer.sum(0, 1000)
+print f, join(f)
+)"s;
+            for (size_t threads : {1, 2, 4}) {
+                ASSERT_EQUAL(Run(program, threads), "987 499500\n<future> 987\n"s);
+            }
+        }
+
+        void TestOutputOrder() {
+            // Вывод задачи попадает в вывод кода, дождавшегося её, в точке ожидания
+            const string program = R"(
+class Worker:
+  def __init__(name):
+    self.name = name
+
+  def run(count):
+    for i in range(count):
+      print self.name, i
+    return count
+
+class Outer:
+  def both():
+    a = Worker('inner-a')
+    b = Worker('inner-b')
+    f = spawn a.run(1)
+    spawn b.run(1)
+    print 'both'
+    return join(f)
+
+first = Worker('first')
+second = Worker('second')
+outer = Outer()
+f = spawn first.run(2)
+s = spawn second.run(2)
+print 'main'
+print join(s)
+print join(f)
+print join(spawn outer.both())
+)"s;
+            const string expected = "main\nsecond 0\nsecond 1\n2\nfirst 0\nfirst 1\n2\n"
+                                    "both\ninner-a 0\ninner-b 0\n1\n"s;
+            for (size_t threads : {1, 4}) {
+                ASSERT_EQUAL(Run(program, threads), expected);
+            }
+        }
+
+        void TestErrorsAndRestrictions() {
+            const string classes = R"(
+class Box:
+  def __init__(value):
+    self.value = value
+
+  def get():
+    return self.value
+
+  def set(value):
+    self.value = value
+
+  def fail():
+    return self.value + 'text'
+
+  def forget():
+    spawn self.fail()
+    return 1
+
+  def modify(other):
+    other.value = 0
+
+  def spawn_and_write():
+    f = spawn self.get()
+    self.value = 2
+    return join(f)
+
+class Holder:
+  def __init__(box):
+    self.box = box
+
+  def peek():
+    return self.box.value
+
+  def bump():
+    self.box.value = self.box.value + 1
+
+  def tag():
+    self.box.tag = 1
+)"s;
+            // Ошибка задачи перевыбрасывается из join и из неявного ожидания при выходе из метода
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nprint join(spawn b.fail())\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nprint b.forget()\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nspawn b.fail()\n"s), runtime_error);
+
+            // Пока задача выполняется, поля её получателя и аргументов доступны только для чтения
+            ASSERT_THROWS(Run(classes + "b = Box(1)\njoin(spawn b.set(2))\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nz = Box(0)\njoin(spawn z.modify(b))\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nprint b.spawn_and_write()\n"s, 1), runtime_error);
+            ASSERT_EQUAL(Run(classes + "b = Box(1)\nprint join(spawn b.get())\nb.set(5)\nprint b.get()\n"s),
+                         "1\n5\n"s);
+            // То же для объектов, доступных через поля, в том числе по циклическим ссылкам
+            ASSERT_THROWS(Run(classes + "h = Holder(Box(1))\njoin(spawn h.bump())\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nh = Holder(b)\nb.set(h)\njoin(spawn h.tag())\n"s),
+                          runtime_error);
+            ASSERT_EQUAL(Run(classes + "h = Holder(Box(1))\nprint join(spawn h.peek())\nh.bump()\nprint h.peek()\n"s),
+                         "1\n2\n"s);
+
+            ASSERT_THROWS(Run(classes + "b = Box(1)\nspawn b.missing()\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "b = 5\nspawn b.get()\n"s), runtime_error);
+            ASSERT_THROWS(Run("print join(5)\n"s), runtime_error);
+
+            // Без пула задач spawn и join недоступны
+            istringstream input(classes + "b = Box(1)\nf = spawn b.get()\n"s);
+            const mython::Program program{input};
+            DummyContext context;
+            Closure closure;
+            ASSERT_THROWS(program.Execute(closure, context), runtime_error);
+        }
+
+        void TestThreadsStartOnFirstTask() {
+            const string classes = "class Box:\n  def get():\n    return 7\n\n"s;
+            istringstream input(classes + "b = Box()\nprint b.get()\n"s);
+            const mython::Program program{input};
+            istringstream spawn_input(classes + "b = Box()\nprint join(spawn b.get())\n"s);
+            const mython::Program spawn_program{spawn_input};
+            ostringstream output;
+            SimpleContext context{output};
+            TaskPool pool{context, 2};
+            Closure closure;
+            program.Execute(closure, pool.GetMainContext());
+            pool.Wait();
+            ASSERT(!pool.HasStartedThreads());
+            ASSERT_EQUAL(pool.GetThreadCount(), 2U);
+
+            spawn_program.Execute(closure, pool.GetMainContext());
+            pool.Wait();
+            ASSERT(pool.HasStartedThreads());
+            ASSERT_EQUAL(output.str(), "7\n7\n"s);
+        }
+
+        void TestParallelCollections() {
+            const string classes = R"(
+class Ops:
+  def __init__(name):
+    self.name = name
+
+  def square(x):
+    return x * x
+
+  def even(x):
+    return x / 2 * 2 == x
+
+  def add(a, b):
+    return a + b
+
+  def concat(a, b):
+    return a + ',' + b
+
+  def same(x):
+    return x
+
+  def count_chars(total, text):
+    return total + len(text)
+
+  def shout(x):
+    print self.name, x
+    return x
+
+  def bad(x):
+    if x == 37:
+      return x + 'text'
+    return x
+
+  def rename(x):
+    self.name = 'changed'
+    return x
+
+  def nested(x):
+    return preduce(self, 'add', pmap(self, 'square', range(x)), 0, 2)
+
+ops = Ops('ops')
+)"s;
+            const string program = R"(
+print pmap(ops, 'square', [1, 2, 3, 4, 5])
+print pfilter(ops, 'even', range(10), 3)
+print preduce(ops, 'add', range(1000), 0)
+print preduce(ops, 'add', intarray(range(1, 101)), 5, 7)
+print preduce(ops, 'concat', ['a', 'b', 'c', 'd', 'e'], 'x', 2)
+print preduce(ops, 'add', [], 42)
+print pmap(ops, 'square', range(0)), pfilter(ops, 'even', [])
+print preduce(ops, 'add', pmap(ops, 'square', range(200), 1), 0)
+print pmap(ops, 'nested', [3, 4, 5], 1)
+print pfilter(ops, 'even', intarray(range(40)))
+)"s;
+            // Результат и вывод не зависят от числа потоков и размера частей
+            const string expected = "[1, 4, 9, 16, 25]\n[0, 2, 4, 6, 8]\n499500\n5055\nx,a,b,c,d,e\n42\n[] []\n"
+                                    "2646700\n[5, 14, 30]\n"
+                                    "[0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38]\n"s;
+            for (size_t threads : {1, 2, 4}) {
+                ASSERT_EQUAL(Run(classes + program, threads), expected);
+            }
+
+            // range не разворачивается целиком и не переполняется у границ int64_t
+            const Range tail{numeric_limits<int64_t>::max() - 7, numeric_limits<int64_t>::max(), 5};
+            ASSERT_EQUAL(tail.Size(), 2U);
+            ASSERT_EQUAL(tail.At(1), numeric_limits<int64_t>::max() - 2);
+            const Range whole{numeric_limits<int64_t>::min(), numeric_limits<int64_t>::max()};
+            ASSERT_EQUAL(whole.Size(), numeric_limits<uint64_t>::max());
+            ASSERT_EQUAL(whole.At(whole.Size() - 1), numeric_limits<int64_t>::max() - 1);
+            ASSERT_EQUAL((Range{5, -5, -3}.Size()), 4U);
+            ASSERT_EQUAL((Range{5, 5}.Size()), 0U);
+            const string ranges = "print pmap(ops, 'same', range(9223372036854775800, 9223372036854775807, 5), 1)\n"
+                                  "print pfilter(ops, 'even', range(5, -5, -3), 1)\n"s;
+            // Свёртка разнородных значений: последовательно - с initial, по частям - ошибка
+            const string chars = "print preduce(ops, 'count_chars', ['ab', 'c', 'def'], 0)\n"s;
+            const string chars_chunked = "print preduce(ops, 'count_chars', ['ab', 'c', 'def'], 0, 1)\n"s;
+            for (size_t threads : {1, 4}) {
+                ASSERT_EQUAL(Run(classes + ranges, threads), "[9223372036854775800, 9223372036854775805]\n[2, -4]\n"s);
+                ASSERT_EQUAL(Run(classes + chars, threads), "6\n"s);
+            }
+            ASSERT_EQUAL(Run(classes + chars_chunked, 1), "6\n"s);
+            ASSERT_THROWS(Run(classes + chars_chunked, 4), runtime_error);
+
+            // Вывод частей попадает в вывод вызывающего кода в порядке элементов
+            const string shout = "print pmap(ops, 'shout', range(6), 2)\n"s;
+            for (size_t threads : {1, 4}) {
+                ASSERT_EQUAL(Run(classes + shout, threads), "ops 0\nops 1\nops 2\nops 3\nops 4\nops 5\n[0, 1, 2, 3, 4, 5]\n"s);
+            }
+
+            // Ошибка первой упавшей части перевыбрасывается после ожидания остальных частей
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'bad', range(100), 5)\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print preduce(ops, 'bad', range(100), 0, 5)\n"s), runtime_error);
+            // Поля объекта доступны только для чтения, пока выполняется операция
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'rename', range(100))\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'rename', range(3))\n"s, 1), runtime_error);
+            ASSERT_EQUAL(Run(classes + "pmap(ops, 'square', [1])\nops.name = 'n'\nprint ops.name\n"s), "n\n"s);
+
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'missing', [1])\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'add', [1])\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(5, 'square', [1])\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 5, [1])\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'square', 5)\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'square', [1], 0)\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print pmap(ops, 'square')\n"s), runtime_error);
+            ASSERT_THROWS(Run(classes + "print preduce(ops, 'add', [1])\n"s), runtime_error);
+
+            // Вне пула задач операции выполняются последовательно
+            istringstream input(classes + "squares = pmap(ops, 'square', range(100), 3)\n"
+                                          "print squares[99]\n"
+                                          "print preduce(ops, 'add', range(100), 0, 3)\n"s);
+            const mython::Program sequential{input};
+            ostringstream output;
+            SimpleContext context{output};
+            Closure closure;
+            sequential.Execute(closure, context);
+            ASSERT_EQUAL(output.str(), "9801\n4950\n"s);
+        }
+
+    }  // namespace
+
+    void RunTaskTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestWorkStealingDeque);
+        RUN_TEST(tr, runtime::TestForkJoin);
+        RUN_TEST(tr, runtime::TestOutputOrder);
+        RUN_TEST(tr, runtime::TestErrorsAndRestrictions);
+        RUN_TEST(tr, runtime::TestThreadsStartOnFirstTask);
+        RUN_TEST(tr, runtime::TestParallelCollections);
+    }
+
+}  // namespace runtime